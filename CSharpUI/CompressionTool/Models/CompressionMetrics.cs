@@ -6,7 +6,19 @@ public enum CompressionAlgorithm
 {
     RLE = 0,
     Huffman = 1,
-    LZW = 2
+    LZW = 2,
+    LZ77 = 3,
+    LZH = 4,
+    ANS = 5,
+    RANS = 6,
+    BWT = 7,
+    CM = 8,
+    HuffmanOrder1 = 9,
+    HuffmanAdaptive = 10,
+    Chain = 11,
+    RLEHuffman = 12,
+    DeltaRLEHuffman = 13,
+    Auto = 14
 }
 
 [StructLayout(LayoutKind.Sequential)]
@@ -4,6 +4,7 @@ using System.Diagnostics;
 using System.IO;
 using System.Linq;
 using System.Runtime.InteropServices;
+using System.Threading;
 using System.Threading.Tasks;
 using CompressionTool.Models;
 
@@ -43,114 +44,148 @@ public class CompressionService
     [return: MarshalAs(UnmanagedType.LPUTF8Str)]
     private static extern string get_last_error();
 
+    private const int OperationCompress = 0;
+    private const int OperationDecompress = 1;
+    private const int JobSucceeded = 2;
 
-
-    public async Task<CompressionResult> CompressFileAsync(CompressionAlgorithm algorithm, string inputFile, string outputFile)
+    [StructLayout(LayoutKind.Sequential)]
+    private struct NativeCompressionJob
     {
-        return await Task.Run(() => CompressFile(algorithm, inputFile, outputFile));
+        public CompressionAlgorithm Algorithm;
+        public int Operation;
+        public IntPtr InputFile;
+        public IntPtr OutputFile;
     }
 
-    public async Task<CompressionResult> DecompressFileAsync(CompressionAlgorithm algorithm, string inputFile, string outputFile)
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    private delegate void JobCallback(IntPtr job, int status, IntPtr metrics, IntPtr userData);
+
+    [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern IntPtr submit_compression_job(
+        ref NativeCompressionJob job,
+        IntPtr options,
+        JobCallback callback,
+        IntPtr userData
+    );
+
+    [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern int cancel_compression_job(IntPtr job);
+
+    [DllImport(LibraryName, CallingConvention = CallingConvention.Cdecl)]
+    private static extern void release_compression_job(IntPtr job);
+
+    // Kept in a static field so the delegate outlives every native job.
+    private static readonly JobCallback OnJobFinished = HandleJobFinished;
+
+    private sealed class PendingJob
     {
-        return await Task.Run(() => DecompressFile(algorithm, inputFile, outputFile));
+        public TaskCompletionSource<CompressionResult> Completion { get; } =
+            new(TaskCreationOptions.RunContinuationsAsynchronously);
+        public bool IsCompression { get; init; }
     }
 
-    private CompressionResult CompressFile(CompressionAlgorithm algorithm, string inputFile, string outputFile)
+    public Task<CompressionResult> CompressFileAsync(CompressionAlgorithm algorithm, string inputFile, string outputFile,
+        CancellationToken cancellationToken = default)
     {
-        try
-        {
-            // Check if library was loaded successfully
-            if (!NativeLibraryInitializer.IsLibraryLoaded)
-            {
-                return new CompressionResult
-                {
-                    Success = false,
-                    ErrorMessage = NativeLibraryInitializer.GetLibraryLoadDiagnostics()
-                };
-            }
+        return RunNativeJobAsync(algorithm, OperationCompress, inputFile, outputFile, cancellationToken);
+    }
 
-            var metrics = new CompressionMetrics();
-            int result = compress_file(algorithm, inputFile, outputFile, ref metrics);
+    public Task<CompressionResult> DecompressFileAsync(CompressionAlgorithm algorithm, string inputFile, string outputFile,
+        CancellationToken cancellationToken = default)
+    {
+        return RunNativeJobAsync(algorithm, OperationDecompress, inputFile, outputFile, cancellationToken);
+    }
 
-            return new CompressionResult
-            {
-                Success = result != 0 && metrics.Success != 0,
-                ErrorMessage = metrics.Success == 0 ? metrics.ErrorMessage : null,
-                OriginalSizeBytes = metrics.OriginalSizeBytes,
-                CompressedSizeBytes = metrics.CompressedSizeBytes,
-                CompressionRatio = metrics.CompressionRatio,
-                CompressionTimeMs = metrics.CompressionTimeMs,
-                DecompressionTimeMs = 0,
-                CompressionSpeedMbps = metrics.CompressionSpeedMbps,
-                DecompressionSpeedMbps = 0
-            };
-        }
-        catch (DllNotFoundException dllEx)
+    /// <summary>
+    /// Runs a job on the native library's own thread pool instead of blocking a managed thread.
+    /// Cancellation is forwarded to the native job and takes effect at the next block boundary.
+    /// </summary>
+    private async Task<CompressionResult> RunNativeJobAsync(CompressionAlgorithm algorithm, int operation,
+        string inputFile, string outputFile, CancellationToken cancellationToken)
+    {
+        if (!NativeLibraryInitializer.IsLibraryLoaded)
         {
             return new CompressionResult
             {
                 Success = false,
-                ErrorMessage = $"Compression library not found: {dllEx.Message}\n\nDiagnostics:\n{NativeLibraryInitializer.GetLibraryLoadDiagnostics()}"
+                ErrorMessage = NativeLibraryInitializer.GetLibraryLoadDiagnostics()
             };
         }
-        catch (Exception ex)
+
+        var pending = new PendingJob { IsCompression = operation == OperationCompress };
+        GCHandle state = GCHandle.Alloc(pending);
+        IntPtr input = Marshal.StringToCoTaskMemUTF8(inputFile);
+        IntPtr output = Marshal.StringToCoTaskMemUTF8(outputFile);
+        IntPtr job = IntPtr.Zero;
+
+        try
         {
-            return new CompressionResult
+            var nativeJob = new NativeCompressionJob
             {
-                Success = false,
-                ErrorMessage = $"Error calling compression library: {ex.Message}\n\nDiagnostics:\n{NativeLibraryInitializer.GetLibraryLoadDiagnostics()}"
+                Algorithm = algorithm,
+                Operation = operation,
+                InputFile = input,
+                OutputFile = output
             };
-        }
-    }
 
-    private CompressionResult DecompressFile(CompressionAlgorithm algorithm, string inputFile, string outputFile)
-    {
-        try
-        {
-            // Check if library was loaded successfully
-            if (!NativeLibraryInitializer.IsLibraryLoaded)
+            // The native side copies both paths, so they can be freed once submitted.
+            job = submit_compression_job(ref nativeJob, IntPtr.Zero, OnJobFinished, GCHandle.ToIntPtr(state));
+            Marshal.FreeCoTaskMem(input);
+            Marshal.FreeCoTaskMem(output);
+            input = output = IntPtr.Zero;
+
+            if (job == IntPtr.Zero)
             {
-                return new CompressionResult
-                {
-                    Success = false,
-                    ErrorMessage = NativeLibraryInitializer.GetLibraryLoadDiagnostics()
-                };
+                state.Free();
+                return new CompressionResult { Success = false, ErrorMessage = GetLastError() };
             }
 
-            var metrics = new CompressionMetrics();
-            int result = decompress_file(algorithm, inputFile, outputFile, ref metrics);
-
-            return new CompressionResult
+            using (cancellationToken.Register(() => cancel_compression_job(job)))
             {
-                Success = result != 0 && metrics.Success != 0,
-                ErrorMessage = metrics.Success == 0 ? metrics.ErrorMessage : null,
-                OriginalSizeBytes = metrics.OriginalSizeBytes,
-                CompressedSizeBytes = metrics.CompressedSizeBytes,
-                CompressionRatio = metrics.CompressionRatio,
-                CompressionTimeMs = 0,
-                DecompressionTimeMs = metrics.DecompressionTimeMs,
-                CompressionSpeedMbps = 0,
-                DecompressionSpeedMbps = metrics.DecompressionSpeedMbps
-            };
+                return await pending.Completion.Task.ConfigureAwait(false);
+            }
         }
-        catch (DllNotFoundException dllEx)
+        catch (Exception ex) when (ex is DllNotFoundException || ex is EntryPointNotFoundException)
         {
+            if (job == IntPtr.Zero && state.IsAllocated)
+            {
+                state.Free();
+            }
             return new CompressionResult
             {
                 Success = false,
-                ErrorMessage = $"Decompression library not found: {dllEx.Message}\n\nDiagnostics:\n{NativeLibraryInitializer.GetLibraryLoadDiagnostics()}"
+                ErrorMessage = $"Compression library not found: {ex.Message}\n\nDiagnostics:\n{NativeLibraryInitializer.GetLibraryLoadDiagnostics()}"
             };
         }
-        catch (Exception ex)
+        finally
         {
-            return new CompressionResult
-            {
-                Success = false,
-                ErrorMessage = $"Error calling decompression library: {ex.Message}\n\nDiagnostics:\n{NativeLibraryInitializer.GetLibraryLoadDiagnostics()}"
-            };
+            if (input != IntPtr.Zero) Marshal.FreeCoTaskMem(input);
+            if (output != IntPtr.Zero) Marshal.FreeCoTaskMem(output);
+            if (job != IntPtr.Zero) release_compression_job(job);
         }
     }
 
+    private static void HandleJobFinished(IntPtr job, int status, IntPtr metricsPtr, IntPtr userData)
+    {
+        GCHandle state = GCHandle.FromIntPtr(userData);
+        var pending = (PendingJob)state.Target!;
+        state.Free();
+
+        var metrics = Marshal.PtrToStructure<CompressionMetrics>(metricsPtr);
+        pending.Completion.TrySetResult(new CompressionResult
+        {
+            Success = status == JobSucceeded && metrics.Success != 0,
+            ErrorMessage = metrics.Success == 0 ? metrics.ErrorMessage : null,
+            OriginalSizeBytes = metrics.OriginalSizeBytes,
+            CompressedSizeBytes = metrics.CompressedSizeBytes,
+            CompressionRatio = metrics.CompressionRatio,
+            CompressionTimeMs = pending.IsCompression ? metrics.CompressionTimeMs : 0,
+            DecompressionTimeMs = pending.IsCompression ? 0 : metrics.DecompressionTimeMs,
+            CompressionSpeedMbps = pending.IsCompression ? metrics.CompressionSpeedMbps : 0,
+            DecompressionSpeedMbps = pending.IsCompression ? 0 : metrics.DecompressionSpeedMbps
+        });
+    }
+
     public ulong GetFileSize(string filename)
     {
         try
@@ -203,6 +238,18 @@ public class CompressionService
                     CompressionAlgorithm.RLE => "Run-Length Encoding",
                     CompressionAlgorithm.Huffman => "Huffman Coding",
                     CompressionAlgorithm.LZW => "LZW",
+                    CompressionAlgorithm.LZ77 => "LZ77",
+                    CompressionAlgorithm.LZH => "LZ77 + Huffman",
+                    CompressionAlgorithm.ANS => "tANS",
+                    CompressionAlgorithm.RANS => "Interleaved rANS",
+                    CompressionAlgorithm.BWT => "BWT",
+                    CompressionAlgorithm.CM => "Context mixing",
+                    CompressionAlgorithm.HuffmanOrder1 => "Order-1 Huffman",
+                    CompressionAlgorithm.HuffmanAdaptive => "Adaptive Huffman",
+                    CompressionAlgorithm.Chain => "Transform chain",
+                    CompressionAlgorithm.RLEHuffman => "Fused RLE + Huffman",
+                    CompressionAlgorithm.DeltaRLEHuffman => "Fused delta + RLE + Huffman",
+                    CompressionAlgorithm.Auto => "Automatic",
                     _ => "Unknown"
                 };
             }
@@ -217,6 +264,18 @@ public class CompressionService
                 CompressionAlgorithm.RLE => "Run-Length Encoding",
                 CompressionAlgorithm.Huffman => "Huffman Coding",
                 CompressionAlgorithm.LZW => "LZW",
+                CompressionAlgorithm.LZ77 => "LZ77",
+                CompressionAlgorithm.LZH => "LZ77 + Huffman",
+                CompressionAlgorithm.ANS => "tANS",
+                CompressionAlgorithm.RANS => "Interleaved rANS",
+                CompressionAlgorithm.BWT => "BWT",
+                CompressionAlgorithm.CM => "Context mixing",
+                CompressionAlgorithm.HuffmanOrder1 => "Order-1 Huffman",
+                CompressionAlgorithm.HuffmanAdaptive => "Adaptive Huffman",
+                CompressionAlgorithm.Chain => "Transform chain",
+                CompressionAlgorithm.RLEHuffman => "Fused RLE + Huffman",
+                CompressionAlgorithm.DeltaRLEHuffman => "Fused delta + RLE + Huffman",
+                CompressionAlgorithm.Auto => "Automatic",
                 _ => "Unknown"
             };
         }
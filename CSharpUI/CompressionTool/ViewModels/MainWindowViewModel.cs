@@ -2,6 +2,7 @@ using System;
 using System.Collections.Generic;
 using System.Collections.ObjectModel;
 using System.IO;
+using System.Threading;
 using System.Threading.Tasks;
 using Avalonia.Platform.Storage;
 using CommunityToolkit.Mvvm.ComponentModel;
@@ -13,8 +14,9 @@ namespace CompressionTool.ViewModels;
 
 public partial class MainWindowViewModel : ViewModelBase
 {
-    private readonly CompressionServiceManual _compressionService;
+    private readonly CompressionService _compressionService;
     private readonly IFileDialogService _fileDialogService;
+    private CancellationTokenSource? _operationCancellation;
 
     [ObservableProperty]
     private string _inputFilePath = string.Empty;
@@ -23,7 +25,7 @@ public partial class MainWindowViewModel : ViewModelBase
     private string _outputFilePath = string.Empty;
 
     [ObservableProperty]
-    private CompressionAlgorithm _selectedAlgorithm = CompressionAlgorithm.LZW;
+    private CompressionAlgorithm _selectedAlgorithm = CompressionAlgorithm.Auto;
 
     [ObservableProperty]
     private AlgorithmOption _selectedAlgorithmOption;
@@ -48,7 +50,8 @@ public partial class MainWindowViewModel : ViewModelBase
 
     public ObservableCollection<AlgorithmOption> AvailableAlgorithms { get; } = new()
     {
-        new AlgorithmOption { Name = "LZW (Recommended)", Algorithm = CompressionAlgorithm.LZW, Description = "General-purpose, consistent performance" },
+        new AlgorithmOption { Name = "Automatic (Recommended)", Algorithm = CompressionAlgorithm.Auto, Description = "Samples the file and picks the best codec for it" },
+        new AlgorithmOption { Name = "LZW", Algorithm = CompressionAlgorithm.LZW, Description = "General-purpose, consistent performance" },
         new AlgorithmOption { Name = "Run-Length Encoding", Algorithm = CompressionAlgorithm.RLE, Description = "Best for data with long runs of identical values" },
         new AlgorithmOption { Name = "Huffman Coding", Algorithm = CompressionAlgorithm.Huffman, Description = "Optimal for text with uneven character frequencies" }
     };
@@ -62,7 +65,7 @@ public partial class MainWindowViewModel : ViewModelBase
 
     private static readonly FilePickerFileType CompressedFileType = new("Compressed Files")
     {
-        Patterns = new[] { "*.huf", "*.lzw", "*.rle" }
+        Patterns = new[] { "*.auto", "*.huf", "*.lzw", "*.rle" }
     };
 
     private static readonly FilePickerFileType HuffmanFileType = new("Huffman Files")
@@ -82,11 +85,11 @@ public partial class MainWindowViewModel : ViewModelBase
 
     public MainWindowViewModel(IFileDialogService fileDialogService)
     {
-        _compressionService = new CompressionServiceManual();
+        _compressionService = new CompressionService();
         _fileDialogService = fileDialogService;
-        _selectedAlgorithmOption = AvailableAlgorithms[0]; // Default to LZW
+        _selectedAlgorithmOption = AvailableAlgorithms[0]; // Default to automatic selection
         LogMessages.Add($"Application started - {DateTime.Now:HH:mm:ss}");
-        LogMessages.Add($"Library Load Status: {(CompressionServiceManual.IsLibraryLoaded ? "SUCCESS" : "FAILED")}");
+        LogMessages.Add($"Library Load Status: {(CompressionService.IsLibraryLoaded ? "SUCCESS" : "FAILED")}");
     }
 
     [RelayCommand]
@@ -133,27 +136,34 @@ public partial class MainWindowViewModel : ViewModelBase
     [RelayCommand(CanExecute = nameof(CanExecuteOperation))]
     private async Task ExecuteOperation()
     {
+        _operationCancellation = new CancellationTokenSource();
         IsOperationInProgress = true;
         StatusMessage = IsCompression ? "Compressing..." : "Decompressing...";
 
         try
         {
             CompressionResult result;
+            CancellationToken cancellationToken = _operationCancellation.Token;
 
             if (IsCompression)
             {
-                result = await _compressionService.CompressFileAsync(SelectedAlgorithm, InputFilePath, OutputFilePath);
+                result = await _compressionService.CompressFileAsync(SelectedAlgorithm, InputFilePath, OutputFilePath, cancellationToken);
                 LogMessages.Add($"Compression completed - {DateTime.Now:HH:mm:ss}");
             }
             else
             {
-                result = await _compressionService.DecompressFileAsync(SelectedAlgorithm, InputFilePath, OutputFilePath);
+                result = await _compressionService.DecompressFileAsync(SelectedAlgorithm, InputFilePath, OutputFilePath, cancellationToken);
                 LogMessages.Add($"Decompression completed - {DateTime.Now:HH:mm:ss}");
             }
 
             LastResult = result;
 
-            if (result.Success)
+            if (cancellationToken.IsCancellationRequested && !result.Success)
+            {
+                StatusMessage = "Operation cancelled";
+                LogMessages.Add($"Operation cancelled - {DateTime.Now:HH:mm:ss}");
+            }
+            else if (result.Success)
             {
                 StatusMessage = IsCompression ? "Compression successful!" : "Decompression successful!";
                 LogMessages.Add($"Operation succeeded: {result.CompressionRatioFormatted} ratio, {(IsCompression ? result.CompressionTimeFormatted : result.DecompressionTimeFormatted)}");
@@ -171,10 +181,32 @@ public partial class MainWindowViewModel : ViewModelBase
         }
         finally
         {
+            _operationCancellation.Dispose();
+            _operationCancellation = null;
             IsOperationInProgress = false;
         }
     }
 
+    [RelayCommand(CanExecute = nameof(CanCancelOperation))]
+    private void CancelOperation()
+    {
+        // The native job stops at its next block boundary and ExecuteOperation reports the outcome.
+        _operationCancellation?.Cancel();
+        StatusMessage = "Cancelling...";
+        LogMessages.Add($"Cancellation requested - {DateTime.Now:HH:mm:ss}");
+    }
+
+    private bool CanCancelOperation()
+    {
+        return IsOperationInProgress && _operationCancellation != null && !_operationCancellation.IsCancellationRequested;
+    }
+
+    partial void OnIsOperationInProgressChanged(bool value)
+    {
+        ExecuteOperationCommand.NotifyCanExecuteChanged();
+        CancelOperationCommand.NotifyCanExecuteChanged();
+    }
+
     private bool CanExecuteOperation()
     {
         return !IsOperationInProgress &&
@@ -237,6 +269,7 @@ public partial class MainWindowViewModel : ViewModelBase
             CompressionAlgorithm.RLE => "Run-Length Encoding",
             CompressionAlgorithm.Huffman => "Huffman Coding",
             CompressionAlgorithm.LZW => "LZW",
+            CompressionAlgorithm.Auto => "Automatic",
             _ => "Unknown"
         };
         LogMessages.Add($"Algorithm changed to {algorithmName} - {DateTime.Now:HH:mm:ss}");
@@ -265,6 +298,7 @@ public partial class MainWindowViewModel : ViewModelBase
             CompressionAlgorithm.RLE => ".rle",
             CompressionAlgorithm.Huffman => ".huf",
             CompressionAlgorithm.LZW => ".lzw",
+            CompressionAlgorithm.Auto => ".auto",
             _ => ".compressed"
         };
     }
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Library-wide governor for API jobs. Every compress/decompress call reserves
+// a number of worker threads and an estimate of its buffer memory before it
+// starts. Requests that do not fit wait in a single queue, served in FIFO or
+// priority order; only the head of the queue may be admitted, so a large job
+// is never overtaken indefinitely by smaller ones. A job larger than the
+// limits on its own is admitted once nothing else is running.
+class AdmissionController {
+public:
+    struct Limits {
+        size_t maxJobs = 0;       // 0 = unlimited
+        size_t maxThreads = 0;    // 0 = unlimited
+        uint64_t maxMemory = 0;   // bytes; 0 = unlimited
+        bool priorityOrder = false;
+    };
+
+    struct Request {
+        size_t threads = 1;
+        uint64_t memory = 0;
+        int priority = 0;         // higher runs first under priority order
+    };
+
+    // Holds a reservation until destroyed.
+    class Ticket {
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept;
+        Ticket& operator=(Ticket&& other) noexcept;
+        ~Ticket();
+
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+
+        // Worker threads granted to the job, already clamped to the limit.
+        size_t threads() const { return threads_; }
+
+    private:
+        friend class AdmissionController;
+
+        Ticket(AdmissionController* owner, size_t threads, uint64_t memory);
+
+        void reset();
+
+        AdmissionController* owner_ = nullptr;
+        size_t threads_ = 0;
+        uint64_t memory_ = 0;
+    };
+
+    using AdmitCallback = std::function<void(Ticket)>;
+
+    static AdmissionController& instance();
+
+    void configure(const Limits& limits);
+
+    // Blocks until the request is admitted. Do not call from a pool worker:
+    // use enqueue() there so the worker is not parked.
+    Ticket acquire(const Request& request);
+
+    // Queues the request; onAdmitted runs (on the releasing or calling
+    // thread) as soon as it is admitted. Returns the id cancel() takes.
+    uint64_t enqueue(const Request& request, AdmitCallback onAdmitted);
+
+    // Withdraws a request that is still waiting, so it no longer holds back
+    // the queue; its callback never runs. False if it was already admitted.
+    bool cancel(uint64_t sequence);
+
+private:
+    struct Waiter {
+        uint64_t sequence;
+        Request request;
+        AdmitCallback onAdmitted;
+    };
+
+    void release(size_t threads, uint64_t memory);
+
+    // Admits waiters from the head of the queue while they fit. Callbacks run
+    // after the lock is dropped.
+    void admitWaiters(std::unique_lock<std::mutex>& lock);
+
+    size_t grantedThreads(const Request& request) const;
+
+    bool fits(const Request& request) const;
+
+    std::vector<Waiter>::iterator head();
+
+    std::mutex mutex_;
+    Limits limits_;
+    std::vector<Waiter> waiting_;
+    uint64_t nextSequence_ = 0;
+    size_t activeJobs_ = 0;
+    size_t activeThreads_ = 0;
+    uint64_t activeMemory_ = 0;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "compression_api.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// What a sample of the input says about how it compresses. Entropies are in
+// bits per byte; fractions are of the sampled bytes.
+struct ProbeStats {
+    uint64_t inputSize = 0;
+    uint64_t sampledBytes = 0;
+    double entropy = 8.0;           // order 0
+    double order1Entropy = 8.0;     // order 1, charged for the contexts it uses
+    double deltaEntropy = 8.0;      // order 0 of differences 4 bytes apart
+    double runFraction = 0.0;       // equal to the byte before
+    double repeatFraction = 0.0;    // start a 4-byte string seen earlier in the chunk
+    double textFraction = 0.0;      // printable ASCII or whitespace
+};
+
+struct AlgorithmChoice {
+    CompressionAlgorithm algorithm = ALGORITHM_RANS;
+    // LZ77/LZH level to use unless the caller set one; 0 = the default.
+    uint32_t lz77Level = 0;
+};
+
+// Picks a codec for ALGORITHM_AUTO from a few evenly spaced chunks of the
+// input. The sample is about 1/128 of the input, between 32 KB and 1 MB,
+// and costs a few table updates per byte, so probing takes under 1% of the
+// time of compressing with any of the candidates. Context mixing is never
+// chosen: it is too slow to be a safe default.
+class AlgorithmSelector {
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+    static constexpr size_t MIN_SAMPLE = 32 * 1024;
+    static constexpr size_t MAX_SAMPLE = 1024 * 1024;
+    static constexpr size_t SAMPLE_FRACTION = 128;
+
+    // False if the file cannot be read.
+    static bool probe(const std::string& filename, ProbeStats& stats);
+
+    static AlgorithmChoice choose(const ProbeStats& stats);
+
+    static bool select(const std::string& filename, AlgorithmChoice& choice);
+};
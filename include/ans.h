@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Order-0 table-based asymmetric numeral systems (tANS, as in FSE).
+//
+// Symbol counts are normalized to a power-of-two table of 2^tableLog
+// states and spread across it; each symbol then costs close to its
+// information content in whole-state transitions, without Huffman's
+// whole-bit rounding. Two interleaved states let consecutive symbols decode
+// independently.
+//
+// Segment layout (up to SEGMENT_SIZE input bytes each; the decoder knows
+// each segment's size from the total):
+//   mode u8, then for MODE_TANS: tableLog u8 | max symbol u8 | normalized
+//   count varints for symbols 0..max | bit stream size varint | bit stream
+//   or for MODE_STORED the raw bytes.
+// The bit stream is written back to front: symbols are encoded last to
+// first, followed by the two final states and a 1 bit marking the end.
+//
+// File layout: "ANSF" | version u8, then chunks of raw size u32 | encoded
+// size u32 | segments (little-endian), ending with a raw size of 0.
+// Block layout: raw size varint | segments.
+class ANSCompressor {
+public:
+    static constexpr unsigned MIN_TABLE_LOG = 5;
+    static constexpr unsigned MAX_TABLE_LOG = 12;
+
+    static bool compress(const std::string& inputFile, const std::string& outputFile);
+
+    static bool decompress(const std::string& inputFile, const std::string& outputFile);
+
+    static bool isValidANSFile(const std::string& filename);
+
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+
+    // Fails on a block of more than maxSize bytes before allocating it.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize);
+
+    // Entropy back end for other codecs: appends the segments for
+    // data[0, size) to output.
+    static void encode(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+
+    // Decodes exactly rawSize bytes from the segments in input[0, inputSize),
+    // which must be consumed exactly. Returns false on corrupt input.
+    static bool decode(const uint8_t* input, size_t inputSize, uint8_t* output, size_t rawSize);
+
+    // Scales byte counts over symbols 0..maxSymbol (summing to total) to sum
+    // to 2^tableLog, keeping every present symbol at 1 or more. tableLog must
+    // leave at least one state per present symbol.
+    static void normalizeCounts(const uint32_t* counts, unsigned maxSymbol, size_t total, unsigned tableLog,
+                                uint32_t* normalized);
+
+private:
+    static constexpr char MAGIC[4] = {'A', 'N', 'S', 'F'};
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr size_t SEGMENT_SIZE = 1u << 17;
+    static constexpr size_t CHUNK_SIZE = 1u << 20;
+    static constexpr unsigned DEFAULT_TABLE_LOG = 11;
+    static constexpr uint8_t MODE_TANS = 0;
+    static constexpr uint8_t MODE_STORED = 1;
+
+    // Returns false if the tANS coding would not be smaller than the input.
+    static bool encodeSegment(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+
+    // Advances ip past the segment; false on corrupt input.
+    static bool decodeSegment(const uint8_t*& ip, const uint8_t* end, uint8_t* output, size_t size);
+
+    static void writeU32(std::ofstream& output, uint32_t value);
+
+    static bool readU32(std::ifstream& input, uint32_t& value);
+
+    static bool fileExists(const std::string& filename);
+
+    static size_t getFileSize(const std::string& filename);
+};
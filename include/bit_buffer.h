@@ -0,0 +1,182 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// LSB-first bit packing into and out of memory, shared by the entropy coders.
+// Bits are stored from the least significant end of each byte, so prefix
+// codes are written bit-reversed (see HuffmanCompressor::buildCanonicalCodes).
+class BitBufferWriter {
+public:
+    explicit BitBufferWriter(std::vector<uint8_t>& output) : output_(output), buffer_(0), count_(0) {}
+
+    // Appends the low count bits of bits; count is at most 32 and bits must
+    // not have higher bits set.
+    void write(uint32_t bits, unsigned count) {
+        buffer_ |= static_cast<uint64_t>(bits) << count_;
+        count_ += count;
+        while (count_ >= 8) {
+            output_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ >>= 8;
+            count_ -= 8;
+        }
+    }
+
+    // Pads the last partial byte with zeros.
+    void flush() {
+        if (count_ > 0) {
+            output_.push_back(static_cast<uint8_t>(buffer_));
+            buffer_ = 0;
+            count_ = 0;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& output_;
+    uint64_t buffer_;
+    unsigned count_;
+};
+
+// Reads past the end return zero bits; callers check overrun() once they are
+// done instead of bounds-checking every symbol.
+class BitBufferReader {
+public:
+    BitBufferReader(const uint8_t* data, size_t size)
+        : data_(data), size_(size), position_(0), buffer_(0), count_(0), consumed_(0) {}
+
+    // The next count bits (at most 32) without consuming them.
+    uint32_t peek(unsigned count) {
+        if (count_ < count) {
+            refill();
+        }
+        return static_cast<uint32_t>(buffer_ & ((static_cast<uint64_t>(1) << count) - 1));
+    }
+
+    void consume(unsigned count) {
+        buffer_ >>= count;
+        count_ -= count;
+        consumed_ += count;
+    }
+
+    uint32_t read(unsigned count) {
+        uint32_t bits = peek(count);
+        consume(count);
+        return bits;
+    }
+
+    // Skips to the next byte boundary.
+    void align() {
+        consume(static_cast<unsigned>((8 - consumed_ % 8) % 8));
+    }
+
+    // Bytes consumed so far, counting a partial byte as whole.
+    size_t bytesConsumed() const {
+        return static_cast<size_t>((consumed_ + 7) / 8);
+    }
+
+    bool overrun() const {
+        return consumed_ > static_cast<uint64_t>(size_) * 8;
+    }
+
+private:
+    void refill() {
+        while (count_ <= 56) {
+            uint8_t byte = position_ < size_ ? data_[position_] : 0;
+            position_++;
+            buffer_ |= static_cast<uint64_t>(byte) << count_;
+            count_ += 8;
+        }
+    }
+
+    const uint8_t* data_;
+    size_t size_;
+    size_t position_;
+    uint64_t buffer_;
+    unsigned count_;
+    uint64_t consumed_;
+};
+
+// Reads a BitBufferWriter stream back to front, for coders that encode in
+// reverse so they can decode forwards (tANS). The writer must end the stream
+// with a 1 bit before flushing; reading starts just below it and returns the
+// values in the reverse of the order they were written.
+class BitBufferReverseReader {
+public:
+    BitBufferReverseReader(const uint8_t* data, size_t size) : data_(data), size_(size), position_(-1) {
+        if (size > 0 && data[size - 1] != 0) {
+            int top = 7;
+            while (!(data[size - 1] >> top)) {
+                top--;
+            }
+            position_ = static_cast<int64_t>(size - 1) * 8 + top;
+        }
+    }
+
+    // False if the stream has no end marker.
+    bool valid() const {
+        return position_ >= 0;
+    }
+
+    // count is at most 25. Reading past the start returns zeros and sets
+    // overrun().
+    uint32_t read(unsigned count) {
+        if (static_cast<int64_t>(count) > position_) {
+            position_ = -1;
+            overrun_ = true;
+            return 0;
+        }
+        position_ -= count;
+        size_t byte = static_cast<size_t>(position_ >> 3);
+        uint32_t word;
+        if (byte + 4 <= size_) {
+            word = static_cast<uint32_t>(data_[byte]) | (static_cast<uint32_t>(data_[byte + 1]) << 8) |
+                   (static_cast<uint32_t>(data_[byte + 2]) << 16) | (static_cast<uint32_t>(data_[byte + 3]) << 24);
+        } else {
+            word = 0;
+            for (size_t i = 0; byte + i < size_; i++) {
+                word |= static_cast<uint32_t>(data_[byte + i]) << (8 * i);
+            }
+        }
+        return (word >> (position_ & 7)) & ((1u << count) - 1);
+    }
+
+    bool overrun() const {
+        return overrun_;
+    }
+
+    // True once every bit before the end marker has been read.
+    bool finished() const {
+        return position_ == 0 && !overrun_;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    int64_t position_;
+    bool overrun_ = false;
+};
+
+// LEB128 varints used for sizes and offsets in the byte-oriented formats.
+inline void writeVarint(std::vector<uint8_t>& output, uint64_t value) {
+    while (value >= 0x80) {
+        output.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<uint8_t>(value));
+}
+
+inline bool readVarint(const uint8_t*& ip, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (ip == end) {
+            return false;
+        }
+        uint8_t byte = *ip++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
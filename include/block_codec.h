@@ -0,0 +1,53 @@
+#pragma once
+
+#include "compression_api.h"
+#include "lz77.h"
+#include "entropy_backend.h"
+#include "cm.h"
+#include "huffman.h"
+#include <cstdint>
+#include <vector>
+
+// Encoder tuning for the algorithms that have any. Decoders only need the
+// stages of a chain, which the container header records; every other
+// format records what it used.
+struct CodecParams {
+    LZ77Params lz77;
+    // Final stage of the BWT codec.
+    EntropyCoder entropy = EntropyCoder::RANS;
+    // Model memory of the context-mixing codec.
+    uint32_t cmMemoryMb = CMCompressor::DEFAULT_MEMORY_MB;
+    // Bytes between code rebuilds of adaptive Huffman.
+    uint32_t huffmanRebuildInterval = HuffmanCompressor::DEFAULT_REBUILD_INTERVAL;
+    // Stages of ALGORITHM_CHAIN; see TransformChain.
+    std::vector<uint8_t> chain;
+};
+
+// In-memory entry points for each algorithm, used by the block-framed
+// container. Every block is encoded on its own so blocks can be processed on
+// any worker in any order; history only lets a block refer back to input
+// the encoder already has.
+class BlockCodec {
+public:
+    static bool isSupported(CompressionAlgorithm algorithm);
+
+    // Algorithms with no single-stream format, which always use the block
+    // container. ALGORITHM_AUTO is one, though it is resolved to a real
+    // algorithm before it reaches the container.
+    static bool isBlockOnly(CompressionAlgorithm algorithm);
+
+    // LZ-family codecs, whose blocks can be primed with the data before them.
+    static bool supportsHistory(CompressionAlgorithm algorithm);
+
+    // input[0, historySize) is history that matches may refer to but that
+    // is not encoded; non-zero only where supportsHistory holds.
+    static bool encode(CompressionAlgorithm algorithm, const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                       const CodecParams& params = CodecParams(), size_t historySize = 0);
+
+    // output[0, historySize) must hold the same history; the block is
+    // appended after it. A block that would decode to more than maxSize
+    // bytes fails before its output is allocated; the container passes the
+    // raw size from the block's frame.
+    static bool decode(CompressionAlgorithm algorithm, const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                       size_t maxSize, const CodecParams& params = CodecParams(), size_t historySize = 0);
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "compression_api.h"
+#include "block_codec.h"
+#include "block_pipeline.h"
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct BlockOptions {
+    // Blocks transformed concurrently; 0 uses every worker of the shared pool.
+    // At most threads + 2 blocks are held in memory at any time.
+    size_t threads = 0;
+    size_t blockSize = 1 << 20;
+    // Checked between blocks; when set the operation stops and fails.
+    const std::atomic<bool>* cancelled = nullptr;
+    // Reported from the writer after each block, throttled to the interval.
+    CompressionProgressCallback progressCallback = nullptr;
+    void* progressUserData = nullptr;
+    uint32_t progressIntervalMs = 0;
+    CodecParams codec;
+    // Token-bucket limits for background jobs; 0 = unlimited. Reads and
+    // writes are throttled on the reader and writer threads; the CPU limit
+    // (percent of one core, summed over the job's workers) is enforced by
+    // holding back the reader, so pool workers never sleep.
+    double maxReadBytesPerSecond = 0;
+    double maxWriteBytesPerSecond = 0;
+    uint32_t maxCpuPercent = 0;
+    // Compression only: when set, progress is persisted to this file every
+    // checkpointInterval blocks and removed on success. With resume, a
+    // checkpoint matching the input and output lets the job continue after
+    // the last recorded block instead of starting over.
+    std::string checkpointFile;
+    size_t checkpointInterval = 16;
+    bool resume = false;
+    // Compression only, LZ77 and LZH: prime each block with the window of
+    // input before it so matches cross block boundaries. Encoding stays
+    // parallel, each slot holding up to a window more; decoding becomes
+    // sequential. Ignored for other algorithms.
+    bool linkBlocks = false;
+    // Compression only: marks the header as written for ALGORITHM_AUTO,
+    // which chose the algorithm.
+    bool autoSelected = false;
+};
+
+// Block-framed container: the input is cut into fixed-size blocks that are
+// compressed independently on the shared thread pool and written in order
+// through a bounded BlockPipeline.
+//
+// Layout (all integers little-endian):
+//   "CMPB" | version u8 | algorithm u8 | flags u16 | block size u32
+//   ALGORITHM_CHAIN only: stage count u8 | stage ids u8 (TransformChain)
+//   per block: raw size u32 | payload size u32 | crc32 u32 | payload
+//   end marker: a frame with raw size 0
+// The top bit of the payload size marks a block stored uncompressed because
+// encoding would have expanded it. The LINKED_FLAG bit marks linked blocks,
+// primed with the 2^(flags >> 8) bytes of data before them; the CRC and raw
+// size cover only the block's own bytes. AUTO_FLAG records that
+// ALGORITHM_AUTO picked the algorithm.
+class BlockCompressor {
+public:
+    static constexpr size_t MAX_BLOCK_SIZE = 1u << 30;
+
+    static bool compress(CompressionAlgorithm algorithm, const std::string& inputFile,
+                         const std::string& outputFile, const BlockOptions& options = BlockOptions());
+
+    static bool decompress(const std::string& inputFile, const std::string& outputFile,
+                           const BlockOptions& options = BlockOptions());
+
+    static bool isBlockFile(const std::string& filename);
+
+    static bool readHeader(const std::string& filename, CompressionAlgorithm& algorithm, uint32_t& blockSize);
+
+    // Whether the header carries AUTO_FLAG; false for other files.
+    static bool isAutoSelected(const std::string& filename);
+
+private:
+    static constexpr char MAGIC[4] = {'C', 'M', 'P', 'B'};
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr uint32_t STORED_FLAG = 0x80000000u;
+    static constexpr uint16_t LINKED_FLAG = 0x0001;
+    static constexpr uint16_t AUTO_FLAG = 0x0002;
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t FRAME_HEADER_SIZE = 12;
+
+    // Position of a partially written output, valid for one exact input and
+    // the encoder parameters the blocks so far were written with.
+    struct Checkpoint {
+        CompressionAlgorithm algorithm;
+        uint32_t blockSize;
+        uint64_t inputSize;
+        int64_t inputModified;
+        uint64_t blockIndex;
+        uint64_t inputOffset;
+        uint64_t outputOffset;
+        uint32_t paramsHash;
+    };
+
+    static bool saveCheckpoint(const std::string& filename, const Checkpoint& checkpoint);
+
+    static bool loadCheckpoint(const std::string& filename, Checkpoint& checkpoint);
+
+    static int64_t modificationTime(const std::string& filename);
+
+    // CRC of the encoder parameters the output header does not record, so a
+    // resume under a different level, window, match finder, entropy stage,
+    // model size or rebuild interval starts over instead of mixing them.
+    static uint32_t paramsHash(const CodecParams& params);
+
+    // chain receives the stages of ALGORITHM_CHAIN and is empty otherwise.
+    static bool readHeader(const std::string& filename, CompressionAlgorithm& algorithm, uint32_t& blockSize,
+                           uint16_t& flags, std::vector<uint8_t>& chain);
+
+    // Bytes before the first frame.
+    static size_t headerSize(const std::vector<uint8_t>& chain);
+
+    static size_t workerCount(const BlockOptions& options);
+
+    // Decodes (or copies) one frame payload after block.historySize bytes of
+    // history already in block.output, and verifies its size and CRC.
+    static void decodeBlock(CompressionAlgorithm algorithm, const CodecParams& params, PipelineBlock& block);
+
+    static bool isCancelled(const BlockOptions& options);
+
+    static void writeU32(std::ostream& output, uint32_t value);
+
+    static bool readU32(std::istream& input, uint32_t& value);
+
+    static bool fileExists(const std::string& filename);
+
+    static size_t getFileSize(const std::string& filename);
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// One block travelling through the pipeline. Slots are recycled, so the
+// buffers keep their capacity from block to block.
+struct PipelineBlock {
+    size_t sequence = 0;
+    std::vector<uint8_t> input;
+    std::vector<uint8_t> output;
+    // Leading bytes of input (when compressing) or output (when
+    // decompressing) copied from earlier blocks as codec history.
+    size_t historySize = 0;
+    uint32_t rawSize = 0;
+    uint32_t crc = 0;
+    bool stored = false;
+    bool ok = true;
+};
+
+// Bounded read -> transform -> write pipeline with ordered output.
+//
+// A dedicated reader thread fills free slots, the transform runs on the
+// shared thread pool, and the calling thread acts as the writer, draining a
+// reorder buffer strictly in sequence. There are exactly workers + 2 slots
+// (one being read, one being written, the rest being transformed), so peak
+// memory is bounded by the slot count times the block size regardless of
+// input length. While the writer waits it runs pending pool work, which keeps
+// pipelines started from pool threads (batch jobs) from starving each other.
+class BlockPipeline {
+public:
+    enum class ReadStatus { Ready, EndOfInput, Failed };
+
+    using ReadStage = std::function<ReadStatus(PipelineBlock&)>;
+    using TransformStage = std::function<void(PipelineBlock&)>;
+    using WriteStage = std::function<bool(PipelineBlock&)>;
+
+    explicit BlockPipeline(size_t workers);
+
+    BlockPipeline(const BlockPipeline&) = delete;
+    BlockPipeline& operator=(const BlockPipeline&) = delete;
+
+    // Returns false if any stage failed; remaining blocks are abandoned.
+    bool run(const ReadStage& read, const TransformStage& transform, const WriteStage& write);
+
+    size_t slotCount() const;
+
+private:
+    void readerLoop(const ReadStage& read, const TransformStage& transform);
+
+    std::vector<PipelineBlock> slots_;
+    std::vector<PipelineBlock*> freeSlots_;
+    std::map<size_t, PipelineBlock*> completed_;
+    std::mutex mutex_;
+    std::condition_variable slotFreed_;
+    std::condition_variable blockDone_;
+    size_t blocksRead_;
+    size_t inFlight_;
+    bool readerFinished_;
+    bool failed_;
+};
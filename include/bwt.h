@@ -0,0 +1,87 @@
+#pragma once
+
+#include "entropy_backend.h"
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Burrows-Wheeler block-sorting codec in the style of bzip2.
+//
+// Each block of up to BLOCK_SIZE bytes is permuted by the BWT, read off its
+// suffix array (SuffixArray::build, SA-IS), so bytes that precede similar
+// contexts end up next to each other. Move-to-front turns that locality into
+// runs of small ranks; runs of rank 0 are written as bijective base-2 digits
+// (RUNA/RUNB, a run-length code that needs no escape or length limit, unlike
+// RLECompressor's count bytes) and the result goes through the chosen
+// EntropyBackend coder.
+//
+// Symbols: 0 RUNA, 1 RUNB, 2..254 for ranks 1..253, and 255 followed by
+// 0 or 1 for ranks 254 and 255.
+// Block payload: walk count u8 | start row varints | symbol count varint |
+// coded symbols (EntropyBackend, raw size = symbol count). The block is cut
+// into walk count slices of equal length (the last may be shorter) and each
+// start row is the row of the sorted rotations that begins its slice; the
+// first is the primary index. The decoder inverts all slices at once.
+// File layout: "BWTF" | version u8 | coder u8, then blocks of raw size u32 |
+// payload size u32 | payload (little-endian), ending with a raw size of 0.
+// Block layout: raw size varint | coder u8 | a payload for every BLOCK_SIZE
+// bytes, each preceded by its size varint.
+class BWTCompressor {
+public:
+    static constexpr size_t BLOCK_SIZE = 1u << 22;
+
+    // The inverse transform walks a block in at most MAX_WALKS slices, each
+    // a power of two of at least MIN_WALK_LENGTH bytes.
+    static constexpr size_t MAX_WALKS = 16;
+    static constexpr size_t MIN_WALK_LENGTH = 1u << 16;
+
+    // Working memory per block in flight: input, suffix array, transform,
+    // symbols and coded output.
+    static constexpr size_t BLOCK_MEMORY = BLOCK_SIZE * 12;
+
+    // Up to threads blocks (0 = every worker of the shared pool) are
+    // transformed or inverted at once.
+    static bool compress(const std::string& inputFile, const std::string& outputFile,
+                         EntropyCoder coder = EntropyCoder::RANS, size_t threads = 0);
+
+    static bool decompress(const std::string& inputFile, const std::string& outputFile, size_t threads = 0);
+
+    static bool isValidBWTFile(const std::string& filename);
+
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                              EntropyCoder coder = EntropyCoder::RANS);
+
+    // Fails on a block of more than maxSize bytes.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize);
+
+    // The permutation alone, for transform chains that code it with other
+    // stages. Same size as the input plus the start rows.
+    // Layout: raw size varint | per BLOCK_SIZE bytes: start row varints |
+    // transformed bytes.
+    static bool transformBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+
+    static bool inverseTransformBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+
+private:
+    static constexpr char MAGIC[4] = {'B', 'W', 'T', 'F'};
+    static constexpr uint8_t FORMAT_VERSION = 2;
+    static constexpr uint8_t RUNA = 0;
+    static constexpr uint8_t RUNB = 1;
+    static constexpr uint8_t ESCAPE = 255;
+
+    // Appends the payload for data[0, size), 0 < size <= BLOCK_SIZE.
+    static void encodePayload(const uint8_t* data, size_t size, EntropyCoder coder, std::vector<uint8_t>& output);
+
+    static bool decodePayload(const uint8_t* input, size_t inputSize, EntropyCoder coder, uint8_t* output,
+                              size_t size);
+
+    static void writeU32(std::ofstream& output, uint32_t value);
+
+    static bool readU32(std::ifstream& input, uint32_t& value);
+
+    static bool fileExists(const std::string& filename);
+
+    static size_t getFileSize(const std::string& filename);
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class Checksum {
+public:
+    // CRC-32 (IEEE 802.3, reflected). Pass a previous result as `crc` to
+    // continue a running checksum across several buffers.
+    static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Context-mixing compressor: a binary arithmetic coder driven by order-0 to
+// order-6 context models and a match model, in the style of lpaq.
+//
+// Each byte is coded as eight binary decisions. Every model predicts the next
+// bit from the partial byte and its context (the previous 1, 2, 3, 4 or 6
+// bytes, hashed into a table of adaptive counters); the match model predicts
+// the byte that followed the last occurrence of the previous six. A gated
+// linear mixer combines the predictions in the logistic domain and an SSE
+// stage on the previous byte refines the result. The decoder runs the same
+// models, so nothing but the table size is transmitted.
+//
+// The hashed tables and the match history share the memory budget; their
+// size is recorded as log2 of the counters per table. Each context owns one
+// 64-byte bucket per nibble, so a byte costs two cache misses per order.
+//
+// File layout: "CTXM" | version u8 | table bits u8, then chunks of raw size
+// u32 | coded size u32 | coded bytes (little-endian), ending with a raw size
+// of 0. The models carry over from chunk to chunk; the coder restarts.
+// Block layout: raw size varint | table bits u8 | coded bytes.
+class CMCompressor {
+public:
+    static constexpr uint32_t MIN_MEMORY_MB = 1;
+    static constexpr uint32_t MAX_MEMORY_MB = 4096;
+    static constexpr uint32_t DEFAULT_MEMORY_MB = 64;
+    // Bytes coded between chunk headers in the single-stream format.
+    static constexpr size_t CHUNK_SIZE = 1u << 20;
+
+    // memoryMb bounds the context tables, clamped to the range above.
+    static bool compress(const std::string& inputFile, const std::string& outputFile,
+                         uint32_t memoryMb = DEFAULT_MEMORY_MB);
+
+    static bool decompress(const std::string& inputFile, const std::string& outputFile);
+
+    static bool isValidCMFile(const std::string& filename);
+
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                              uint32_t memoryMb = DEFAULT_MEMORY_MB);
+
+    // Fails on a block of more than maxSize bytes before allocating it.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize);
+
+    // Bytes of model tables a memoryMb budget actually allocates for an
+    // input of inputSize bytes.
+    static size_t tableMemory(uint32_t memoryMb, uint64_t inputSize = UINT64_MAX);
+
+private:
+    static constexpr char MAGIC[4] = {'C', 'T', 'X', 'M'};
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr unsigned MIN_TABLE_BITS = 16;
+    static constexpr unsigned MAX_TABLE_BITS = 28;
+    // Bytes per counter slot: five tables of 4-byte counters, plus a
+    // history of two bytes and a position index of two bytes per slot.
+    static constexpr size_t BYTES_PER_SLOT = 24;
+
+    // Table size for a budget, no larger than inputSize bytes can fill.
+    static unsigned tableBitsFor(uint32_t memoryMb, uint64_t inputSize);
+
+    static void writeU32(std::ofstream& output, uint32_t value);
+
+    static bool readU32(std::ifstream& input, uint32_t& value);
+
+    static bool fileExists(const std::string& filename);
+
+    static size_t getFileSize(const std::string& filename);
+};
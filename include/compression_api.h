@@ -27,9 +27,153 @@ typedef struct {
 typedef enum {
     ALGORITHM_RLE = 0,
     ALGORITHM_HUFFMAN = 1,
-    ALGORITHM_LZW = 2
+    ALGORITHM_LZW = 2,
+    ALGORITHM_LZ77 = 3,
+    ALGORITHM_LZH = 4,
+    ALGORITHM_ANS = 5,
+    ALGORITHM_RANS = 6,
+    ALGORITHM_BWT = 7,
+    ALGORITHM_CM = 8,
+    ALGORITHM_HUFFMAN_O1 = 9,
+    ALGORITHM_HUFFMAN_ADAPTIVE = 10,
+    ALGORITHM_CHAIN = 11,   /* stages named by CompressionOptions.chain */
+    /* Fixed pipelines fused at compile time; block-framed only, like
+       ALGORITHM_CHAIN. */
+    ALGORITHM_RLE_HUFFMAN = 12,
+    ALGORITHM_DELTA_RLE_HUFFMAN = 13,   /* 4-byte delta first */
+    /* Compression samples the input and picks one of the above, with its
+       parameters; the block header records the choice and that it was
+       automatic. Block-framed only. Decompression accepts any block-framed
+       file. */
+    ALGORITHM_AUTO = 14
 } CompressionAlgorithm;
 
+#define COMPRESSION_DEFAULT_BLOCK_SIZE (1u << 20)
+
+/* LZ77/LZH match finder; the default follows the level (hash chains up to
+   level 7, binary trees above). */
+typedef enum {
+    MATCH_FINDER_DEFAULT = 0,
+    MATCH_FINDER_HASH_CHAIN = 1,
+    MATCH_FINDER_BINARY_TREE = 2,
+    MATCH_FINDER_SUFFIX_ARRAY = 3
+} MatchFinder;
+
+/* Final order-0 stage of the BWT codec; the default is rANS. */
+typedef enum {
+    ENTROPY_STAGE_DEFAULT = 0,
+    ENTROPY_STAGE_HUFFMAN = 1,
+    ENTROPY_STAGE_TANS = 2,
+    ENTROPY_STAGE_RANS = 3
+} EntropyStage;
+
+#define COMPRESSION_DEFAULT_PROGRESS_INTERVAL_MS 200
+
+typedef struct {
+    uint64_t bytes_processed;   /* input bytes consumed so far */
+    uint64_t total_bytes;       /* input file size */
+    double throughput_mbps;     /* rate since the previous report */
+    double eta_seconds;         /* estimated time remaining; -1 when unknown */
+} CompressionProgress;
+
+/* Called from a library thread, never more often than the configured interval
+   (plus one final report). Keep it short: it runs on the output path. */
+typedef void (*CompressionProgressCallback)(const CompressionProgress* progress, void* user_data);
+
+typedef struct {
+    uint32_t threads;       /* blocks processed concurrently; 0 = every pool worker */
+    uint32_t block_size;    /* bytes per block; 0 = legacy single-stream format */
+    CompressionProgressCallback progress_callback;  /* optional */
+    void* progress_user_data;
+    uint32_t progress_interval_ms;  /* 0 = COMPRESSION_DEFAULT_PROGRESS_INTERVAL_MS */
+    int32_t priority;       /* higher is admitted first under ADMISSION_PRIORITY */
+    /* Token-bucket throttling for background jobs in block mode; 0 = unlimited.
+       A single-stream job (block_size 0, or an unframed file to decompress)
+       fails with any of these set. */
+    double max_read_mbps;
+    double max_write_mbps;
+    uint32_t max_cpu_percent;   /* percent of one core, summed over the job's workers */
+    /* Block-mode compression only: progress is saved to checkpoint_path (may
+       be NULL) every checkpoint_interval_blocks blocks (0 = 16). With resume
+       set, a checkpoint matching the input continues the job after the last
+       saved block. The file is removed once the job succeeds. */
+    const char* checkpoint_path;
+    uint32_t checkpoint_interval_blocks;
+    int resume;
+    /* LZ77 and LZH tuning; 0 = defaults (1 MB window, the level's candidate
+       count). The window is rounded up to a power of two between 64 KB and
+       16 MB. */
+    uint32_t lz77_window_size;
+    uint32_t lz77_chain_depth;
+    /* LZ77 and LZH level from 1 (fastest, greedy) to 9 (smallest, optimal
+       parse); 0 = default (3). Out-of-range values are clamped. */
+    uint32_t lz77_level;
+    MatchFinder lz77_match_finder;
+    /* LZ77 and LZH block-mode compression: when non-zero, each block is
+       primed with the window of input before it, so matches cross block
+       boundaries. Blocks still compress in parallel; they decompress in
+       order. */
+    int lz77_link_blocks;
+    EntropyStage entropy_stage;
+    /* Context-mixing model tables in MB, per stream or block; 0 = 64.
+       Clamped to 1..4096 and capped by what the input can use. Decoding
+       needs the same memory and reads the size from the file. */
+    uint32_t cm_memory_mb;
+    /* Adaptive Huffman: bytes between code rebuilds, rounded up to a power
+       of two from 256 to 1 MB; 0 = 4 KB. Also bounds how much input is
+       held before output is written. */
+    uint32_t huffman_rebuild_interval;
+    /* ALGORITHM_CHAIN: stage names joined by '+', applied in order to each
+       block, e.g. "bwt-raw+mtf+rle+ans". Stages are the other algorithms'
+       CLI names plus the transforms "mtf", "delta" and "bwt-raw". A chain
+       always uses the block container (block_size 0 = the default) and is
+       recorded in its header, so decompression needs no options. */
+    const char* chain;
+} CompressionOptions;
+
+typedef enum {
+    ADMISSION_FIFO = 0,
+    ADMISSION_PRIORITY = 1
+} AdmissionPolicy;
+
+typedef struct {
+    uint32_t max_concurrent_jobs;   /* 0 = unlimited */
+    uint32_t max_worker_threads;    /* sum of threads granted to running jobs; 0 = unlimited */
+    uint64_t max_buffer_memory;     /* sum of estimated job buffers in bytes; 0 = unlimited */
+    AdmissionPolicy policy;
+} AdmissionLimits;
+
+typedef enum {
+    OPERATION_COMPRESS = 0,
+    OPERATION_DECOMPRESS = 1
+} CompressionOperation;
+
+typedef struct {
+    CompressionAlgorithm algorithm;
+    CompressionOperation operation;
+    const char* input_file;
+    const char* output_file;
+} CompressionJob;
+
+typedef enum {
+    JOB_QUEUED = 0,
+    JOB_RUNNING = 1,
+    JOB_SUCCEEDED = 2,
+    JOB_FAILED = 3,
+    JOB_CANCELLED = 4
+} CompressionJobStatus;
+
+typedef struct CompressionJobState* CompressionJobHandle;
+
+/* Invoked once from a library thread when the job finishes, fails or is
+   cancelled. The metrics pointer is only valid during the call. */
+typedef void (*CompressionJobCallback)(
+    CompressionJobHandle job,
+    CompressionJobStatus status,
+    const CompressionMetrics* metrics,
+    void* user_data
+);
+
 COMPRESSION_API int compress_file(
     CompressionAlgorithm algorithm,
     const char* input_file,
@@ -44,6 +188,82 @@ COMPRESSION_API int decompress_file(
     CompressionMetrics* metrics
 );
 
+/* Fills options with defaults: automatic thread count, block-framed output. */
+COMPRESSION_API void init_compression_options(CompressionOptions* options);
+
+/* Like compress_file, but block-parallel when options->block_size is non-zero.
+   A NULL options pointer behaves exactly like compress_file. */
+COMPRESSION_API int compress_file_ex(
+    CompressionAlgorithm algorithm,
+    const char* input_file,
+    const char* output_file,
+    const CompressionOptions* options,
+    CompressionMetrics* metrics
+);
+
+/* Block-framed input is detected automatically and decoded in parallel. */
+COMPRESSION_API int decompress_file_ex(
+    CompressionAlgorithm algorithm,
+    const char* input_file,
+    const char* output_file,
+    const CompressionOptions* options,
+    CompressionMetrics* metrics
+);
+
+/* Runs every job on the shared worker pool, prefetching upcoming inputs,
+   and fills results[i] for jobs[i]. options may be NULL (legacy format for
+   compression). Returns 1 only if every job succeeded. */
+COMPRESSION_API int compress_files_batch(
+    const CompressionJob* jobs,
+    uint32_t count,
+    const CompressionOptions* options,
+    CompressionMetrics* results
+);
+
+/* Queues a job on the shared worker pool and returns immediately. Paths and
+   options are copied. callback may be NULL. Every returned handle must be
+   released with release_compression_job. Returns NULL on invalid input. */
+COMPRESSION_API CompressionJobHandle submit_compression_job(
+    const CompressionJob* job,
+    const CompressionOptions* options,
+    CompressionJobCallback callback,
+    void* user_data
+);
+
+/* Returns the current status; metrics (may be NULL) is filled once finished. */
+COMPRESSION_API CompressionJobStatus poll_compression_job(CompressionJobHandle job, CompressionMetrics* metrics);
+
+COMPRESSION_API CompressionJobStatus wait_compression_job(CompressionJobHandle job, CompressionMetrics* metrics);
+
+/* Requests cancellation. Queued jobs finish immediately; block-framed jobs
+   stop at the next block boundary and remove their partial output (kept
+   when a checkpoint_path is set, for resuming); legacy
+   single-stream jobs run to completion once started. Returns 0 if the job
+   had already finished. */
+COMPRESSION_API int cancel_compression_job(CompressionJobHandle job);
+
+COMPRESSION_API void release_compression_job(CompressionJobHandle job);
+
+/* Sizes the shared worker pool. 0 = one thread per usable CPU, honouring the
+   process affinity mask and the cgroup CPU quota. Must be called before the
+   first parallel operation; returns 0 if the pool already runs with a
+   different size. */
+COMPRESSION_API int set_thread_pool_size(uint32_t threads);
+
+/* Like set_thread_pool_size; with pin_workers non-zero each worker is bound
+   to one CPU of the affinity mask (Linux only), keeping the buffers it
+   allocates on its NUMA node. */
+COMPRESSION_API int configure_thread_pool(uint32_t threads, int pin_workers);
+
+COMPRESSION_API uint32_t get_thread_pool_size(void);
+
+/* Caps the work running at once across every API caller. Jobs that do not
+   fit wait in a single FIFO or priority queue; a job's thread count is
+   clamped to max_worker_threads. A job exceeding the limits on its own runs
+   once nothing else does. NULL removes all limits. Takes effect for queued
+   jobs immediately. */
+COMPRESSION_API int configure_admission_control(const AdmissionLimits* limits);
+
 COMPRESSION_API int get_file_size(const char* filename, uint64_t* size);
 
 COMPRESSION_API const char* get_algorithm_name(CompressionAlgorithm algorithm);
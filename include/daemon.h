@@ -0,0 +1,67 @@
+#pragma once
+
+#include "compression_api.h"
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct DaemonRequest {
+    std::string mode;        // "compress" or "decompress"
+    std::string algorithm;   // CLI algorithm name
+    size_t blockSize = 0;    // 0 = legacy single-stream format
+    std::string inputFile;   // absolute paths: the daemon has its own cwd
+    std::string outputFile;
+    // Job options under their CLI names without the dashes, e.g.
+    // {"level", "9"}; flags take "1". Paths among them must be absolute.
+    std::vector<std::pair<std::string, std::string>> options;
+};
+
+// Long-lived compression service on a Unix domain socket. The daemon keeps
+// the shared thread pool warm and runs every request through the library
+// API, so admission control applies across all clients. Only processes of
+// the daemon's own user (or root) may connect, and at most MAX_CONNECTIONS
+// are served at once; further clients wait in the listen backlog.
+//
+// Protocol: one request per line, fields separated by tabs
+//   mode \t algorithm \t block size \t input \t output [\t name=value]... \n
+// where the optional fields are the job options: level, window,
+// chain-depth, match-finder, link-blocks, entropy, memory,
+// rebuild-interval, threads, checkpoint, resume, max-read-mbps,
+// max-write-mbps, max-cpu and progress. An unknown name fails the request
+// rather than being ignored. The answer is
+//   OK \t original bytes \t compressed bytes \t milliseconds \n
+//   ERR \t message \n
+// preceded, with progress=1, by any number of
+//   PROGRESS \t bytes processed \t total bytes \t MB/s \t ETA seconds \n
+// A connection may carry any number of requests.
+class CompressionDaemon {
+public:
+    static constexpr size_t MAX_CONNECTIONS = 64;
+
+    // Serves until SIGINT or SIGTERM. Returns false if the socket could not
+    // be set up.
+    static bool serve(const std::string& socketPath);
+
+    // Sends one request and waits for the answer line (without "\n"),
+    // passing any progress lines before it to progress.
+    static bool submit(const std::string& socketPath, const DaemonRequest& request, std::string& reply,
+                       CompressionProgressCallback progress = nullptr);
+
+private:
+    static void handleConnection(int fd);
+
+    // Peers of another user could read and write files with the daemon's
+    // permissions.
+    static bool isTrustedPeer(int fd);
+
+    static std::string handleRequest(int fd, const std::string& line);
+
+    // Progress callback of a job with progress=1; userData points at the
+    // client's socket. Only the job writes to it until the answer.
+    static void sendProgress(const CompressionProgress* progress, void* userData);
+
+    static bool readLine(int fd, std::string& buffer, std::string& line);
+
+    static bool writeAll(int fd, const std::string& data);
+};
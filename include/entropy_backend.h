@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Order-0 byte coders that codecs with a final entropy stage choose between.
+// The values are stored in those codecs' formats and must not change.
+enum class EntropyCoder : uint8_t { HUFFMAN = 0, TANS = 1, RANS = 2 };
+
+// Dispatches to HuffmanCompressor, ANSCompressor or RANSCompressor. The
+// caller records the coder and the raw size; the coded bytes carry neither.
+class EntropyBackend {
+public:
+    static bool isValid(uint8_t coder);
+
+    static const char* name(EntropyCoder coder);
+
+    // Appends the coding of data[0, size) to output.
+    static void encode(EntropyCoder coder, const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+
+    // Decodes exactly rawSize bytes from all of input[0, inputSize).
+    static bool decode(EntropyCoder coder, const uint8_t* input, size_t inputSize, uint8_t* output, size_t rawSize);
+};
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "bit_buffer.h"
+#include "huffman.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Codec pipelines composed at compile time, e.g.
+//
+//   FusedPipeline<DeltaStage<4>, RLEStage, HuffmanStage>
+//
+// Every stage but the last is a byte transform whose Encoder and Decoder
+// push each output byte straight into the next stage; the last stage is the
+// entropy coder. The nested stage types are known to the compiler, so a
+// block runs through all of them in one loop per pass, with no virtual
+// calls and no buffer between stages. Unlike TransformChain, which picks
+// its stages at run time, an instantiation is a fixed format of its own.
+//
+// A transform stage provides
+//   template <typename Next> class Encoder;   // put(byte), finish()
+//   template <typename Next> class Decoder;   // put(byte), bool finish()
+// each owning its Next and constructed from the sink at the far end.
+//
+// Block layout: raw size varint | whatever the entropy stage writes.
+
+// Difference from the byte Stride positions back, for samples Stride bytes
+// wide (Stride 1 for 8-bit data, 4 for 32-bit words).
+template <unsigned Stride>
+struct DeltaStage {
+    static_assert(Stride > 0, "Stride must be positive");
+
+    template <typename Next>
+    class Encoder {
+    public:
+        template <typename Sink>
+        explicit Encoder(const Sink& sink) : next_(sink) {}
+
+        void put(uint8_t byte) {
+            next_.put(static_cast<uint8_t>(byte - history_[position_]));
+            history_[position_] = byte;
+            position_ = position_ + 1 == Stride ? 0 : position_ + 1;
+        }
+
+        void finish() {
+            next_.finish();
+        }
+
+    private:
+        Next next_;
+        uint8_t history_[Stride] = {};
+        unsigned position_ = 0;
+    };
+
+    template <typename Next>
+    class Decoder {
+    public:
+        template <typename Sink>
+        explicit Decoder(const Sink& sink) : next_(sink) {}
+
+        void put(uint8_t difference) {
+            uint8_t byte = static_cast<uint8_t>(history_[position_] + difference);
+            history_[position_] = byte;
+            position_ = position_ + 1 == Stride ? 0 : position_ + 1;
+            next_.put(byte);
+        }
+
+        bool finish() {
+            return next_.finish();
+        }
+
+    private:
+        Next next_;
+        uint8_t history_[Stride] = {};
+        unsigned position_ = 0;
+    };
+};
+
+// bzip2-style run-length coding: after RUN_THRESHOLD equal bytes, one byte
+// counts how many more follow (up to 255). Shorter runs pass through
+// unchanged, so text barely grows, unlike RLECompressor's count/byte pairs.
+struct RLEStage {
+    static constexpr unsigned RUN_THRESHOLD = 4;
+    static constexpr unsigned MAX_EXTRA = 255;
+
+    template <typename Next>
+    class Encoder {
+    public:
+        template <typename Sink>
+        explicit Encoder(const Sink& sink) : next_(sink) {}
+
+        void put(uint8_t byte) {
+            if (run_ == RUN_THRESHOLD) {
+                if (byte == last_ && extra_ < MAX_EXTRA) {
+                    extra_++;
+                    return;
+                }
+                next_.put(static_cast<uint8_t>(extra_));
+                run_ = 0;
+                extra_ = 0;
+            }
+            if (byte == last_) {
+                run_++;
+            } else {
+                last_ = byte;
+                run_ = 1;
+            }
+            next_.put(byte);
+        }
+
+        void finish() {
+            if (run_ == RUN_THRESHOLD) {
+                next_.put(static_cast<uint8_t>(extra_));
+            }
+            next_.finish();
+        }
+
+    private:
+        Next next_;
+        int last_ = -1;
+        unsigned run_ = 0;
+        unsigned extra_ = 0;
+    };
+
+    template <typename Next>
+    class Decoder {
+    public:
+        template <typename Sink>
+        explicit Decoder(const Sink& sink) : next_(sink) {}
+
+        void put(uint8_t symbol) {
+            if (run_ == RUN_THRESHOLD) {
+                for (unsigned i = 0; i < symbol; i++) {
+                    next_.put(static_cast<uint8_t>(last_));
+                }
+                run_ = 0;
+                return;
+            }
+            if (symbol == last_) {
+                run_++;
+            } else {
+                last_ = symbol;
+                run_ = 1;
+            }
+            next_.put(symbol);
+        }
+
+        // A full run must be followed by its count.
+        bool finish() {
+            return run_ != RUN_THRESHOLD && next_.finish();
+        }
+
+    private:
+        Next next_;
+        int last_ = -1;
+        unsigned run_ = 0;
+    };
+};
+
+// Final stage: one canonical Huffman code per block over the transformed
+// bytes. Building the code needs their counts, so the transforms run twice,
+// once into a counter and once into the coder; that is cheaper than storing
+// the transformed block and reading it again. Codes are at most
+// CanonicalHuffmanDecoder::TABLE_BITS long, so each symbol decodes with one
+// lookup.
+//
+// Layout: symbol count varint | 256 code lengths, 4 bits each | codes,
+// LSB-first.
+struct HuffmanStage {
+    // drive(sink) must push the whole block through the transforms into
+    // sink and finish it.
+    template <typename Drive>
+    static void encode(Drive drive, std::vector<uint8_t>& output) {
+        std::vector<uint32_t> frequencies(256, 0);
+        uint64_t symbols = 0;
+        drive(CountingSink{frequencies.data(), &symbols});
+
+        std::vector<uint8_t> lengths =
+            HuffmanCompressor::buildCodeLengths(frequencies, CanonicalHuffmanDecoder::TABLE_BITS);
+        std::vector<uint32_t> codes = HuffmanCompressor::buildCanonicalCodes(lengths);
+
+        writeVarint(output, symbols);
+        BitBufferWriter writer(output);
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            writer.write(lengths[symbol], 4);
+        }
+        drive(CodingSink{&writer, codes.data(), lengths.data()});
+        writer.flush();
+    }
+
+    // Feeds every decoded symbol to decoder; false on corrupt input.
+    template <typename Decoder>
+    static bool decode(const uint8_t* input, size_t inputSize, Decoder& decoder) {
+        const uint8_t* ip = input;
+        const uint8_t* end = input + inputSize;
+        uint64_t symbols;
+        if (!readVarint(ip, end, symbols) || symbols > static_cast<uint64_t>(end - ip) * 8) {
+            return false;
+        }
+
+        BitBufferReader reader(ip, static_cast<size_t>(end - ip));
+        uint8_t lengths[256];
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            lengths[symbol] = static_cast<uint8_t>(reader.read(4));
+        }
+        CanonicalHuffmanDecoder table;
+        if (!table.build(lengths, 256)) {
+            return false;
+        }
+
+        for (uint64_t i = 0; i < symbols; i++) {
+            int symbol = table.decode(reader);
+            if (symbol < 0) {
+                return false;
+            }
+            decoder.put(static_cast<uint8_t>(symbol));
+        }
+        return !reader.overrun() && reader.bytesConsumed() == static_cast<size_t>(end - ip);
+    }
+
+private:
+    struct CountingSink {
+        uint32_t* frequencies;
+        uint64_t* symbols;
+
+        void put(uint8_t symbol) {
+            frequencies[symbol]++;
+            ++*symbols;
+        }
+
+        void finish() {}
+    };
+
+    struct CodingSink {
+        BitBufferWriter* writer;
+        const uint32_t* codes;
+        const uint8_t* lengths;
+
+        void put(uint8_t symbol) {
+            writer->write(codes[symbol], lengths[symbol]);
+        }
+
+        void finish() {}
+    };
+};
+
+// Encoders nested first to last around Sink; the entropy stage is left out.
+template <typename Sink, typename... Stages>
+struct FusedEncoderChain;
+
+template <typename Sink, typename Last>
+struct FusedEncoderChain<Sink, Last> {
+    using type = Sink;
+};
+
+template <typename Sink, typename First, typename Second, typename... Rest>
+struct FusedEncoderChain<Sink, First, Second, Rest...> {
+    using type = typename First::template Encoder<typename FusedEncoderChain<Sink, Second, Rest...>::type>;
+};
+
+// Decoders nested last to first around Sink, so the entropy stage's output
+// enters the last transform's decoder.
+template <typename Sink, typename... Stages>
+struct FusedDecoderChain;
+
+template <typename Sink, typename Last>
+struct FusedDecoderChain<Sink, Last> {
+    using type = Sink;
+};
+
+template <typename Sink, typename First, typename Second, typename... Rest>
+struct FusedDecoderChain<Sink, First, Second, Rest...> {
+    using type = typename FusedDecoderChain<typename First::template Decoder<Sink>, Second, Rest...>::type;
+};
+
+template <typename... Stages>
+struct FusedEntropyStage;
+
+template <typename Last>
+struct FusedEntropyStage<Last> {
+    using type = Last;
+};
+
+template <typename First, typename Second, typename... Rest>
+struct FusedEntropyStage<First, Second, Rest...> : FusedEntropyStage<Second, Rest...> {
+};
+
+template <typename... Stages>
+class FusedPipeline {
+    static_assert(sizeof...(Stages) > 0, "A pipeline needs an entropy stage");
+
+    using Entropy = typename FusedEntropyStage<Stages...>::type;
+
+public:
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+        output.clear();
+        writeVarint(output, input.size());
+        Entropy::encode(
+            [&input](auto sink) {
+                typename FusedEncoderChain<decltype(sink), Stages...>::type encoder(sink);
+                for (uint8_t byte : input) {
+                    encoder.put(byte);
+                }
+                encoder.finish();
+            },
+            output);
+        return true;
+    }
+
+    // Fails on a block of more than maxSize bytes before allocating it.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize) {
+        const uint8_t* ip = input.data();
+        const uint8_t* end = input.data() + input.size();
+        uint64_t rawSize;
+        if (!readVarint(ip, end, rawSize) || rawSize > maxSize) {
+            return false;
+        }
+
+        output.resize(static_cast<size_t>(rawSize));
+        size_t written = 0;
+        typename FusedDecoderChain<OutputSink, Stages...>::type decoder(
+            OutputSink{output.data(), output.size(), &written});
+        return Entropy::decode(ip, static_cast<size_t>(end - ip), decoder) && decoder.finish() &&
+               written == rawSize;
+    }
+
+private:
+    // Writes into the preallocated output; bytes past its end are only
+    // counted, so a corrupt block fails the size check instead of
+    // overrunning.
+    struct OutputSink {
+        uint8_t* data;
+        size_t capacity;
+        size_t* position;
+
+        void put(uint8_t byte) {
+            if (*position < capacity) {
+                data[*position] = byte;
+            }
+            ++*position;
+        }
+
+        bool finish() {
+            return true;
+        }
+    };
+};
+
+// The instantiations exposed as algorithms, compiled once in
+// fused_pipeline.cpp.
+using RLEHuffmanPipeline = FusedPipeline<RLEStage, HuffmanStage>;
+using DeltaRLEHuffmanPipeline = FusedPipeline<DeltaStage<4>, RLEStage, HuffmanStage>;
+
+extern template class FusedPipeline<RLEStage, HuffmanStage>;
+extern template class FusedPipeline<DeltaStage<4>, RLEStage, HuffmanStage>;
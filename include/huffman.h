@@ -1,10 +1,14 @@
 #pragma once
 
 #include <string>
+#include <iosfwd>
 #include <unordered_map>
 #include <queue>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "bit_buffer.h"
 
 struct HuffmanNode {
     unsigned char character;
@@ -39,15 +43,105 @@ public:
     static bool decompress(const std::string& inputFile, const std::string& outputFile);
     
     static bool isValidHuffmanFile(const std::string& filename);
+    
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+    
+    // Fails on a block of more than maxSize bytes before allocating it.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize);
+
+    // Order-1 mode: the previous byte selects one of up to MAX_CONTEXT_TABLES
+    // canonical code tables. The 256 contexts are clustered by their symbol
+    // statistics, and the table count that gives the smallest output wins.
+    // Codes are at most CanonicalHuffmanDecoder::TABLE_BITS long, so every
+    // symbol decodes with one lookup.
+    //
+    // File layout: "HUF1" | version u8, then chunks of raw size u32 | coded
+    // size u32 | coded bytes (little-endian), ending with a raw size of 0.
+    // Each chunk is coded on its own with its own tables.
+    // Block layout: raw size varint | coded bytes.
+    static bool compressOrder1(const std::string& inputFile, const std::string& outputFile);
+
+    static bool decompressOrder1(const std::string& inputFile, const std::string& outputFile);
+
+    static bool isValidOrder1File(const std::string& filename);
+
+    static bool compressOrder1Block(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+
+    // Fails on a block of more than maxSize bytes before allocating it.
+    static bool decompressOrder1Block(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                      size_t maxSize);
+
+    // Adaptive mode: one pass, no size known up front, so it can compress
+    // pipes. Encoder and decoder start from flat counts and rebuild the same
+    // canonical code after every segment. Segments start at 256 bytes and
+    // double up to the rebuild interval; each is written, and the output
+    // flushed, as soon as it is full or the input ends.
+    //
+    // File layout: "HUFS" | version u8 | log2 of the interval u8, then
+    // segments of raw size varint | coded size varint | coded bytes, ending
+    // with a raw size of 0.
+    // Block layout: the same segments without the header.
+    static constexpr uint32_t MIN_REBUILD_INTERVAL = 1u << 8;
+    static constexpr uint32_t MAX_REBUILD_INTERVAL = 1u << 20;
+    static constexpr uint32_t DEFAULT_REBUILD_INTERVAL = 1u << 12;
+
+    // interval is rounded up to a power of two within the range above.
+    static bool compressAdaptive(const std::string& inputFile, const std::string& outputFile,
+                                 uint32_t interval = DEFAULT_REBUILD_INTERVAL);
+
+    static bool decompressAdaptive(const std::string& inputFile, const std::string& outputFile);
+
+    static bool compressStream(std::istream& input, std::ostream& output,
+                               uint32_t interval = DEFAULT_REBUILD_INTERVAL);
+
+    static bool decompressStream(std::istream& input, std::ostream& output);
+
+    static bool isValidAdaptiveFile(const std::string& filename);
+
+    static bool compressAdaptiveBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                      uint32_t interval = DEFAULT_REBUILD_INTERVAL);
+
+    // Fails on a block of more than maxSize bytes before allocating past it.
+    static bool decompressAdaptiveBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                        size_t maxSize);
+
+    // Canonical code construction for coders with alphabets other than
+    // bytes. Unused symbols get length 0 and a lone used symbol length 1;
+    // longer codes are capped at maxLength by lengthening the rarest
+    // shorter ones until the code fits.
+    static std::vector<uint8_t> buildCodeLengths(const std::vector<uint32_t>& frequencies, unsigned maxLength);
+
+    // Canonical codes for the given lengths, bit-reversed for BitBufferWriter.
+    static std::vector<uint32_t> buildCanonicalCodes(const std::vector<uint8_t>& lengths);
 
 private:
     using HuffmanTree = std::shared_ptr<HuffmanNode>;
     using FrequencyTable = std::unordered_map<unsigned char, int>;
     using CodeTable = std::unordered_map<unsigned char, std::string>;
     using PriorityQueue = std::priority_queue<HuffmanTree, std::vector<HuffmanTree>, HuffmanNodeComparator>;
+
+    static constexpr char ORDER1_MAGIC[4] = {'H', 'U', 'F', '1'};
+    static constexpr uint8_t ORDER1_VERSION = 1;
+    static constexpr size_t ORDER1_CHUNK_SIZE = 1u << 20;
+    static constexpr unsigned MAX_CONTEXT_TABLES = 8;
+
+    static constexpr char ADAPTIVE_MAGIC[4] = {'H', 'U', 'F', 'S'};
+    static constexpr uint8_t ADAPTIVE_VERSION = 1;
+
+    static unsigned rebuildIntervalBits(uint32_t interval);
+
+    // Order-1 coding of data[0, size): table count u8, the context map
+    // (ceil(log2(tables)) bits per context), 4-bit code lengths for each
+    // table, then the codes, all LSB-first.
+    static void encodeOrder1(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+
+    // Decodes exactly rawSize bytes from all of input[0, inputSize).
+    static bool decodeOrder1(const uint8_t* input, size_t inputSize, uint8_t* output, size_t rawSize);
     
     static FrequencyTable buildFrequencyTable(const std::string& filename);
     
+    static FrequencyTable buildFrequencyTable(const std::vector<uint8_t>& data);
+    
     static HuffmanTree buildHuffmanTree(const FrequencyTable& frequencies);
     
     static void generateCodes(const HuffmanTree& root, const std::string& code, CodeTable& codeTable);
@@ -64,4 +158,34 @@ private:
     static bool fileExists(const std::string& filename);
     
     static size_t getFileSize(const std::string& filename);
-};
\ No newline at end of file
+};
+
+// Table-driven decoder for codes from HuffmanCompressor::buildCanonicalCodes.
+// Codes up to TABLE_BITS long resolve with one lookup; longer ones walk the
+// per-length counts. Alphabets may have up to 4096 symbols.
+class CanonicalHuffmanDecoder {
+public:
+    static constexpr unsigned MAX_CODE_LENGTH = 15;
+    static constexpr unsigned TABLE_BITS = 10;
+
+    // Returns false if the lengths over-subscribe the code space.
+    bool build(const uint8_t* lengths, size_t count);
+
+    // Decodes one symbol, or returns -1 for a bit pattern with no code.
+    int decode(BitBufferReader& reader) const {
+        uint16_t entry = table_[reader.peek(TABLE_BITS)];
+        if (entry & 15) {
+            reader.consume(entry & 15);
+            return entry >> 4;
+        }
+        return decodeSlow(reader);
+    }
+
+private:
+    int decodeSlow(BitBufferReader& reader) const;
+
+    // symbol << 4 | length, or 0 for codes longer than TABLE_BITS.
+    std::vector<uint16_t> table_;
+    uint16_t counts_[MAX_CODE_LENGTH + 1];
+    std::vector<uint16_t> symbols_;
+};
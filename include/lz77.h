@@ -0,0 +1,155 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+// How the parser finds matches. Hash chains are fastest; binary trees
+// (bt4) find the longest matches in bounded time even on repetitive data;
+// a suffix array sorts the whole visible buffer up front, using about 12
+// bytes per byte of window plus chunk.
+enum class LZ77MatchFinder { LEVEL_DEFAULT, HASH_CHAIN, BINARY_TREE, SUFFIX_ARRAY };
+
+struct LZ77Params {
+    // Sliding window in bytes, rounded up to a power of two within
+    // [MIN_WINDOW, MAX_WINDOW]. In block mode the block also bounds it.
+    uint32_t windowSize = 1u << 20;
+    // Match candidates examined per position (per side of the suffix
+    // array); 0 uses the level's depth.
+    uint32_t chainDepth = 0;
+    // 1-3 parse greedily, 4-5 look one position ahead for a better match,
+    // 6-7 two positions, and 8-9 choose the cheapest parse under a cost
+    // model. Higher levels also search deeper, and 8-9 use binary trees.
+    uint32_t level = 3;
+    LZ77MatchFinder matchFinder = LZ77MatchFinder::LEVEL_DEFAULT;
+};
+
+// One parsed step: literalLength literals followed by a match of
+// matchLength bytes copied from offset bytes back. The trailing literals of
+// a chunk form a sequence with matchLength 0.
+struct LZ77Sequence {
+    uint32_t literalLength;
+    uint32_t matchLength;
+    uint32_t offset;
+};
+
+// Bit costs minimized by the optimal parser (levels 8-9), in 1/16 bits. The
+// base class prices the LZ77 sequence format; entropy-coded formats derive
+// their own and may learn from the literals and matches the parser commits,
+// which it reports before calling refresh() after every parsed segment.
+class LZ77CostModel {
+public:
+    static constexpr uint32_t SCALE = 16;
+
+    virtual ~LZ77CostModel() = default;
+
+    virtual uint32_t literalCost(uint8_t byte) const;
+
+    // The cost of a match is lengthCost + offsetCost.
+    virtual uint32_t lengthCost(uint32_t length) const;
+
+    virtual uint32_t offsetCost(uint32_t offset) const;
+
+    virtual void observeLiteral(uint8_t) {}
+
+    virtual void observeMatch(uint32_t, uint32_t) {}
+
+    virtual void refresh() {}
+};
+
+// Sliding-window LZ77 with a hash-chain match finder.
+//
+// Sequence encoding (LZ4-style): a token byte holding the literal length
+// and match length - MIN_MATCH in its high and low nibbles (15 continues in
+// 255-terminated extra bytes), the literals, then the offset as a LEB128
+// varint and any extra match-length bytes. The decoder stops as soon as the
+// expected number of bytes has been produced, so trailing literals carry no
+// offset.
+//
+// File layout: "LZ77" | version u8 | log2(window) u8, then chunks of
+// raw size u32 | encoded size u32 | sequences (little-endian), ending with a
+// raw size of 0. Matches may reach back into earlier chunks.
+// Block layout: raw size varint | sequences. A block may be primed with
+// history: the bytes that precede it, which matches can reach into but which
+// are not encoded, so the decoder must supply the same bytes.
+class LZ77Compressor {
+public:
+    static constexpr uint32_t MIN_MATCH = 4;
+    static constexpr uint32_t MIN_WINDOW = 1u << 16;
+    static constexpr uint32_t MAX_WINDOW = 1u << 24;
+    static constexpr uint32_t MIN_LEVEL = 1;
+    static constexpr uint32_t MAX_LEVEL = 9;
+
+    static bool compress(const std::string& inputFile, const std::string& outputFile,
+                         const LZ77Params& params = LZ77Params());
+
+    static bool decompress(const std::string& inputFile, const std::string& outputFile);
+
+    static bool isValidLZ77File(const std::string& filename);
+
+    // input[0, historySize) is history; only the rest is encoded.
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                              const LZ77Params& params = LZ77Params(), size_t historySize = 0);
+
+    // output[0, historySize) must hold the history; the block is appended.
+    // Fails on a block of more than maxSize bytes before allocating it.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize,
+                                size_t historySize = 0);
+
+    // Parses data[start, end) into sequences. Matches may start anywhere in
+    // data[0, end) within the window, so bytes before start act as history.
+    // Exposed so other formats can entropy-code the same parse, passing
+    // their own cost model for the optimal levels.
+    static void parse(const uint8_t* data, size_t start, size_t end, const LZ77Params& params,
+                      std::vector<LZ77Sequence>& sequences, LZ77CostModel* costs = nullptr);
+
+    static void encodeSequences(const uint8_t* data, size_t start, const std::vector<LZ77Sequence>& sequences,
+                                std::vector<uint8_t>& output);
+
+    // Decodes into output[start, start + rawSize); output[0, start) is the
+    // history matches may refer to. output must have at least rawSize +
+    // COPY_SLACK bytes of room after start, which the wide copies may scribble
+    // over.
+    static bool decodeSequences(const uint8_t* input, size_t inputSize, uint8_t* output, size_t start,
+                                size_t rawSize);
+
+    static constexpr size_t COPY_SLACK = 16;
+
+    // Copies a match of length bytes from offset bytes back to op. May write
+    // up to 7 bytes past the end of the match.
+    static void copyMatch(uint8_t* op, size_t offset, size_t length);
+
+    // Chunk coders for the streaming file layout, so other sequence coders
+    // can share its framing and history handling under their own magic.
+    // The encoder appends data[start, end) to output; the decoder has the
+    // contract of decodeSequences.
+    using ChunkEncoder = std::function<void(const uint8_t* data, size_t start, size_t end,
+                                            const LZ77Params& params, std::vector<uint8_t>& output)>;
+    using ChunkDecoder = std::function<bool(const uint8_t* input, size_t inputSize, uint8_t* output,
+                                            size_t start, size_t rawSize)>;
+
+    static bool compressStream(const std::string& inputFile, const std::string& outputFile, const char magic[4],
+                               const LZ77Params& params, const ChunkEncoder& encode);
+
+    static bool decompressStream(const std::string& inputFile, const std::string& outputFile, const char magic[4],
+                                 const std::string& formatName, const ChunkDecoder& decode);
+
+    static uint32_t normalizedWindow(uint32_t windowSize);
+
+private:
+    static constexpr char MAGIC[4] = {'L', 'Z', '7', '7'};
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    // Input consumed per file chunk, on top of the window kept as history.
+    static constexpr size_t CHUNK_SIZE = 1u << 20;
+
+    static void writeU32(std::ofstream& output, uint32_t value);
+
+    static bool readU32(std::ifstream& input, uint32_t& value);
+
+    static bool fileExists(const std::string& filename);
+
+    static size_t getFileSize(const std::string& filename);
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "lz77.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Deflate-style LZ77 + Huffman: the LZ77Compressor parse, entropy-coded with
+// canonical Huffman codes over a literal/length alphabet (256 literals,
+// end-of-block, 32 length buckets) and a separate 48-symbol distance
+// alphabet. Codes are rebuilt for every sub-block of SUBBLOCK_SYMBOLS.
+//
+// Match lengths (minus MIN_MATCH) and offsets (minus one) map to log2
+// buckets: values below 4 are their own symbol, larger ones keep their top
+// two bits in the symbol and send the rest as extra bits.
+//
+// Chunk payload: a mode byte, then either the raw bytes (stored) or an LSB-
+// first bit stream of sub-blocks: final flag (1 bit), literal/length and
+// distance symbol counts (6 bits each), 4-bit code lengths, the symbols and
+// end-of-block.
+// File layout: as LZ77Compressor with magic "LZHF".
+// Block layout: raw size varint | chunk payload.
+class LZHCompressor {
+public:
+    static bool compress(const std::string& inputFile, const std::string& outputFile,
+                         const LZ77Params& params = LZ77Params());
+
+    static bool decompress(const std::string& inputFile, const std::string& outputFile);
+
+    static bool isValidLZHFile(const std::string& filename);
+
+    // History as in LZ77Compressor::compressBlock and decompressBlock.
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                              const LZ77Params& params = LZ77Params(), size_t historySize = 0);
+
+    // Fails on a block of more than maxSize bytes, history aside.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize,
+                                size_t historySize = 0);
+
+    // Chunk coders with the contracts of the LZ77Compressor equivalents.
+    static void encodeSequences(const uint8_t* data, size_t start, const std::vector<LZ77Sequence>& sequences,
+                                std::vector<uint8_t>& output);
+
+    static bool decodeSequences(const uint8_t* input, size_t inputSize, uint8_t* output, size_t start,
+                                size_t rawSize);
+
+private:
+    // Prices the optimal parse from the symbol statistics seen so far.
+    class CostModel;
+
+    static constexpr char MAGIC[4] = {'L', 'Z', 'H', 'F'};
+    static constexpr uint32_t END_OF_BLOCK = 256;
+    static constexpr uint32_t LENGTH_CODES = 32;
+    static constexpr uint32_t DISTANCE_CODES = 48;
+    static constexpr uint32_t LITERAL_LENGTH_CODES = END_OF_BLOCK + 1 + LENGTH_CODES;
+    static constexpr uint32_t MAX_MATCH = LZ77Compressor::MIN_MATCH + 0xFFFF;
+    static constexpr unsigned MAX_CODE_LENGTH = 15;
+    static constexpr size_t SUBBLOCK_SYMBOLS = 1u << 16;
+    static constexpr uint8_t MODE_HUFFMAN = 0;
+    static constexpr uint8_t MODE_STORED = 1;
+};
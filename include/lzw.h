@@ -4,31 +4,33 @@
 #include <unordered_map>
 #include <vector>
 #include <fstream>
+#include <istream>
+#include <ostream>
 #include <cstdint>
 
 class BitWriter {
 public:
-    BitWriter(std::ofstream& output);
+    BitWriter(std::ostream& output);
     ~BitWriter();
     
     void writeBits(uint32_t value, int numBits);
     void flush();
 
 private:
-    std::ofstream& output_;
+    std::ostream& output_;
     uint32_t buffer_;
     int bitsInBuffer_;
 };
 
 class BitReader {
 public:
-    BitReader(std::ifstream& input);
+    BitReader(std::istream& input);
     
     uint32_t readBits(int numBits);
     bool hasData() const;
 
 private:
-    std::ifstream& input_;
+    std::istream& input_;
     uint32_t buffer_;
     int bitsInBuffer_;
     bool endOfFile_;
@@ -43,8 +45,19 @@ public:
     static bool decompress(const std::string& inputFile, const std::string& outputFile);
     
     static bool isValidLZWFile(const std::string& filename);
+    
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+    
+    // Fails on a block of more than maxSize bytes.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize);
 
 private:
+    // Files start with MAGIC and FORMAT_VERSION. Headerless files are the
+    // original format, whose decoder widens codes one entry late; no
+    // stream can start with 0xFF, since its first code is below 512.
+    static constexpr char MAGIC[4] = {'\xFF', 'L', 'Z', 'W'};
+    static constexpr uint8_t FORMAT_VERSION = 2;
+    
     static constexpr uint16_t INITIAL_CODE_WIDTH = 9;
     static constexpr uint16_t MAX_CODE_WIDTH = 15;
     static constexpr uint16_t MAX_DICTIONARY_SIZE = (1 << MAX_CODE_WIDTH);
@@ -59,9 +72,11 @@ private:
     
     static DecompressionDictionary buildDecompressionDictionary();
     
-    static bool compressData(std::ifstream& input, BitWriter& writer);
+    static bool compressData(std::istream& input, BitWriter& writer);
     
-    static bool decompressData(BitReader& reader, std::ofstream& output);
+    // Fails rather than write more than maxSize bytes; the dictionary only
+    // holds strings already written, so this bounds its memory too.
+    static bool decompressData(BitReader& reader, std::ostream& output, bool lateWidening, uint64_t maxSize);
     
     static bool fileExists(const std::string& filename);
     
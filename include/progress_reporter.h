@@ -0,0 +1,38 @@
+#pragma once
+
+#include "compression_api.h"
+#include <chrono>
+#include <cstdint>
+
+// Throttled progress notifications. advance() is meant to be called once per
+// block, never per byte; it only reads the clock when a callback is set and
+// only invokes it once the reporting interval has elapsed.
+class ProgressReporter {
+public:
+    // startBytes were done before this run, e.g. the part of the input a
+    // resumed job skips. They count towards the position but not towards
+    // the throughput or the ETA.
+    ProgressReporter(CompressionProgressCallback callback, void* userData,
+                     uint32_t intervalMs, uint64_t totalBytes, uint64_t startBytes = 0);
+
+    void advance(uint64_t bytes);
+
+    // Reports the final position, with the average throughput, regardless of
+    // the interval.
+    void finish();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void report(Clock::time_point now, bool final);
+
+    CompressionProgressCallback callback_;
+    void* userData_;
+    Clock::duration interval_;
+    uint64_t totalBytes_;
+    uint64_t startBytes_;
+    uint64_t processed_;
+    uint64_t lastReportedBytes_;
+    Clock::time_point start_;
+    Clock::time_point lastReport_;
+};
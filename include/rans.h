@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Order-0 range ANS with LANES interleaved 32-bit states.
+//
+// Frequencies are normalized to 2^SCALE_BITS. States stay in [2^16, 2^32)
+// and renormalize 16 bits at a time, so symbol i only touches state
+// i % LANES and the lanes decode independently: eight at once with AVX2
+// (one gather per step), or one after another on the portable path. The
+// AVX2 kernel is chosen at run time and both paths produce the same output.
+//
+// Segment layout (up to SEGMENT_SIZE input bytes each; the decoder knows
+// each segment's size from the total):
+//   mode u8, then for MODE_RANS: max symbol u8 | frequency varints for
+//   symbols 0..max | stream size varint | LANES final states u32 | 16-bit
+//   renormalization words in decoding order
+//   or for MODE_STORED the raw bytes.
+//
+// File layout: "RANS" | version u8, then chunks of raw size u32 | encoded
+// size u32 | segments (little-endian), ending with a raw size of 0.
+// Block layout: raw size varint | segments.
+class RANSCompressor {
+public:
+    static constexpr unsigned LANES = 8;
+    static constexpr unsigned SCALE_BITS = 12;
+
+    static bool compress(const std::string& inputFile, const std::string& outputFile);
+
+    static bool decompress(const std::string& inputFile, const std::string& outputFile);
+
+    static bool isValidRANSFile(const std::string& filename);
+
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+
+    // Fails on a block of more than maxSize bytes before allocating it.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize);
+
+    // Entropy back end with the contracts of ANSCompressor::encode/decode.
+    static void encode(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+
+    static bool decode(const uint8_t* input, size_t inputSize, uint8_t* output, size_t rawSize);
+
+    // Whether decode uses the AVX2 kernel on this CPU.
+    static bool simdAvailable();
+
+private:
+    static constexpr char MAGIC[4] = {'R', 'A', 'N', 'S'};
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr size_t SEGMENT_SIZE = 1u << 17;
+    static constexpr size_t CHUNK_SIZE = 1u << 20;
+    static constexpr uint8_t MODE_RANS = 0;
+    static constexpr uint8_t MODE_STORED = 1;
+
+    // Returns false if the rANS coding would not be smaller than the input.
+    static bool encodeSegment(const uint8_t* data, size_t size, std::vector<uint8_t>& output);
+
+    // Advances ip past the segment; false on corrupt input.
+    static bool decodeSegment(const uint8_t*& ip, const uint8_t* end, uint8_t* output, size_t size);
+
+    static void writeU32(std::ofstream& output, uint32_t value);
+
+    static bool readU32(std::ifstream& input, uint32_t& value);
+
+    static bool fileExists(const std::string& filename);
+
+    static size_t getFileSize(const std::string& filename);
+};
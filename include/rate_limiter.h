@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// Token bucket shared by the threads of one job. Tokens refill at a fixed
+// rate up to a burst of 100 ms worth. A request larger than the bucket is
+// still granted, leaving the bucket in debt, so callers working in whole
+// blocks are held to the average rate rather than rejected.
+class RateLimiter {
+public:
+    // ratePerSecond of 0 disables the limiter.
+    explicit RateLimiter(double ratePerSecond);
+
+    bool enabled() const { return rate_ > 0; }
+
+    // Takes amount tokens without waiting.
+    void consume(double amount);
+
+    // Takes amount tokens and sleeps until the bucket is out of debt.
+    // Returns false if cancelled while waiting.
+    bool acquire(double amount, const std::atomic<bool>* cancelled = nullptr);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Returns the seconds to wait before the bucket is out of debt.
+    double take(double amount);
+
+    std::mutex mutex_;
+    double rate_;
+    double burst_;
+    double tokens_;
+    Clock::time_point last_;
+};
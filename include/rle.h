@@ -3,6 +3,7 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <cstdint>
 
 class RLECompressor {
 public:
@@ -11,6 +12,11 @@ public:
     static bool decompress(const std::string& inputFile, const std::string& outputFile);
     
     static bool isValidRLEFile(const std::string& filename);
+    
+    static bool compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+    
+    // Fails on a block of more than maxSize bytes.
+    static bool decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize);
 
 private:
     static constexpr unsigned char MAX_RUN_LENGTH = 255;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class SuffixArray {
+public:
+    // Start offsets of the suffixes of data[0, size) in lexicographic order,
+    // built in linear time by induced sorting (SA-IS). A suffix that is a
+    // prefix of another sorts first. size must be below 2^31.
+    static std::vector<int32_t> build(const uint8_t* data, size_t size);
+
+    // rank[sa[i]] = i.
+    static std::vector<int32_t> inverse(const std::vector<int32_t>& sa);
+
+    // lcp[i] is the common prefix length of suffixes sa[i - 1] and sa[i];
+    // lcp[0] is 0. Kasai's algorithm, linear time.
+    static std::vector<int32_t> buildLcp(const uint8_t* data, const std::vector<int32_t>& sa,
+                                         const std::vector<int32_t>& rank);
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing scheduler shared by every parallel code path in the library.
+// Each worker owns a deque: it pops its own work LIFO and steals from the
+// others FIFO. Tasks submitted from outside the pool go to an injection
+// queue. Threads that wait on a TaskGroup help run queued tasks, so nested
+// parallelism (a batch job that splits a file into blocks) never spawns
+// extra threads or deadlocks on a full pool.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // With pinWorkers each worker binds itself to one CPU of the process
+    // affinity mask before it runs any task, so buffers it first touches stay
+    // on its NUMA node.
+    explicit ThreadPool(size_t threadCount, bool pinWorkers = false);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    static ThreadPool& instance();
+
+    // Sets the size of the shared pool. Only takes effect before the pool
+    // is first used; returns false once it already exists with another size.
+    static bool configure(size_t threadCount, bool pinWorkers = false);
+
+    // CPUs this process may actually use: the hardware thread count, reduced
+    // to the sched_getaffinity mask and the cgroup CPU quota when available.
+    static size_t defaultThreadCount();
+
+    void submit(Task task);
+
+    // Runs one queued task on the calling thread, if there is one.
+    bool runPendingTask();
+
+    size_t size() const;
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+
+    void pinCurrentWorker(size_t index);
+
+    static void runTask(Task& task);
+
+    bool takeTask(Task& task);
+
+    bool popBack(WorkQueue& queue, Task& task);
+
+    bool popFront(WorkQueue& queue, Task& task);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    WorkQueue injectQueue_;
+    std::vector<std::thread> workers_;
+    std::mutex sleepMutex_;
+    std::condition_variable wakeup_;
+    std::atomic<size_t> queuedTasks_;
+    bool stopping_;
+    std::vector<int> pinnedCpus_;
+};
+
+// Fork/join helper on top of ThreadPool. wait() executes pending pool work
+// while the group's tasks are outstanding and rethrows the first exception.
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::instance());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(ThreadPool::Task task);
+
+    void wait();
+
+private:
+    ThreadPool& pool_;
+    std::atomic<size_t> pending_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+};
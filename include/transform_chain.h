@@ -0,0 +1,80 @@
+#pragma once
+
+#include "compression_api.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct CodecParams;
+
+// A sequence of stages applied to each block in memory, the output of one
+// feeding the next, e.g. "bwt-raw+mtf+rle+ans". Decoding runs the stages
+// in reverse.
+//
+// A stage is either a block codec (its CompressionAlgorithm value, under
+// its CLI name) or one of the pure transforms below. Stage ids are stored in
+// the block container header and must not change.
+class TransformChain {
+public:
+    static constexpr size_t MAX_STAGES = 8;
+
+    // Move-to-front ranks.
+    static constexpr uint8_t MTF_STAGE = 64;
+    // Differences between consecutive bytes.
+    static constexpr uint8_t DELTA_STAGE = 65;
+    // BWTCompressor::transformBlock, the permutation without its coder.
+    static constexpr uint8_t BWT_RAW_STAGE = 66;
+
+    // Parses stage names joined by '+'. False for an unknown name, an empty
+    // or nested chain, or more than MAX_STAGES stages.
+    static bool parse(const std::string& spec, std::vector<uint8_t>& stages);
+
+    static std::string format(const std::vector<uint8_t>& stages);
+
+    static bool isValid(const std::vector<uint8_t>& stages);
+
+    // Stage id for a single name, or false if there is none.
+    static bool stageId(const std::string& name, uint8_t& stage);
+
+    // The algorithm an --algo name selects, shared by the CLI and the
+    // daemon: a codec stage name, "auto", or a chain (any name containing
+    // '+'; its stages are checked by parse). False for anything else.
+    static bool algorithmId(const std::string& name, CompressionAlgorithm& algorithm);
+
+    // Every name algorithmId accepts on its own, in id order.
+    static std::vector<std::string> algorithmNames();
+
+    // A block with an intermediate result larger than stageLimits allows is
+    // left as it is, which the container then stores.
+    static bool encode(const std::vector<uint8_t>& stages, const std::vector<uint8_t>& input,
+                       std::vector<uint8_t>& output, const CodecParams& params);
+
+    // maxSize bounds the decoded block as in BlockCodec::decode.
+    static bool decode(const std::vector<uint8_t>& stages, const std::vector<uint8_t>& input,
+                       std::vector<uint8_t>& output, size_t maxSize);
+
+private:
+    // Only the block's own size is known when decoding, so each stage's
+    // input is bounded by twice the bound on its output plus STAGE_SLACK,
+    // more than any stage adds to data that does not compress. The
+    // input of a size-preserving stage has the same bound as its output.
+    static constexpr size_t STAGE_SLACK = 4096;
+
+    // The bound on each stage's input, from the first stage, for a block of
+    // at most maxSize bytes.
+    static std::vector<size_t> stageLimits(const std::vector<uint8_t>& stages, size_t maxSize);
+
+    static bool isCodecStage(uint8_t stage);
+
+    // MTF and delta, which map every byte to one byte.
+    static bool isSizePreserving(uint8_t stage);
+
+    static void moveToFront(std::vector<uint8_t>& data);
+
+    static void inverseMoveToFront(std::vector<uint8_t>& data);
+
+    static void delta(std::vector<uint8_t>& data);
+
+    static void inverseDelta(std::vector<uint8_t>& data);
+};
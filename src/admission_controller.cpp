@@ -0,0 +1,151 @@
+#include "admission_controller.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <utility>
+
+AdmissionController::Ticket::Ticket(AdmissionController* owner, size_t threads, uint64_t memory)
+    : owner_(owner), threads_(threads), memory_(memory) {}
+
+AdmissionController::Ticket::Ticket(Ticket&& other) noexcept
+    : owner_(other.owner_), threads_(other.threads_), memory_(other.memory_) {
+    other.owner_ = nullptr;
+}
+
+AdmissionController::Ticket& AdmissionController::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        reset();
+        owner_ = other.owner_;
+        threads_ = other.threads_;
+        memory_ = other.memory_;
+        other.owner_ = nullptr;
+    }
+    return *this;
+}
+
+AdmissionController::Ticket::~Ticket() {
+    reset();
+}
+
+void AdmissionController::Ticket::reset() {
+    if (owner_) {
+        owner_->release(threads_, memory_);
+        owner_ = nullptr;
+    }
+}
+
+AdmissionController& AdmissionController::instance() {
+    static AdmissionController controller;
+    return controller;
+}
+
+void AdmissionController::configure(const Limits& limits) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    limits_ = limits;
+    admitWaiters(lock);
+}
+
+AdmissionController::Ticket AdmissionController::acquire(const Request& request) {
+    std::mutex mutex;
+    std::condition_variable admitted;
+    std::unique_ptr<Ticket> ticket;
+
+    enqueue(request, [&](Ticket granted) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ticket = std::make_unique<Ticket>(std::move(granted));
+        admitted.notify_one();
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    admitted.wait(lock, [&] { return ticket != nullptr; });
+    return std::move(*ticket);
+}
+
+uint64_t AdmissionController::enqueue(const Request& request, AdmitCallback onAdmitted) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t sequence = nextSequence_++;
+    waiting_.push_back(Waiter{sequence, request, std::move(onAdmitted)});
+    admitWaiters(lock);
+    return sequence;
+}
+
+bool AdmissionController::cancel(uint64_t sequence) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto waiter = std::find_if(waiting_.begin(), waiting_.end(),
+                               [sequence](const Waiter& w) { return w.sequence == sequence; });
+    if (waiter == waiting_.end()) {
+        return false;
+    }
+    waiting_.erase(waiter);
+    // It may have been the head holding back the requests behind it.
+    admitWaiters(lock);
+    return true;
+}
+
+void AdmissionController::release(size_t threads, uint64_t memory) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    activeJobs_--;
+    activeThreads_ -= threads;
+    activeMemory_ -= memory;
+    admitWaiters(lock);
+}
+
+void AdmissionController::admitWaiters(std::unique_lock<std::mutex>& lock) {
+    std::vector<std::pair<AdmitCallback, Ticket>> ready;
+
+    while (!waiting_.empty()) {
+        auto next = head();
+        if (!fits(next->request)) {
+            break;
+        }
+
+        size_t threads = grantedThreads(next->request);
+        activeJobs_++;
+        activeThreads_ += threads;
+        activeMemory_ += next->request.memory;
+        ready.emplace_back(std::move(next->onAdmitted), Ticket(this, threads, next->request.memory));
+        waiting_.erase(next);
+    }
+
+    lock.unlock();
+    for (auto& admitted : ready) {
+        admitted.first(std::move(admitted.second));
+    }
+    lock.lock();
+}
+
+size_t AdmissionController::grantedThreads(const Request& request) const {
+    size_t threads = std::max<size_t>(request.threads, 1);
+    if (limits_.maxThreads > 0) {
+        threads = std::min(threads, limits_.maxThreads);
+    }
+    return threads;
+}
+
+bool AdmissionController::fits(const Request& request) const {
+    if (activeJobs_ == 0) {
+        return true;
+    }
+    if (limits_.maxJobs > 0 && activeJobs_ + 1 > limits_.maxJobs) {
+        return false;
+    }
+    if (limits_.maxThreads > 0 && activeThreads_ + grantedThreads(request) > limits_.maxThreads) {
+        return false;
+    }
+    if (limits_.maxMemory > 0 && activeMemory_ + request.memory > limits_.maxMemory) {
+        return false;
+    }
+    return true;
+}
+
+std::vector<AdmissionController::Waiter>::iterator AdmissionController::head() {
+    if (!limits_.priorityOrder) {
+        return waiting_.begin();
+    }
+    return std::min_element(waiting_.begin(), waiting_.end(), [](const Waiter& a, const Waiter& b) {
+        if (a.request.priority != b.request.priority) {
+            return a.request.priority > b.request.priority;
+        }
+        return a.sequence < b.sequence;
+    });
+}
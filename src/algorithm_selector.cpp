@@ -0,0 +1,175 @@
+#include "algorithm_selector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+constexpr unsigned REPEAT_HASH_BITS = 12;
+constexpr unsigned DELTA_STRIDE = 4;
+// What order 1 is charged per context/symbol pair it uses, standing in
+// for the tables a real coder has to send.
+constexpr double ORDER1_PAIR_BITS = 8.0;
+
+// count * log2(count), tabulated for the small counts that dominate the
+// order-1 table.
+double countBits(uint32_t count) {
+    constexpr uint32_t TABLE_SIZE = 4096;
+    static const std::vector<double> table = [] {
+        std::vector<double> values(TABLE_SIZE, 0.0);
+        for (uint32_t c = 1; c < TABLE_SIZE; c++) {
+            values[c] = c * std::log2(static_cast<double>(c));
+        }
+        return values;
+    }();
+    return count < TABLE_SIZE ? table[count] : count * std::log2(static_cast<double>(count));
+}
+
+// Sum of count * log2(total / count), the ideal cost of the counted symbols
+// under their own frequencies.
+double codeBits(const uint32_t* counts, size_t size, uint64_t total) {
+    double bits = countBits(static_cast<uint32_t>(total));
+    for (size_t i = 0; i < size; i++) {
+        if (counts[i]) {
+            bits -= countBits(counts[i]);
+        }
+    }
+    return bits;
+}
+}
+
+bool AlgorithmSelector::probe(const std::string& filename, ProbeStats& stats) {
+    std::ifstream input(filename, std::ios::binary);
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(filename, ec);
+    if (!input.is_open() || ec) {
+        return false;
+    }
+
+    stats = ProbeStats();
+    stats.inputSize = size;
+    if (size == 0) {
+        return true;
+    }
+
+    // Evenly spaced chunks; a small input is read whole.
+    uint64_t sampleSize = std::clamp<uint64_t>(size / SAMPLE_FRACTION, MIN_SAMPLE, MAX_SAMPLE);
+    uint64_t chunks = size <= sampleSize ? (size + CHUNK_SIZE - 1) / CHUNK_SIZE : sampleSize / CHUNK_SIZE;
+    uint64_t stride = chunks > 1 && size > sampleSize ? (size - CHUNK_SIZE) / (chunks - 1) : CHUNK_SIZE;
+
+    std::vector<uint32_t> counts(256, 0);
+    std::vector<uint32_t> pairCounts(256 * 256, 0);
+    std::vector<uint32_t> deltaCounts(256, 0);
+    std::vector<uint32_t> seen(1u << REPEAT_HASH_BITS);
+    // DELTA_STRIDE zeros before the data stand in for the bytes before the
+    // chunk.
+    std::vector<uint8_t> buffer(DELTA_STRIDE + CHUNK_SIZE, 0);
+    uint8_t* chunk = buffer.data() + DELTA_STRIDE;
+    uint64_t runs = 0, repeats = 0, text = 0;
+
+    for (uint64_t c = 0; c < chunks; c++) {
+        input.seekg(static_cast<std::streamoff>(c * stride));
+        input.read(reinterpret_cast<char*>(chunk), CHUNK_SIZE);
+        size_t length = static_cast<size_t>(input.gcount());
+        if (length == 0) {
+            break;
+        }
+        input.clear();
+
+        // Contexts restart with each chunk, as if it followed zeros.
+        const uint8_t* data = chunk;
+        uint8_t previous = 0;
+        for (size_t i = 0; i < length; i++) {
+            uint8_t byte = data[i];
+            counts[byte]++;
+            pairCounts[previous * 256 + byte]++;
+            deltaCounts[static_cast<uint8_t>(byte - data[i - DELTA_STRIDE])]++;
+            runs += byte == previous;
+            text += static_cast<unsigned>(byte - 0x20) < 0x5F || byte == '\n' || byte == '\r' || byte == '\t';
+            previous = byte;
+        }
+
+        // A hash slot keeps the last 4-byte string that landed in it, so a
+        // match is a real repeat, if not always the nearest one.
+        std::fill(seen.begin(), seen.end(), 0);
+        for (size_t i = 0; i + 4 <= length; i++) {
+            uint32_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            uint32_t& slot = seen[(word * 2654435761u) >> (32 - REPEAT_HASH_BITS)];
+            repeats += slot == word;
+            slot = word;
+        }
+        stats.sampledBytes += length;
+    }
+
+    if (stats.sampledBytes == 0) {
+        return false;
+    }
+
+    const double n = static_cast<double>(stats.sampledBytes);
+    stats.entropy = codeBits(counts.data(), 256, stats.sampledBytes) / n;
+    stats.deltaEntropy = codeBits(deltaCounts.data(), 256, stats.sampledBytes) / n;
+
+    double order1Bits = 0;
+    for (unsigned context = 0; context < 256; context++) {
+        if (counts[context] == 0 && context != 0) {
+            continue;
+        }
+        const uint32_t* row = &pairCounts[context * 256];
+        uint64_t total = 0;
+        unsigned used = 0;
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            total += row[symbol];
+            used += row[symbol] != 0;
+        }
+        order1Bits += used * ORDER1_PAIR_BITS + codeBits(row, 256, total);
+    }
+    stats.order1Entropy = std::min(order1Bits / n, 8.0);
+
+    stats.runFraction = static_cast<double>(runs) / n;
+    stats.repeatFraction = static_cast<double>(repeats) / n;
+    stats.textFraction = static_cast<double>(text) / n;
+    return true;
+}
+
+// Rules in order of how decisively the statistics identify the data. The
+// thresholds were set on text, JSON, executables, images, PCM audio, sparse
+// tables and random data, favouring the smallest output except where BWT
+// would cost several times the time of LZH for little gain.
+AlgorithmChoice AlgorithmSelector::choose(const ProbeStats& stats) {
+    AlgorithmChoice choice;
+    if (stats.sampledBytes == 0 || (stats.entropy > 7.9 && stats.repeatFraction < 0.05)) {
+        // Incompressible: the cheapest coder, whose blocks end up stored.
+        choice.algorithm = ALGORITHM_RANS;
+    } else if (stats.deltaEntropy + 1.0 < std::min(stats.entropy, stats.order1Entropy) &&
+               stats.repeatFraction < 0.2) {
+        // Smooth 32-bit samples or counters.
+        choice.algorithm = ALGORITHM_DELTA_RLE_HUFFMAN;
+    } else if (stats.runFraction > 0.5) {
+        choice.algorithm = ALGORITHM_RLE_HUFFMAN;
+    } else if (stats.textFraction > 0.95 && stats.repeatFraction > 0.3) {
+        // Text: BWT's contexts beat LZ matches by 10-30%.
+        choice.algorithm = ALGORITHM_BWT;
+    } else if (stats.repeatFraction > 0.02) {
+        choice.algorithm = ALGORITHM_LZH;
+        // Few matches: deeper searches find nothing more.
+        choice.lz77Level = stats.repeatFraction < 0.1 ? 1 : 0;
+    } else if (stats.order1Entropy + 0.5 < stats.entropy) {
+        choice.algorithm = ALGORITHM_HUFFMAN_O1;
+    } else {
+        choice.algorithm = ALGORITHM_RANS;
+    }
+    return choice;
+}
+
+bool AlgorithmSelector::select(const std::string& filename, AlgorithmChoice& choice) {
+    ProbeStats stats;
+    if (!probe(filename, stats)) {
+        return false;
+    }
+    choice = choose(stats);
+    return true;
+}
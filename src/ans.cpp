@@ -0,0 +1,475 @@
+#include "ans.h"
+#include "bit_buffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+struct DecodeEntry {
+    uint16_t nextStateBase;
+    uint8_t symbol;
+    uint8_t bits;
+};
+
+// Per-symbol encoder constants (FSE's symbolTT): the bits to emit from
+// state x are (x + deltaBits) >> 16, and the next state is found at
+// (x >> bits) + deltaFindState in the state table.
+struct SymbolTransform {
+    int32_t deltaFindState;
+    uint32_t deltaBits;
+};
+
+unsigned highBit(uint32_t value) {
+    unsigned bit = 0;
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+// Small inputs get small tables, whose counts are cheaper to send; the
+// table must still give every present symbol a state.
+unsigned chooseTableLog(size_t size, unsigned distinct, unsigned defaultLog) {
+    unsigned sourceLog = size > 1 ? highBit(static_cast<uint32_t>(std::min<size_t>(size - 1, UINT32_MAX))) : 0;
+    unsigned log = std::min(defaultLog, sourceLog >= ANSCompressor::MIN_TABLE_LOG + 2
+                                            ? sourceLog - 2 : ANSCompressor::MIN_TABLE_LOG);
+    unsigned needed = distinct > 1 ? highBit(distinct - 1) + 2 : 1;
+    return std::min(std::max({log, needed, ANSCompressor::MIN_TABLE_LOG}), ANSCompressor::MAX_TABLE_LOG);
+}
+
+// Spreads each symbol's states across the table with a fixed odd stride,
+// which interleaves symbols so every state range sees a mix of them.
+void spreadSymbols(const uint32_t* normalized, unsigned maxSymbol, unsigned tableLog, std::vector<uint8_t>& table) {
+    const uint32_t tableSize = 1u << tableLog;
+    const uint32_t step = (tableSize >> 1) + (tableSize >> 3) + 3;
+    table.resize(tableSize);
+    uint32_t position = 0;
+    for (unsigned s = 0; s <= maxSymbol; s++) {
+        for (uint32_t i = 0; i < normalized[s]; i++) {
+            table[position] = static_cast<uint8_t>(s);
+            position = (position + step) & (tableSize - 1);
+        }
+    }
+}
+
+}
+
+bool ANSCompressor::compress(const std::string& inputFile, const std::string& outputFile) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    output.write(MAGIC, sizeof(MAGIC));
+    output.put(static_cast<char>(FORMAT_VERSION));
+
+    std::vector<uint8_t> chunk(CHUNK_SIZE);
+    std::vector<uint8_t> encoded;
+    while (true) {
+        input.read(reinterpret_cast<char*>(chunk.data()), chunk.size());
+        size_t bytesRead = static_cast<size_t>(input.gcount());
+        if (bytesRead == 0) {
+            break;
+        }
+
+        encoded.clear();
+        encode(chunk.data(), bytesRead, encoded);
+        writeU32(output, static_cast<uint32_t>(bytesRead));
+        writeU32(output, static_cast<uint32_t>(encoded.size()));
+        output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    }
+
+    if (input.bad()) {
+        std::cerr << "Error: Failed reading input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    writeU32(output, 0);
+    writeU32(output, 0);
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Compression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Original size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Compressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool ANSCompressor::decompress(const std::string& inputFile, const std::string& outputFile) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    char header[sizeof(MAGIC)];
+    int version = 0;
+    if (input.read(header, sizeof(header))) {
+        version = input.get();
+    }
+    if (!input || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || version != FORMAT_VERSION) {
+        std::cerr << "Error: '" << inputFile << "' is not a valid ANS file.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> chunk;
+    while (true) {
+        uint32_t rawSize, encodedSize;
+        if (!readU32(input, rawSize) || !readU32(input, encodedSize)) {
+            std::cerr << "Error: Truncated ANS chunk header.\n";
+            return false;
+        }
+        if (rawSize == 0) {
+            break;
+        }
+        // Stored segments cost one byte more than their input.
+        if (rawSize > CHUNK_SIZE || encodedSize > rawSize + rawSize / SEGMENT_SIZE + 1) {
+            std::cerr << "Error: Corrupt ANS chunk header.\n";
+            return false;
+        }
+
+        payload.resize(encodedSize);
+        if (!input.read(reinterpret_cast<char*>(payload.data()), encodedSize)) {
+            std::cerr << "Error: Truncated ANS chunk.\n";
+            return false;
+        }
+
+        chunk.resize(rawSize);
+        if (!decode(payload.data(), payload.size(), chunk.data(), rawSize)) {
+            std::cerr << "Error: Corrupt ANS data.\n";
+            return false;
+        }
+        output.write(reinterpret_cast<const char*>(chunk.data()), rawSize);
+    }
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Decompression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Compressed size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Decompressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool ANSCompressor::isValidANSFile(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool ANSCompressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+    output.clear();
+    writeVarint(output, input.size());
+    encode(input.data(), input.size(), output);
+    return true;
+}
+
+bool ANSCompressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                    size_t maxSize) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    uint64_t rawSize;
+    // Every segment takes at least four bytes.
+    if (!readVarint(ip, end, rawSize) || rawSize > maxSize ||
+        rawSize > (static_cast<uint64_t>(input.size()) / 4 + 1) * SEGMENT_SIZE) {
+        return false;
+    }
+
+    output.resize(static_cast<size_t>(rawSize));
+    return decode(ip, static_cast<size_t>(end - ip), output.data(), output.size());
+}
+
+void ANSCompressor::encode(const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+    for (size_t offset = 0; offset < size; offset += SEGMENT_SIZE) {
+        size_t segment = std::min(SEGMENT_SIZE, size - offset);
+        if (!encodeSegment(data + offset, segment, output)) {
+            output.push_back(MODE_STORED);
+            output.insert(output.end(), data + offset, data + offset + segment);
+        }
+    }
+}
+
+bool ANSCompressor::decode(const uint8_t* input, size_t inputSize, uint8_t* output, size_t rawSize) {
+    const uint8_t* ip = input;
+    const uint8_t* end = input + inputSize;
+    for (size_t offset = 0; offset < rawSize; offset += SEGMENT_SIZE) {
+        if (!decodeSegment(ip, end, output + offset, std::min(SEGMENT_SIZE, rawSize - offset))) {
+            return false;
+        }
+    }
+    return ip == end;
+}
+
+// Rounding leftovers go to the largest symbol when it can absorb them
+// cheaply, and otherwise one state at a time to where they cost least.
+void ANSCompressor::normalizeCounts(const uint32_t* counts, unsigned maxSymbol, size_t total, unsigned tableLog,
+                                    uint32_t* normalized) {
+    const uint64_t tableSize = static_cast<uint64_t>(1) << tableLog;
+    int64_t sum = 0;
+    unsigned largest = 0;
+    for (unsigned s = 0; s <= maxSymbol; s++) {
+        normalized[s] = 0;
+        if (counts[s] == 0) {
+            continue;
+        }
+        uint64_t scaled = (static_cast<uint64_t>(counts[s]) * tableSize + total / 2) / total;
+        normalized[s] = static_cast<uint32_t>(std::max<uint64_t>(scaled, 1));
+        sum += normalized[s];
+        if (counts[s] > counts[largest]) {
+            largest = s;
+        }
+    }
+
+    int64_t difference = static_cast<int64_t>(tableSize) - sum;
+    if (std::abs(difference) * 8 <= static_cast<int64_t>(normalized[largest])) {
+        normalized[largest] = static_cast<uint32_t>(normalized[largest] + difference);
+        return;
+    }
+
+    while (difference != 0) {
+        unsigned best = 0;
+        double bestCost = 0;
+        bool found = false;
+        for (unsigned s = 0; s <= maxSymbol; s++) {
+            if (counts[s] == 0 || (difference < 0 && normalized[s] == 1)) {
+                continue;
+            }
+            // Bits gained by adding a state, or lost by removing one.
+            double weight = static_cast<double>(counts[s]);
+            double cost = difference > 0 ? -weight * std::log2((normalized[s] + 1.0) / normalized[s])
+                                         : weight * std::log2(normalized[s] / (normalized[s] - 1.0));
+            if (!found || cost < bestCost) {
+                best = s;
+                bestCost = cost;
+                found = true;
+            }
+        }
+        normalized[best] = difference > 0 ? normalized[best] + 1 : normalized[best] - 1;
+        difference += difference > 0 ? -1 : 1;
+    }
+}
+
+bool ANSCompressor::encodeSegment(const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+    uint32_t counts[256] = {0};
+    for (size_t i = 0; i < size; i++) {
+        counts[data[i]]++;
+    }
+    unsigned maxSymbol = 0;
+    unsigned distinct = 0;
+    for (unsigned s = 0; s < 256; s++) {
+        if (counts[s] > 0) {
+            maxSymbol = s;
+            distinct++;
+        }
+    }
+
+    const unsigned tableLog = chooseTableLog(size, distinct, DEFAULT_TABLE_LOG);
+    const uint32_t tableSize = 1u << tableLog;
+    uint32_t normalized[256];
+    normalizeCounts(counts, maxSymbol, size, tableLog, normalized);
+
+    std::vector<uint8_t> spread;
+    spreadSymbols(normalized, maxSymbol, tableLog, spread);
+
+    // State table: the states of each symbol in table order, grouped by
+    // symbol. Encoder states live in [tableSize, 2 * tableSize).
+    std::vector<uint16_t> stateTable(tableSize);
+    SymbolTransform transforms[256];
+    uint32_t cumulative[257];
+    cumulative[0] = 0;
+    for (unsigned s = 0; s <= maxSymbol; s++) {
+        cumulative[s + 1] = cumulative[s] + normalized[s];
+        if (normalized[s] > 0) {
+            uint32_t maxBits = normalized[s] == 1 ? tableLog : tableLog - highBit(normalized[s] - 1);
+            transforms[s].deltaBits = (maxBits << 16) - (normalized[s] << maxBits);
+            transforms[s].deltaFindState = static_cast<int32_t>(cumulative[s]) - static_cast<int32_t>(normalized[s]);
+        }
+    }
+    uint32_t next[257];
+    std::copy(cumulative, cumulative + maxSymbol + 1, next);
+    for (uint32_t position = 0; position < tableSize; position++) {
+        stateTable[next[spread[position]]++] = static_cast<uint16_t>(tableSize + position);
+    }
+
+    const size_t start = output.size();
+    output.push_back(MODE_TANS);
+    output.push_back(static_cast<uint8_t>(tableLog));
+    output.push_back(static_cast<uint8_t>(maxSymbol));
+    for (unsigned s = 0; s <= maxSymbol; s++) {
+        writeVarint(output, normalized[s]);
+    }
+
+    std::vector<uint8_t> stream;
+    stream.reserve(size / 2 + 16);
+    BitBufferWriter writer(stream);
+    uint32_t states[2] = {tableSize, tableSize};
+    for (size_t i = size; i-- > 0;) {
+        uint32_t& state = states[i & 1];
+        const SymbolTransform& transform = transforms[data[i]];
+        uint32_t bits = (state + transform.deltaBits) >> 16;
+        writer.write(state & ((1u << bits) - 1), bits);
+        state = stateTable[static_cast<int32_t>(state >> bits) + transform.deltaFindState];
+    }
+    writer.write(states[0] - tableSize, tableLog);
+    writer.write(states[1] - tableSize, tableLog);
+    writer.write(1, 1);
+    writer.flush();
+
+    writeVarint(output, stream.size());
+    if (output.size() - start + stream.size() >= size + 1) {
+        output.resize(start);
+        return false;
+    }
+    output.insert(output.end(), stream.begin(), stream.end());
+    return true;
+}
+
+bool ANSCompressor::decodeSegment(const uint8_t*& ip, const uint8_t* end, uint8_t* output, size_t size) {
+    if (ip == end) {
+        return false;
+    }
+    uint8_t mode = *ip++;
+    if (mode == MODE_STORED) {
+        if (static_cast<size_t>(end - ip) < size) {
+            return false;
+        }
+        std::memcpy(output, ip, size);
+        ip += size;
+        return true;
+    }
+    if (mode != MODE_TANS || end - ip < 2) {
+        return false;
+    }
+
+    const unsigned tableLog = *ip++;
+    const unsigned maxSymbol = *ip++;
+    if (tableLog < MIN_TABLE_LOG || tableLog > MAX_TABLE_LOG) {
+        return false;
+    }
+    const uint32_t tableSize = 1u << tableLog;
+    uint32_t normalized[256];
+    uint64_t sum = 0;
+    for (unsigned s = 0; s <= maxSymbol; s++) {
+        uint64_t count;
+        if (!readVarint(ip, end, count) || count > tableSize) {
+            return false;
+        }
+        normalized[s] = static_cast<uint32_t>(count);
+        sum += count;
+    }
+    uint64_t streamSize;
+    if (sum != tableSize || !readVarint(ip, end, streamSize) || streamSize > static_cast<uint64_t>(end - ip)) {
+        return false;
+    }
+
+    std::vector<uint8_t> spread;
+    spreadSymbols(normalized, maxSymbol, tableLog, spread);
+    std::vector<DecodeEntry> table(tableSize);
+    uint32_t next[256];
+    std::copy(normalized, normalized + maxSymbol + 1, next);
+    for (uint32_t position = 0; position < tableSize; position++) {
+        uint8_t symbol = spread[position];
+        uint32_t state = next[symbol]++;
+        uint8_t bits = static_cast<uint8_t>(tableLog - highBit(state));
+        table[position] = {static_cast<uint16_t>((state << bits) - tableSize), symbol, bits};
+    }
+
+    BitBufferReverseReader reader(ip, static_cast<size_t>(streamSize));
+    if (!reader.valid()) {
+        return false;
+    }
+    uint32_t state1 = reader.read(tableLog);
+    uint32_t state0 = reader.read(tableLog);
+
+    // Two states per step: their table lookups do not depend on each other.
+    size_t i = 0;
+    for (; i + 1 < size; i += 2) {
+        const DecodeEntry& entry0 = table[state0];
+        const DecodeEntry& entry1 = table[state1];
+        output[i] = entry0.symbol;
+        output[i + 1] = entry1.symbol;
+        state0 = entry0.nextStateBase + reader.read(entry0.bits);
+        state1 = entry1.nextStateBase + reader.read(entry1.bits);
+    }
+    if (i < size) {
+        const DecodeEntry& entry = table[state0];
+        output[i] = entry.symbol;
+        reader.read(entry.bits);
+    }
+
+    ip += streamSize;
+    return reader.finished();
+}
+
+void ANSCompressor::writeU32(std::ofstream& output, uint32_t value) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(value & 0xFF),
+        static_cast<unsigned char>((value >> 8) & 0xFF),
+        static_cast<unsigned char>((value >> 16) & 0xFF),
+        static_cast<unsigned char>((value >> 24) & 0xFF)
+    };
+    output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+bool ANSCompressor::readU32(std::ifstream& input, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!input.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    value = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+bool ANSCompressor::fileExists(const std::string& filename) {
+    return std::filesystem::exists(filename);
+}
+
+size_t ANSCompressor::getFileSize(const std::string& filename) {
+    try {
+        return std::filesystem::file_size(filename);
+    } catch (const std::filesystem::filesystem_error&) {
+        return 0;
+    }
+}
@@ -0,0 +1,123 @@
+#include "block_codec.h"
+#include "rle.h"
+#include "huffman.h"
+#include "lzw.h"
+#include "lz77.h"
+#include "lzh.h"
+#include "ans.h"
+#include "rans.h"
+#include "bwt.h"
+#include "cm.h"
+#include "transform_chain.h"
+#include "fused_pipeline.h"
+
+bool BlockCodec::isSupported(CompressionAlgorithm algorithm) {
+    switch (algorithm) {
+        case ALGORITHM_RLE:
+        case ALGORITHM_HUFFMAN:
+        case ALGORITHM_LZW:
+        case ALGORITHM_LZ77:
+        case ALGORITHM_LZH:
+        case ALGORITHM_ANS:
+        case ALGORITHM_RANS:
+        case ALGORITHM_BWT:
+        case ALGORITHM_CM:
+        case ALGORITHM_HUFFMAN_O1:
+        case ALGORITHM_HUFFMAN_ADAPTIVE:
+        case ALGORITHM_CHAIN:
+        case ALGORITHM_RLE_HUFFMAN:
+        case ALGORITHM_DELTA_RLE_HUFFMAN:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool BlockCodec::isBlockOnly(CompressionAlgorithm algorithm) {
+    return algorithm == ALGORITHM_CHAIN || algorithm == ALGORITHM_RLE_HUFFMAN ||
+           algorithm == ALGORITHM_DELTA_RLE_HUFFMAN || algorithm == ALGORITHM_AUTO;
+}
+
+bool BlockCodec::supportsHistory(CompressionAlgorithm algorithm) {
+    return algorithm == ALGORITHM_LZ77 || algorithm == ALGORITHM_LZH;
+}
+
+bool BlockCodec::encode(CompressionAlgorithm algorithm, const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                        const CodecParams& params, size_t historySize) {
+    if (historySize > 0 && !supportsHistory(algorithm)) {
+        return false;
+    }
+
+    switch (algorithm) {
+        case ALGORITHM_RLE:
+            return RLECompressor::compressBlock(input, output);
+        case ALGORITHM_HUFFMAN:
+            return HuffmanCompressor::compressBlock(input, output);
+        case ALGORITHM_LZW:
+            return LZWCompressor::compressBlock(input, output);
+        case ALGORITHM_LZ77:
+            return LZ77Compressor::compressBlock(input, output, params.lz77, historySize);
+        case ALGORITHM_LZH:
+            return LZHCompressor::compressBlock(input, output, params.lz77, historySize);
+        case ALGORITHM_ANS:
+            return ANSCompressor::compressBlock(input, output);
+        case ALGORITHM_RANS:
+            return RANSCompressor::compressBlock(input, output);
+        case ALGORITHM_BWT:
+            return BWTCompressor::compressBlock(input, output, params.entropy);
+        case ALGORITHM_CM:
+            return CMCompressor::compressBlock(input, output, params.cmMemoryMb);
+        case ALGORITHM_HUFFMAN_O1:
+            return HuffmanCompressor::compressOrder1Block(input, output);
+        case ALGORITHM_HUFFMAN_ADAPTIVE:
+            return HuffmanCompressor::compressAdaptiveBlock(input, output, params.huffmanRebuildInterval);
+        case ALGORITHM_CHAIN:
+            return TransformChain::encode(params.chain, input, output, params);
+        case ALGORITHM_RLE_HUFFMAN:
+            return RLEHuffmanPipeline::compressBlock(input, output);
+        case ALGORITHM_DELTA_RLE_HUFFMAN:
+            return DeltaRLEHuffmanPipeline::compressBlock(input, output);
+        default:
+            return false;
+    }
+}
+
+bool BlockCodec::decode(CompressionAlgorithm algorithm, const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                        size_t maxSize, const CodecParams& params, size_t historySize) {
+    if (historySize > 0 && !supportsHistory(algorithm)) {
+        return false;
+    }
+
+    switch (algorithm) {
+        case ALGORITHM_RLE:
+            return RLECompressor::decompressBlock(input, output, maxSize);
+        case ALGORITHM_HUFFMAN:
+            return HuffmanCompressor::decompressBlock(input, output, maxSize);
+        case ALGORITHM_LZW:
+            return LZWCompressor::decompressBlock(input, output, maxSize);
+        case ALGORITHM_LZ77:
+            return LZ77Compressor::decompressBlock(input, output, maxSize, historySize);
+        case ALGORITHM_LZH:
+            return LZHCompressor::decompressBlock(input, output, maxSize, historySize);
+        case ALGORITHM_ANS:
+            return ANSCompressor::decompressBlock(input, output, maxSize);
+        case ALGORITHM_RANS:
+            return RANSCompressor::decompressBlock(input, output, maxSize);
+        case ALGORITHM_BWT:
+            return BWTCompressor::decompressBlock(input, output, maxSize);
+        case ALGORITHM_CM:
+            return CMCompressor::decompressBlock(input, output, maxSize);
+        case ALGORITHM_HUFFMAN_O1:
+            return HuffmanCompressor::decompressOrder1Block(input, output, maxSize);
+        case ALGORITHM_HUFFMAN_ADAPTIVE:
+            return HuffmanCompressor::decompressAdaptiveBlock(input, output, maxSize);
+        case ALGORITHM_CHAIN:
+            return TransformChain::decode(params.chain, input, output, maxSize);
+        case ALGORITHM_RLE_HUFFMAN:
+            return RLEHuffmanPipeline::decompressBlock(input, output, maxSize);
+        case ALGORITHM_DELTA_RLE_HUFFMAN:
+            return DeltaRLEHuffmanPipeline::decompressBlock(input, output, maxSize);
+        default:
+            return false;
+    }
+}
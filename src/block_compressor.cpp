@@ -0,0 +1,575 @@
+#include "block_compressor.h"
+#include "block_codec.h"
+#include "block_pipeline.h"
+#include "checksum.h"
+#include "progress_reporter.h"
+#include "rate_limiter.h"
+#include "thread_pool.h"
+#include "transform_chain.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+bool BlockCompressor::compress(CompressionAlgorithm algorithm, const std::string& inputFile,
+                               const std::string& outputFile, const BlockOptions& options) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    if (!BlockCodec::isSupported(algorithm)) {
+        std::cerr << "Error: Algorithm does not support block mode.\n";
+        return false;
+    }
+
+    if (options.blockSize == 0 || options.blockSize > MAX_BLOCK_SIZE) {
+        std::cerr << "Error: Block size must be between 1 and " << MAX_BLOCK_SIZE << " bytes.\n";
+        return false;
+    }
+
+    const std::vector<uint8_t> chain = algorithm == ALGORITHM_CHAIN ? options.codec.chain : std::vector<uint8_t>();
+    if (algorithm == ALGORITHM_CHAIN && !TransformChain::isValid(chain)) {
+        std::cerr << "Error: Invalid transform chain.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    // Linked blocks carry the window before them as history; the header
+    // records that and the window size.
+    const bool linked = options.linkBlocks && BlockCodec::supportsHistory(algorithm);
+    const size_t historyLimit = linked ? LZ77Compressor::normalizedWindow(options.codec.lz77.windowSize) : 0;
+    uint16_t flags = 0;
+    if (linked) {
+        unsigned windowBits = 0;
+        while ((static_cast<size_t>(1) << windowBits) < historyLimit) {
+            windowBits++;
+        }
+        flags = static_cast<uint16_t>(LINKED_FLAG | (windowBits << 8));
+    }
+    if (options.autoSelected) {
+        flags |= AUTO_FLAG;
+    }
+
+    Checkpoint checkpoint{algorithm, static_cast<uint32_t>(options.blockSize), getFileSize(inputFile),
+                          modificationTime(inputFile), 0, 0, headerSize(chain), paramsHash(options.codec)};
+    bool resuming = false;
+    if (options.resume && !options.checkpointFile.empty()) {
+        // Flags and chain are not in the checkpoint; the output header must
+        // match what this run would write, or the appended blocks would be
+        // decoded with the wrong linking, window or stages.
+        Checkpoint saved;
+        CompressionAlgorithm writtenAlgorithm;
+        uint32_t writtenBlockSize;
+        uint16_t writtenFlags;
+        std::vector<uint8_t> writtenChain;
+        resuming = loadCheckpoint(options.checkpointFile, saved) &&
+                   saved.algorithm == checkpoint.algorithm && saved.blockSize == checkpoint.blockSize &&
+                   saved.inputSize == checkpoint.inputSize && saved.inputModified == checkpoint.inputModified &&
+                   saved.paramsHash == checkpoint.paramsHash && saved.inputOffset <= saved.inputSize && saved.outputOffset >= checkpoint.outputOffset &&
+                   fileExists(outputFile) && getFileSize(outputFile) >= saved.outputOffset &&
+                   readHeader(outputFile, writtenAlgorithm, writtenBlockSize, writtenFlags, writtenChain) &&
+                   writtenAlgorithm == algorithm && writtenBlockSize == options.blockSize &&
+                   writtenFlags == flags && writtenChain == chain;
+        if (resuming) {
+            checkpoint = saved;
+        } else {
+            std::cerr << "Warning: No usable checkpoint in '" << options.checkpointFile
+                      << "'; starting from the beginning.\n";
+        }
+    }
+
+    // A resumed job drops whatever was written after the checkpoint and
+    // appends from there.
+    std::ofstream output;
+    if (resuming) {
+        std::error_code ec;
+        std::filesystem::resize_file(outputFile, checkpoint.outputOffset, ec);
+        if (!ec) {
+            output.open(outputFile, std::ios::binary | std::ios::app);
+        }
+        input.seekg(static_cast<std::streamoff>(checkpoint.inputOffset));
+    } else {
+        output.open(outputFile, std::ios::binary);
+    }
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    // The reader keeps the tail of the input linked blocks need; a resumed
+    // job rereads it.
+    std::vector<uint8_t> history;
+    if (linked && checkpoint.inputOffset > 0) {
+        size_t historySize = static_cast<size_t>(std::min<uint64_t>(historyLimit, checkpoint.inputOffset));
+        history.resize(historySize);
+        input.seekg(static_cast<std::streamoff>(checkpoint.inputOffset - historySize));
+        if (!input.read(reinterpret_cast<char*>(history.data()), historySize)) {
+            std::cerr << "Error: Cannot read input file '" << inputFile << "'.\n";
+            return false;
+        }
+    }
+
+    if (!resuming) {
+        output.write(MAGIC, sizeof(MAGIC));
+        output.put(static_cast<char>(FORMAT_VERSION));
+        output.put(static_cast<char>(algorithm));
+        output.put(static_cast<char>(flags & 0xFF));
+        output.put(static_cast<char>(flags >> 8));
+        writeU32(output, static_cast<uint32_t>(options.blockSize));
+        if (!chain.empty()) {
+            output.put(static_cast<char>(chain.size()));
+            output.write(reinterpret_cast<const char*>(chain.data()), chain.size());
+        }
+    }
+
+    ProgressReporter progress(options.progressCallback, options.progressUserData,
+                              options.progressIntervalMs, checkpoint.inputSize, checkpoint.inputOffset);
+    const size_t checkpointInterval = std::max<size_t>(options.checkpointInterval, 1);
+
+    RateLimiter readLimit(options.maxReadBytesPerSecond);
+    RateLimiter writeLimit(options.maxWriteBytesPerSecond);
+    RateLimiter cpuLimit(options.maxCpuPercent / 100.0);
+
+    BlockPipeline pipeline(workerCount(options));
+    bool completed = pipeline.run(
+        [&](PipelineBlock& block) {
+            if (isCancelled(options) || !cpuLimit.acquire(0, options.cancelled)) {
+                return BlockPipeline::ReadStatus::Failed;
+            }
+            block.historySize = history.size();
+            block.input.assign(history.begin(), history.end());
+            block.input.resize(block.historySize + options.blockSize);
+            input.read(reinterpret_cast<char*>(block.input.data() + block.historySize), options.blockSize);
+            size_t bytesRead = static_cast<size_t>(input.gcount());
+            block.input.resize(block.historySize + bytesRead);
+            if (bytesRead == 0) {
+                return input.bad() ? BlockPipeline::ReadStatus::Failed : BlockPipeline::ReadStatus::EndOfInput;
+            }
+            if (!readLimit.acquire(static_cast<double>(bytesRead), options.cancelled)) {
+                return BlockPipeline::ReadStatus::Failed;
+            }
+            if (linked) {
+                history.assign(block.input.end() - std::min(historyLimit, block.input.size()), block.input.end());
+            }
+            return BlockPipeline::ReadStatus::Ready;
+        },
+        [&](PipelineBlock& block) {
+            if (isCancelled(options)) {
+                block.ok = false;
+                return;
+            }
+            auto start = std::chrono::steady_clock::now();
+            block.rawSize = static_cast<uint32_t>(block.input.size() - block.historySize);
+            block.crc = Checksum::crc32(block.input.data() + block.historySize, block.rawSize);
+            block.ok = BlockCodec::encode(algorithm, block.input, block.output, options.codec, block.historySize);
+            block.stored = block.output.size() >= block.rawSize;
+            cpuLimit.consume(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        },
+        [&](PipelineBlock& block) {
+            if (isCancelled(options)) {
+                return false;
+            }
+            if (!block.ok) {
+                std::cerr << "Error: Failed to encode block.\n";
+                return false;
+            }
+
+            const uint8_t* data = block.stored ? block.input.data() + block.historySize : block.output.data();
+            const size_t dataSize = block.stored ? block.rawSize : block.output.size();
+            if (!writeLimit.acquire(static_cast<double>(FRAME_HEADER_SIZE + dataSize), options.cancelled)) {
+                return false;
+            }
+            writeU32(output, block.rawSize);
+            writeU32(output, static_cast<uint32_t>(dataSize) | (block.stored ? STORED_FLAG : 0));
+            writeU32(output, block.crc);
+            output.write(reinterpret_cast<const char*>(data), dataSize);
+            progress.advance(block.rawSize);
+
+            checkpoint.blockIndex++;
+            checkpoint.inputOffset += block.rawSize;
+            checkpoint.outputOffset += FRAME_HEADER_SIZE + dataSize;
+            if (!options.checkpointFile.empty() && checkpoint.blockIndex % checkpointInterval == 0) {
+                // The checkpoint must never point past data the OS has.
+                output.flush();
+                if (output && !saveCheckpoint(options.checkpointFile, checkpoint)) {
+                    std::cerr << "Warning: Failed to write checkpoint '" << options.checkpointFile << "'.\n";
+                }
+            }
+            return static_cast<bool>(output);
+        });
+
+    if (!completed) {
+        if (isCancelled(options)) {
+            std::cerr << "Error: Operation cancelled.\n";
+        }
+        return false;
+    }
+
+    writeU32(output, 0);
+    writeU32(output, 0);
+    writeU32(output, 0);
+    progress.finish();
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    if (!options.checkpointFile.empty()) {
+        std::error_code ec;
+        std::filesystem::remove(options.checkpointFile, ec);
+    }
+
+    std::cout << "Compression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Original size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Compressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool BlockCompressor::decompress(const std::string& inputFile, const std::string& outputFile,
+                                 const BlockOptions& options) {
+    CompressionAlgorithm algorithm;
+    uint32_t blockSize;
+    uint16_t flags;
+    CodecParams params;
+    if (!readHeader(inputFile, algorithm, blockSize, flags, params.chain)) {
+        std::cerr << "Error: '" << inputFile << "' is not a block-framed file.\n";
+        return false;
+    }
+
+    if (!BlockCodec::isSupported(algorithm)) {
+        std::cerr << "Error: Unsupported algorithm in block header.\n";
+        return false;
+    }
+
+    // Linked blocks depend on the output before them, so the writer decodes
+    // them in order, carrying the window over in history.
+    const bool linked = (flags & LINKED_FLAG) != 0;
+    const size_t historyLimit = linked ? static_cast<size_t>(1) << (flags >> 8) : 0;
+    std::vector<uint8_t> history;
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+    input.seekg(static_cast<std::streamoff>(headerSize(params.chain)));
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    ProgressReporter progress(options.progressCallback, options.progressUserData,
+                              options.progressIntervalMs, getFileSize(inputFile));
+    progress.advance(headerSize(params.chain));
+
+    RateLimiter readLimit(options.maxReadBytesPerSecond);
+    RateLimiter writeLimit(options.maxWriteBytesPerSecond);
+    RateLimiter cpuLimit(options.maxCpuPercent / 100.0);
+
+    BlockPipeline pipeline(workerCount(options));
+    bool completed = pipeline.run(
+        [&](PipelineBlock& block) {
+            if (isCancelled(options) || !cpuLimit.acquire(0, options.cancelled)) {
+                return BlockPipeline::ReadStatus::Failed;
+            }
+            uint32_t rawSize, payloadSize, crc;
+            if (!readU32(input, rawSize) || !readU32(input, payloadSize) || !readU32(input, crc)) {
+                std::cerr << "Error: Truncated block header.\n";
+                return BlockPipeline::ReadStatus::Failed;
+            }
+            if (rawSize == 0) {
+                return BlockPipeline::ReadStatus::EndOfInput;
+            }
+
+            // Blocks that would not shrink are stored, so no payload is
+            // larger than its raw size; checking that before the resize
+            // keeps a corrupt frame from allocating more than a block.
+            block.stored = (payloadSize & STORED_FLAG) != 0;
+            payloadSize &= ~STORED_FLAG;
+            if (rawSize > blockSize || payloadSize > rawSize || (block.stored && payloadSize != rawSize)) {
+                std::cerr << "Error: Corrupt block header.\n";
+                return BlockPipeline::ReadStatus::Failed;
+            }
+
+            block.rawSize = rawSize;
+            block.crc = crc;
+            block.historySize = 0;
+            block.input.resize(payloadSize);
+            if (!input.read(reinterpret_cast<char*>(block.input.data()), payloadSize)) {
+                std::cerr << "Error: Truncated block payload.\n";
+                return BlockPipeline::ReadStatus::Failed;
+            }
+            if (!readLimit.acquire(static_cast<double>(FRAME_HEADER_SIZE + payloadSize), options.cancelled)) {
+                return BlockPipeline::ReadStatus::Failed;
+            }
+            return BlockPipeline::ReadStatus::Ready;
+        },
+        [&](PipelineBlock& block) {
+            if (isCancelled(options)) {
+                block.ok = false;
+                return;
+            }
+            if (!linked) {
+                auto start = std::chrono::steady_clock::now();
+                decodeBlock(algorithm, params, block);
+                cpuLimit.consume(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+        },
+        [&](PipelineBlock& block) {
+            if (isCancelled(options)) {
+                return false;
+            }
+            if (linked) {
+                auto start = std::chrono::steady_clock::now();
+                block.historySize = std::min(historyLimit, history.size());
+                block.output.assign(history.end() - block.historySize, history.end());
+                decodeBlock(algorithm, params, block);
+                cpuLimit.consume(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            if (!block.ok) {
+                std::cerr << "Error: Block failed checksum verification.\n";
+                return false;
+            }
+            if (!writeLimit.acquire(static_cast<double>(block.rawSize), options.cancelled)) {
+                return false;
+            }
+            output.write(reinterpret_cast<const char*>(block.output.data() + block.historySize), block.rawSize);
+            progress.advance(FRAME_HEADER_SIZE + block.input.size());
+            if (linked) {
+                // The decoded buffer becomes the history; the old one goes
+                // back to the slot for reuse.
+                history.swap(block.output);
+            }
+            return static_cast<bool>(output);
+        });
+
+    if (!completed) {
+        if (isCancelled(options)) {
+            std::cerr << "Error: Operation cancelled.\n";
+        }
+        return false;
+    }
+
+    progress.advance(FRAME_HEADER_SIZE);
+    progress.finish();
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Decompression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Compressed size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Decompressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+void BlockCompressor::decodeBlock(CompressionAlgorithm algorithm, const CodecParams& params, PipelineBlock& block) {
+    block.output.resize(block.historySize);
+    if (block.stored) {
+        block.output.insert(block.output.end(), block.input.begin(), block.input.end());
+    } else if (!BlockCodec::decode(algorithm, block.input, block.output, block.rawSize, params, block.historySize)) {
+        block.ok = false;
+        return;
+    }
+    block.ok = block.output.size() == block.historySize + block.rawSize &&
+               Checksum::crc32(block.output.data() + block.historySize, block.rawSize) == block.crc;
+}
+
+bool BlockCompressor::isBlockFile(const std::string& filename) {
+    CompressionAlgorithm algorithm;
+    uint32_t blockSize;
+    return readHeader(filename, algorithm, blockSize);
+}
+
+bool BlockCompressor::isAutoSelected(const std::string& filename) {
+    CompressionAlgorithm algorithm;
+    uint32_t blockSize;
+    uint16_t flags;
+    std::vector<uint8_t> chain;
+    return readHeader(filename, algorithm, blockSize, flags, chain) && (flags & AUTO_FLAG) != 0;
+}
+
+bool BlockCompressor::readHeader(const std::string& filename, CompressionAlgorithm& algorithm, uint32_t& blockSize) {
+    uint16_t flags;
+    std::vector<uint8_t> chain;
+    return readHeader(filename, algorithm, blockSize, flags, chain);
+}
+
+bool BlockCompressor::readHeader(const std::string& filename, CompressionAlgorithm& algorithm, uint32_t& blockSize,
+                                 uint16_t& flags, std::vector<uint8_t>& chain) {
+    std::ifstream input(filename, std::ios::binary);
+    if (!input.is_open()) {
+        return false;
+    }
+
+    char magic[sizeof(MAGIC)];
+    if (!input.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        return false;
+    }
+
+    int version = input.get();
+    int algorithmId = input.get();
+    int flagsLow = input.get();
+    int flagsHigh = input.get();
+    if (!input || version != FORMAT_VERSION || !readU32(input, blockSize)) {
+        return false;
+    }
+    if (blockSize == 0 || blockSize > MAX_BLOCK_SIZE) {
+        return false;
+    }
+
+    // Only LINKED_FLAG and AUTO_FLAG are defined; the high byte is the
+    // linked window, which must be one LZ77 allows.
+    flags = static_cast<uint16_t>(flagsLow | (flagsHigh << 8));
+    if ((flagsLow & ~(LINKED_FLAG | AUTO_FLAG)) != 0) {
+        return false;
+    }
+    if (flagsLow & LINKED_FLAG) {
+        size_t window = flagsHigh < 32 ? static_cast<size_t>(1) << flagsHigh : 0;
+        if (window < LZ77Compressor::MIN_WINDOW || window > LZ77Compressor::MAX_WINDOW ||
+            !BlockCodec::supportsHistory(static_cast<CompressionAlgorithm>(algorithmId))) {
+            return false;
+        }
+    } else if (flagsHigh != 0) {
+        return false;
+    }
+
+    chain.clear();
+    if (algorithmId == ALGORITHM_CHAIN) {
+        int stageCount = input.get();
+        if (!input || stageCount <= 0 || static_cast<size_t>(stageCount) > TransformChain::MAX_STAGES) {
+            return false;
+        }
+        chain.resize(static_cast<size_t>(stageCount));
+        if (!input.read(reinterpret_cast<char*>(chain.data()), stageCount) || !TransformChain::isValid(chain)) {
+            return false;
+        }
+    }
+
+    algorithm = static_cast<CompressionAlgorithm>(algorithmId);
+    return true;
+}
+
+size_t BlockCompressor::headerSize(const std::vector<uint8_t>& chain) {
+    return chain.empty() ? HEADER_SIZE : HEADER_SIZE + 1 + chain.size();
+}
+
+bool BlockCompressor::saveCheckpoint(const std::string& filename, const Checkpoint& checkpoint) {
+    // Written beside the target and renamed over it, so a crash leaves
+    // either the old or the new checkpoint, never a torn one.
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << "CMPB-CHECKPOINT 2 " << static_cast<int>(checkpoint.algorithm) << ' ' << checkpoint.blockSize << ' '
+             << checkpoint.inputSize << ' ' << checkpoint.inputModified << ' ' << checkpoint.blockIndex << ' '
+             << checkpoint.inputOffset << ' ' << checkpoint.outputOffset << ' ' << checkpoint.paramsHash << '\n';
+        if (!file.flush()) {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(temporary, filename, ec);
+    return !ec;
+}
+
+bool BlockCompressor::loadCheckpoint(const std::string& filename, Checkpoint& checkpoint) {
+    std::ifstream file(filename);
+    std::string magic;
+    int version = 0;
+    int algorithm = 0;
+    if (!(file >> magic >> version >> algorithm >> checkpoint.blockSize >> checkpoint.inputSize >>
+          checkpoint.inputModified >> checkpoint.blockIndex >> checkpoint.inputOffset >> checkpoint.outputOffset >>
+          checkpoint.paramsHash)) {
+        return false;
+    }
+    checkpoint.algorithm = static_cast<CompressionAlgorithm>(algorithm);
+    // Version 1 did not record the parameters, so its outputs cannot be
+    // safely continued.
+    return magic == "CMPB-CHECKPOINT" && version == 2;
+}
+
+uint32_t BlockCompressor::paramsHash(const CodecParams& params) {
+    const uint32_t values[] = {
+        params.lz77.windowSize,
+        params.lz77.chainDepth,
+        params.lz77.level,
+        static_cast<uint32_t>(params.lz77.matchFinder),
+        static_cast<uint32_t>(params.entropy),
+        params.cmMemoryMb,
+        params.huffmanRebuildInterval,
+    };
+    uint8_t bytes[sizeof(values)];
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        for (size_t b = 0; b < 4; b++) {
+            bytes[i * 4 + b] = static_cast<uint8_t>(values[i] >> (8 * b));
+        }
+    }
+    return Checksum::crc32(bytes, sizeof(bytes));
+}
+
+int64_t BlockCompressor::modificationTime(const std::string& filename) {
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(filename, ec);
+    return ec ? 0 : static_cast<int64_t>(modified.time_since_epoch().count());
+}
+
+size_t BlockCompressor::workerCount(const BlockOptions& options) {
+    size_t threads = options.threads > 0 ? options.threads : ThreadPool::instance().size();
+    return std::max<size_t>(threads, 1);
+}
+
+bool BlockCompressor::isCancelled(const BlockOptions& options) {
+    return options.cancelled && options.cancelled->load();
+}
+
+void BlockCompressor::writeU32(std::ostream& output, uint32_t value) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(value & 0xFF),
+        static_cast<unsigned char>((value >> 8) & 0xFF),
+        static_cast<unsigned char>((value >> 16) & 0xFF),
+        static_cast<unsigned char>((value >> 24) & 0xFF)
+    };
+    output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+bool BlockCompressor::readU32(std::istream& input, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!input.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    value = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+bool BlockCompressor::fileExists(const std::string& filename) {
+    return std::filesystem::exists(filename);
+}
+
+size_t BlockCompressor::getFileSize(const std::string& filename) {
+    try {
+        return std::filesystem::file_size(filename);
+    } catch (const std::filesystem::filesystem_error&) {
+        return 0;
+    }
+}
@@ -0,0 +1,146 @@
+#include "block_pipeline.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+BlockPipeline::BlockPipeline(size_t workers)
+    : slots_(std::max<size_t>(workers, 1) + 2), blocksRead_(0), inFlight_(0),
+      readerFinished_(false), failed_(false) {}
+
+bool BlockPipeline::run(const ReadStage& read, const TransformStage& transform, const WriteStage& write) {
+    freeSlots_.clear();
+    completed_.clear();
+    for (auto& slot : slots_) {
+        freeSlots_.push_back(&slot);
+    }
+    blocksRead_ = 0;
+    inFlight_ = 0;
+    readerFinished_ = false;
+    failed_ = false;
+
+    ThreadPool& pool = ThreadPool::instance();
+    std::thread reader(&BlockPipeline::readerLoop, this, std::cref(read), std::cref(transform));
+
+    size_t nextToWrite = 0;
+    while (true) {
+        PipelineBlock* block = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (failed_ || (readerFinished_ && nextToWrite == blocksRead_)) {
+                break;
+            }
+            auto it = completed_.find(nextToWrite);
+            if (it != completed_.end()) {
+                block = it->second;
+                completed_.erase(it);
+            }
+        }
+
+        if (block) {
+            bool written = false;
+            try {
+                written = write(*block);
+            } catch (...) {
+                written = false;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!written) {
+                failed_ = true;
+            }
+            freeSlots_.push_back(block);
+            nextToWrite++;
+            slotFreed_.notify_all();
+            continue;
+        }
+
+        if (pool.runPendingTask()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        blockDone_.wait_for(lock, std::chrono::milliseconds(1), [&] {
+            return failed_ || completed_.count(nextToWrite) > 0 ||
+                   (readerFinished_ && nextToWrite == blocksRead_);
+        });
+    }
+
+    reader.join();
+
+    // Transforms still running reference the slots and the stage callables,
+    // so they must drain before returning.
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (inFlight_ == 0) {
+                break;
+            }
+        }
+        if (!pool.runPendingTask()) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            blockDone_.wait_for(lock, std::chrono::milliseconds(1), [this] { return inFlight_ == 0; });
+        }
+    }
+
+    return !failed_;
+}
+
+size_t BlockPipeline::slotCount() const {
+    return slots_.size();
+}
+
+void BlockPipeline::readerLoop(const ReadStage& read, const TransformStage& transform) {
+    ThreadPool& pool = ThreadPool::instance();
+
+    while (true) {
+        PipelineBlock* slot = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            slotFreed_.wait(lock, [this] { return failed_ || !freeSlots_.empty(); });
+            if (failed_) {
+                readerFinished_ = true;
+                blockDone_.notify_all();
+                return;
+            }
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+
+        ReadStatus status;
+        try {
+            status = read(*slot);
+        } catch (...) {
+            status = ReadStatus::Failed;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (status != ReadStatus::Ready) {
+                if (status == ReadStatus::Failed) {
+                    failed_ = true;
+                }
+                freeSlots_.push_back(slot);
+                readerFinished_ = true;
+                blockDone_.notify_all();
+                return;
+            }
+
+            slot->sequence = blocksRead_++;
+            inFlight_++;
+        }
+
+        pool.submit([this, slot, &transform]() {
+            try {
+                transform(*slot);
+            } catch (...) {
+                slot->ok = false;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_[slot->sequence] = slot;
+            inFlight_--;
+            blockDone_.notify_all();
+        });
+    }
+}
@@ -0,0 +1,542 @@
+#include "bwt.h"
+#include "bit_buffer.h"
+#include "suffix_array.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+
+static_assert(BWTCompressor::BLOCK_SIZE < (1u << 24), "inverseTransform packs rows into 24 bits");
+
+namespace {
+
+// Rows are the n + 1 rotations of data followed by a sentinel that sorts
+// below every byte. Row 0 starts with the sentinel, so its last byte is
+// data[n - 1]; the primary row ends with it and is left out of the output.
+// starts[w] receives the row beginning at data[w * walkLength], so
+// starts[0] is the primary row. walkLength must be a power of two.
+void forwardTransform(const uint8_t* data, size_t size, size_t walkLength, uint8_t* output, uint32_t* starts) {
+    std::vector<int32_t> sa = SuffixArray::build(data, size);
+    size_t out = 0;
+    output[out++] = data[size - 1];
+    for (size_t i = 0; i < size; i++) {
+        size_t position = static_cast<size_t>(sa[i]);
+        if ((position & (walkLength - 1)) == 0) {
+            starts[position / walkLength] = static_cast<uint32_t>(i + 1);
+        }
+        if (position != 0) {
+            output[out++] = data[position - 1];
+        }
+    }
+}
+
+// Each entry holds the row that follows row j in text order (bits 8 and up)
+// and the first byte of row j, so a walk from the row of any position emits
+// the block from there on. Rows must fit in 24 bits.
+//
+// One walk misses the cache on every step and waits for it. Walks from the
+// starts of equal slices of the block are independent, so stepping them in
+// turn keeps that many misses in flight.
+bool inverseTransform(const uint8_t* transformed, size_t size, const uint32_t* starts, size_t walks,
+                      size_t walkLength, uint8_t* output) {
+    uint32_t primary = starts[0];
+    for (size_t w = 0; w < walks; w++) {
+        if (starts[w] == 0 || starts[w] > size) {
+            return false;
+        }
+    }
+
+    uint32_t next[256];
+    uint32_t counts[256] = {0};
+    for (size_t i = 0; i < size; i++) {
+        counts[transformed[i]]++;
+    }
+    uint32_t sum = 1;
+    for (unsigned c = 0; c < 256; c++) {
+        next[c] = sum;
+        sum += counts[c];
+    }
+
+    std::vector<uint32_t> entries(size + 1, 0);
+    for (size_t i = 0; i < size; i++) {
+        uint32_t row = static_cast<uint32_t>(i < primary ? i : i + 1);
+        uint8_t c = transformed[i];
+        entries[next[c]++] = (row << 8) | c;
+    }
+
+    uint32_t rows[BWTCompressor::MAX_WALKS];
+    std::copy(starts, starts + walks, rows);
+    size_t lastLength = size - (walks - 1) * walkLength;
+    for (size_t i = 0; i < walkLength; i++) {
+        size_t active = i < lastLength ? walks : walks - 1;
+        uint8_t* out = output + i;
+        for (size_t w = 0; w < active; w++) {
+            uint32_t entry = entries[rows[w]];
+            out[w * walkLength] = static_cast<uint8_t>(entry);
+            rows[w] = entry >> 8;
+        }
+    }
+
+    // Every walk ends where the next one starts, and the last closes the
+    // cycle through every row back at row 0.
+    for (size_t w = 0; w + 1 < walks; w++) {
+        if (rows[w] != starts[w + 1]) {
+            return false;
+        }
+    }
+    return rows[walks - 1] == 0;
+}
+
+// Slices of at least MIN_WALK_LENGTH bytes, at most MAX_WALKS of them. The
+// length is a power of two so the forward transform finds the slice starts
+// with a mask rather than a division per suffix.
+size_t walkLengthFor(size_t size) {
+    size_t walkLength = BWTCompressor::MIN_WALK_LENGTH;
+    while (walkLength * BWTCompressor::MAX_WALKS < size) {
+        walkLength <<= 1;
+    }
+    return walkLength;
+}
+
+// A run of rank 0 in bijective base 2, least significant digit first.
+void writeZeroRun(size_t run, std::vector<uint8_t>& symbols) {
+    while (run > 0) {
+        run--;
+        symbols.push_back(static_cast<uint8_t>(run & 1));
+        run >>= 1;
+    }
+}
+
+}
+
+bool BWTCompressor::compress(const std::string& inputFile, const std::string& outputFile, EntropyCoder coder,
+                             size_t threads) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    output.write(MAGIC, sizeof(MAGIC));
+    output.put(static_cast<char>(FORMAT_VERSION));
+    output.put(static_cast<char>(coder));
+
+    ThreadPool& pool = ThreadPool::instance();
+    size_t batch = threads > 0 ? threads : pool.size();
+    std::vector<std::vector<uint8_t>> blocks(batch);
+    std::vector<std::vector<uint8_t>> payloads(batch);
+    bool more = true;
+    while (more) {
+        size_t count = 0;
+        while (count < batch) {
+            std::vector<uint8_t>& block = blocks[count];
+            block.resize(BLOCK_SIZE);
+            input.read(reinterpret_cast<char*>(block.data()), BLOCK_SIZE);
+            block.resize(static_cast<size_t>(input.gcount()));
+            if (!block.empty()) {
+                count++;
+            }
+            if (block.size() < BLOCK_SIZE) {
+                more = false;
+                break;
+            }
+        }
+
+        TaskGroup group(pool);
+        for (size_t i = 0; i < count; i++) {
+            group.run([&, i]() {
+                payloads[i].clear();
+                encodePayload(blocks[i].data(), blocks[i].size(), coder, payloads[i]);
+            });
+        }
+        group.wait();
+
+        for (size_t i = 0; i < count; i++) {
+            writeU32(output, static_cast<uint32_t>(blocks[i].size()));
+            writeU32(output, static_cast<uint32_t>(payloads[i].size()));
+            output.write(reinterpret_cast<const char*>(payloads[i].data()), payloads[i].size());
+        }
+    }
+
+    if (input.bad()) {
+        std::cerr << "Error: Failed reading input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    writeU32(output, 0);
+    writeU32(output, 0);
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Compression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Original size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Compressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool BWTCompressor::decompress(const std::string& inputFile, const std::string& outputFile, size_t threads) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    char header[sizeof(MAGIC)];
+    int version = 0;
+    int coder = 0;
+    if (input.read(header, sizeof(header))) {
+        version = input.get();
+        coder = input.get();
+    }
+    if (!input || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || version != FORMAT_VERSION ||
+        !EntropyBackend::isValid(static_cast<uint8_t>(coder))) {
+        std::cerr << "Error: '" << inputFile << "' is not a valid BWT file.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    ThreadPool& pool = ThreadPool::instance();
+    size_t batch = threads > 0 ? threads : pool.size();
+    std::vector<std::vector<uint8_t>> payloads(batch);
+    std::vector<std::vector<uint8_t>> blocks(batch);
+    bool more = true;
+    while (more) {
+        size_t count = 0;
+        while (count < batch) {
+            uint32_t rawSize, payloadSize;
+            if (!readU32(input, rawSize) || !readU32(input, payloadSize)) {
+                std::cerr << "Error: Truncated BWT block header.\n";
+                return false;
+            }
+            if (rawSize == 0) {
+                more = false;
+                break;
+            }
+            // Symbols never outnumber twice the block and the coders barely
+            // expand them, so this only bounds the allocation.
+            if (rawSize > BLOCK_SIZE || payloadSize > 4 * BLOCK_SIZE) {
+                std::cerr << "Error: Corrupt BWT block header.\n";
+                return false;
+            }
+
+            payloads[count].resize(payloadSize);
+            if (!input.read(reinterpret_cast<char*>(payloads[count].data()), payloadSize)) {
+                std::cerr << "Error: Truncated BWT block.\n";
+                return false;
+            }
+            blocks[count].resize(rawSize);
+            count++;
+        }
+
+        std::atomic<bool> corrupt(false);
+        TaskGroup group(pool);
+        for (size_t i = 0; i < count; i++) {
+            group.run([&, i]() {
+                if (!decodePayload(payloads[i].data(), payloads[i].size(), static_cast<EntropyCoder>(coder),
+                                   blocks[i].data(), blocks[i].size())) {
+                    corrupt = true;
+                }
+            });
+        }
+        group.wait();
+
+        if (corrupt) {
+            std::cerr << "Error: Corrupt BWT data.\n";
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            output.write(reinterpret_cast<const char*>(blocks[i].data()), blocks[i].size());
+        }
+    }
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Decompression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Compressed size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Decompressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool BWTCompressor::isValidBWTFile(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool BWTCompressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                  EntropyCoder coder) {
+    output.clear();
+    writeVarint(output, input.size());
+    output.push_back(static_cast<uint8_t>(coder));
+
+    std::vector<uint8_t> payload;
+    for (size_t offset = 0; offset < input.size(); offset += BLOCK_SIZE) {
+        payload.clear();
+        encodePayload(input.data() + offset, std::min(BLOCK_SIZE, input.size() - offset), coder, payload);
+        writeVarint(output, payload.size());
+        output.insert(output.end(), payload.begin(), payload.end());
+    }
+    return true;
+}
+
+bool BWTCompressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    uint64_t rawSize;
+    if (!readVarint(ip, end, rawSize) || rawSize > maxSize || ip == end || !EntropyBackend::isValid(*ip)) {
+        return false;
+    }
+    EntropyCoder coder = static_cast<EntropyCoder>(*ip++);
+
+    // Grown one payload at a time, so a corrupt size cannot allocate more
+    // than a block ahead of the data that backs it.
+    output.clear();
+    while (output.size() < rawSize) {
+        uint64_t payloadSize;
+        if (!readVarint(ip, end, payloadSize) || payloadSize > static_cast<uint64_t>(end - ip)) {
+            return false;
+        }
+        size_t offset = output.size();
+        size_t size = static_cast<size_t>(std::min<uint64_t>(BLOCK_SIZE, rawSize - offset));
+        output.resize(offset + size);
+        if (!decodePayload(ip, static_cast<size_t>(payloadSize), coder, output.data() + offset, size)) {
+            return false;
+        }
+        ip += payloadSize;
+    }
+    return ip == end;
+}
+
+bool BWTCompressor::transformBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+    output.clear();
+    writeVarint(output, input.size());
+    for (size_t offset = 0; offset < input.size(); offset += BLOCK_SIZE) {
+        size_t size = std::min(BLOCK_SIZE, input.size() - offset);
+        size_t walkLength = walkLengthFor(size);
+        size_t walks = (size + walkLength - 1) / walkLength;
+        uint32_t starts[MAX_WALKS];
+        std::vector<uint8_t> transformed(size);
+        forwardTransform(input.data() + offset, size, walkLength, transformed.data(), starts);
+        for (size_t w = 0; w < walks; w++) {
+            writeVarint(output, starts[w]);
+        }
+        output.insert(output.end(), transformed.begin(), transformed.end());
+    }
+    return true;
+}
+
+bool BWTCompressor::inverseTransformBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    uint64_t rawSize;
+    if (!readVarint(ip, end, rawSize) || rawSize > static_cast<uint64_t>(end - ip)) {
+        return false;
+    }
+
+    output.resize(static_cast<size_t>(rawSize));
+    for (size_t offset = 0; offset < output.size(); offset += BLOCK_SIZE) {
+        size_t size = std::min(BLOCK_SIZE, output.size() - offset);
+        size_t walkLength = walkLengthFor(size);
+        size_t walks = (size + walkLength - 1) / walkLength;
+        uint32_t starts[MAX_WALKS];
+        for (size_t w = 0; w < walks; w++) {
+            uint64_t row;
+            if (!readVarint(ip, end, row) || row > size) {
+                return false;
+            }
+            starts[w] = static_cast<uint32_t>(row);
+        }
+        if (size > static_cast<size_t>(end - ip) ||
+            !inverseTransform(ip, size, starts, walks, walkLength, output.data() + offset)) {
+            return false;
+        }
+        ip += size;
+    }
+    return ip == end;
+}
+
+void BWTCompressor::encodePayload(const uint8_t* data, size_t size, EntropyCoder coder,
+                                  std::vector<uint8_t>& output) {
+    std::vector<uint8_t> transformed(size);
+    size_t walkLength = walkLengthFor(size);
+    size_t walks = (size + walkLength - 1) / walkLength;
+    uint32_t starts[MAX_WALKS];
+    forwardTransform(data, size, walkLength, transformed.data(), starts);
+
+    // Move-to-front, with runs of rank 0 collected for writeZeroRun.
+    uint8_t order[256];
+    std::iota(order, order + 256, 0);
+    std::vector<uint8_t> symbols;
+    symbols.reserve(size);
+    size_t run = 0;
+    for (uint8_t c : transformed) {
+        if (order[0] == c) {
+            run++;
+            continue;
+        }
+        writeZeroRun(run, symbols);
+        run = 0;
+
+        unsigned rank = 1;
+        while (order[rank] != c) {
+            rank++;
+        }
+        std::memmove(order + 1, order, rank);
+        order[0] = c;
+
+        if (rank < ESCAPE - 1) {
+            symbols.push_back(static_cast<uint8_t>(rank + 1));
+        } else {
+            symbols.push_back(ESCAPE);
+            symbols.push_back(static_cast<uint8_t>(rank - (ESCAPE - 1)));
+        }
+    }
+    writeZeroRun(run, symbols);
+
+    output.push_back(static_cast<uint8_t>(walks));
+    for (size_t w = 0; w < walks; w++) {
+        writeVarint(output, starts[w]);
+    }
+    writeVarint(output, symbols.size());
+    EntropyBackend::encode(coder, symbols.data(), symbols.size(), output);
+}
+
+bool BWTCompressor::decodePayload(const uint8_t* input, size_t inputSize, EntropyCoder coder, uint8_t* output,
+                                  size_t size) {
+    const uint8_t* ip = input;
+    const uint8_t* end = input + inputSize;
+    // The walk count must match the slicing the encoder derives from size.
+    size_t walkLength = walkLengthFor(size);
+    size_t walks = (size + walkLength - 1) / walkLength;
+    if (ip == end || *ip++ != walks) {
+        return false;
+    }
+    uint32_t starts[MAX_WALKS];
+    for (size_t w = 0; w < walks; w++) {
+        uint64_t row;
+        if (!readVarint(ip, end, row) || row > size) {
+            return false;
+        }
+        starts[w] = static_cast<uint32_t>(row);
+    }
+    uint64_t symbolCount;
+    if (!readVarint(ip, end, symbolCount) || symbolCount > 2 * static_cast<uint64_t>(size)) {
+        return false;
+    }
+
+    std::vector<uint8_t> symbols(static_cast<size_t>(symbolCount));
+    if (!EntropyBackend::decode(coder, ip, static_cast<size_t>(end - ip), symbols.data(), symbols.size())) {
+        return false;
+    }
+
+    std::vector<uint8_t> transformed(size);
+    uint8_t order[256];
+    std::iota(order, order + 256, 0);
+    size_t out = 0;
+    size_t run = 0;
+    size_t weight = 1;
+    for (size_t i = 0; i < symbols.size(); i++) {
+        uint8_t symbol = symbols[i];
+        if (symbol <= RUNB) {
+            run += (symbol + 1) * weight;
+            weight <<= 1;
+            if (run > size - out) {
+                return false;
+            }
+            continue;
+        }
+        std::memset(transformed.data() + out, order[0], run);
+        out += run;
+        run = 0;
+        weight = 1;
+
+        unsigned rank = symbol - 1u;
+        if (symbol == ESCAPE) {
+            if (++i == symbols.size() || symbols[i] > 1) {
+                return false;
+            }
+            rank = ESCAPE - 1u + symbols[i];
+        }
+        if (out == size) {
+            return false;
+        }
+        uint8_t c = order[rank];
+        std::memmove(order + 1, order, rank);
+        order[0] = c;
+        transformed[out++] = c;
+    }
+    std::memset(transformed.data() + out, order[0], run);
+    out += run;
+
+    return out == size && inverseTransform(transformed.data(), size, starts, walks, walkLength, output);
+}
+
+void BWTCompressor::writeU32(std::ofstream& output, uint32_t value) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(value & 0xFF),
+        static_cast<unsigned char>((value >> 8) & 0xFF),
+        static_cast<unsigned char>((value >> 16) & 0xFF),
+        static_cast<unsigned char>((value >> 24) & 0xFF)
+    };
+    output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+bool BWTCompressor::readU32(std::ifstream& input, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!input.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    value = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+bool BWTCompressor::fileExists(const std::string& filename) {
+    return std::filesystem::exists(filename);
+}
+
+size_t BWTCompressor::getFileSize(const std::string& filename) {
+    try {
+        return std::filesystem::file_size(filename);
+    } catch (const std::filesystem::filesystem_error&) {
+        return 0;
+    }
+}
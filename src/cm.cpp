@@ -0,0 +1,666 @@
+#include "cm.h"
+#include "bit_buffer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// Logistic functions on 12-bit probabilities, in integers so encoder and
+// decoder agree on every platform. squash maps the stretched domain
+// (-2047..2047, 1/256 units) to 0..4095 and stretch is its inverse.
+int squash(int d) {
+    static const int table[33] = {1,    2,    3,    6,    10,   16,   27,   45,   73,   120,  194,
+                                  310,  488,  747,  1101, 1546, 2047, 2549, 2994, 3348, 3607, 3785,
+                                  3901, 3975, 4022, 4050, 4068, 4079, 4085, 4089, 4092, 4093, 4094};
+    if (d > 2047) {
+        return 4095;
+    }
+    if (d < -2047) {
+        return 1;
+    }
+    int w = d & 127;
+    d = (d >> 7) + 16;
+    return (table[d] * (128 - w) + table[d + 1] * w + 64) >> 7;
+}
+
+class StretchTable {
+public:
+    StretchTable() {
+        int pi = 0;
+        for (int x = -2047; x <= 2047; x++) {
+            int v = squash(x);
+            for (int i = pi; i <= v; i++) {
+                table_[i] = static_cast<int16_t>(x);
+            }
+            pi = v + 1;
+        }
+        for (int i = pi; i < 4096; i++) {
+            table_[i] = 2047;
+        }
+    }
+
+    int operator()(int p) const {
+        return table_[p];
+    }
+
+private:
+    int16_t table_[4096];
+};
+
+const StretchTable stretch;
+
+// Adaptive probability: the top 22 bits hold P(1), the low 10 a hit count
+// that sets the adaptation rate (1 / (count + 1.5)) until it reaches LIMIT.
+class Counter {
+public:
+    static constexpr uint32_t INITIAL = 1u << 31;
+
+    static int p(uint32_t counter) {
+        return static_cast<int>(counter >> 20);
+    }
+
+    static void update(uint32_t& counter, int bit) {
+        static const Rates rates;
+        uint32_t count = counter & 1023;
+        int32_t p = static_cast<int32_t>(counter >> 10);
+        int32_t target = bit ? (1 << 22) - 1 : 0;
+        p += static_cast<int32_t>((static_cast<int64_t>(target - p) * rates.rate[count]) >> 16);
+        counter = (static_cast<uint32_t>(p) << 10) | (count < LIMIT ? count + 1 : count);
+    }
+
+private:
+    // Low, so counters keep tracking contexts whose statistics drift.
+    static constexpr uint32_t LIMIT = 7;
+
+    struct Rates {
+        Rates() {
+            for (uint32_t i = 0; i <= LIMIT; i++) {
+                rate[i] = static_cast<int32_t>(65536 * 2 / (2 * i + 3));
+            }
+        }
+        int32_t rate[LIMIT + 1];
+    };
+};
+
+// Secondary estimation: refines a probability in a context by interpolating
+// between 24 adaptive points along the stretched axis.
+class Apm {
+public:
+    explicit Apm(size_t contexts) : table_(contexts * 24), index_(0) {
+        for (size_t i = 0; i < table_.size(); i++) {
+            table_[i] = static_cast<uint16_t>(squash(static_cast<int>((i % 24 * 2 + 1) * 4096 / 48) - 2048) * 16);
+        }
+    }
+
+    int refine(int p, size_t context) {
+        int scaled = (stretch(p) + 2048) * 23;
+        int weight = scaled & 0xFFF;
+        size_t base = context * 24 + (scaled >> 12);
+        index_ = base + (weight >> 11);
+        return (table_[base] * (4096 - weight) + table_[base + 1] * weight) >> 16;
+    }
+
+    void update(int bit) {
+        int target = (bit << 16) + (bit << RATE) - bit - bit;
+        table_[index_] = static_cast<uint16_t>(table_[index_] + ((target - table_[index_]) >> RATE));
+    }
+
+private:
+    static constexpr int RATE = 7;
+
+    std::vector<uint16_t> table_;
+    size_t index_;
+};
+
+// Predicts long repeats: the last occurrence of the previous MIN_LENGTH
+// bytes points into the history, and while the bytes keep agreeing the byte
+// that followed it is the guess. Confidence is learned per match length.
+class MatchModel {
+public:
+    explicit MatchModel(unsigned bits)
+        : history_(static_cast<size_t>(1) << bits),
+          positions_(static_cast<size_t>(1) << (bits - 2)),
+          historyMask_((static_cast<size_t>(1) << bits) - 1),
+          hashShift_(64 - (bits - 2)),
+          pos_(0),
+          match_(0),
+          length_(0),
+          expected_(0) {
+        std::fill(counters_, counters_ + 2 * LENGTH_BUCKETS, Counter::INITIAL);
+    }
+
+    // Stretched prediction for the next bit given the partial byte c0
+    // (behind a leading 1) and the bits coded so far; 0 without a match.
+    int predict(int c0, int bitCount) {
+        if (length_ > 0 && ((expected_ | 256) >> (8 - bitCount)) != static_cast<uint32_t>(c0)) {
+            length_ = 0;
+        }
+        if (length_ == 0) {
+            counter_ = nullptr;
+            return 0;
+        }
+        int bit = (expected_ >> (7 - bitCount)) & 1;
+        counter_ = &counters_[bucket() * 2 + bit];
+        return stretch(Counter::p(*counter_));
+    }
+
+    void update(int bit) {
+        if (counter_) {
+            Counter::update(*counter_, bit);
+        }
+    }
+
+    // history holds the last eight bytes, the newest in the low byte.
+    void byteDone(uint8_t byte, uint64_t history) {
+        history_[pos_ & historyMask_] = byte;
+        pos_++;
+        if (length_ > 0) {
+            match_++;
+            length_ = std::min(length_ + 1, MAX_LENGTH);
+        }
+
+        size_t slot = static_cast<size_t>(((history & 0xFFFFFFFFFFFFull) * 0x9E3779B97F4A7C15ull) >> hashShift_);
+        if (length_ == 0 && pos_ >= MIN_LENGTH) {
+            match_ = positions_[slot];
+            if (match_ > 0) {
+                // Only the hash agrees so far; count how far back the bytes do.
+                while (length_ < MAX_VERIFY && length_ < match_ &&
+                       history_[(match_ - length_ - 1) & historyMask_] ==
+                           history_[(pos_ - length_ - 1) & historyMask_]) {
+                    length_++;
+                }
+                if (length_ < MIN_LENGTH) {
+                    length_ = 0;
+                }
+            }
+        }
+        positions_[slot] = static_cast<uint32_t>(pos_);
+        expected_ = length_ > 0 ? history_[match_ & historyMask_] : 0;
+    }
+
+    bool active() const {
+        return length_ > 0;
+    }
+
+private:
+    static constexpr uint32_t MIN_LENGTH = 6;
+    static constexpr uint32_t MAX_VERIFY = 32;
+    static constexpr uint32_t MAX_LENGTH = 65535;
+    static constexpr int LENGTH_BUCKETS = 32;
+
+    int bucket() const {
+        return length_ < 16 ? static_cast<int>(length_) : static_cast<int>(16 + std::min<uint32_t>((length_ - 16) >> 3, 15));
+    }
+
+    std::vector<uint8_t> history_;
+    std::vector<uint32_t> positions_;
+    size_t historyMask_;
+    unsigned hashShift_;
+    uint32_t pos_;
+    uint32_t match_;
+    uint32_t length_;
+    uint32_t expected_;
+    uint32_t counters_[2 * LENGTH_BUCKETS];
+    uint32_t* counter_ = nullptr;
+};
+
+// Predicts one bit at a time; update() must follow every p() with the bit.
+class Predictor {
+public:
+    explicit Predictor(unsigned tableBits)
+        : tables_(static_cast<size_t>(ORDERS) << tableBits, Counter::INITIAL),
+          bucketBits_(tableBits - 4),
+          match_(tableBits + 1),
+          weights_(512 * INPUTS, INITIAL_WEIGHT),
+          apm_(1 << 16),
+          c0_(1),
+          c8_(0),
+          nibble_(1),
+          bitCount_(0) {
+        std::fill(order0_, order0_ + 256, Counter::INITIAL);
+        std::fill(hashes_, hashes_ + ORDERS, 0);
+        selectBuckets();
+        predict();
+    }
+
+    int p() const {
+        return p_;
+    }
+
+    void update(int bit) {
+        Counter::update(order0_[c0_], bit);
+        for (int i = 0; i < ORDERS; i++) {
+            Counter::update(buckets_[i][nibble_], bit);
+        }
+        match_.update(bit);
+
+        int error = ((bit << 12) - mixed_) * LEARNING_RATE;
+        int32_t* weights = &weights_[mixerContext_ * INPUTS];
+        for (int i = 0; i < INPUTS; i++) {
+            weights[i] += (inputs_[i] * error + (1 << 11)) >> 12;
+        }
+        apm_.update(bit);
+
+        c0_ = (c0_ << 1) | bit;
+        nibble_ = (nibble_ << 1) | bit;
+        if (++bitCount_ == 8) {
+            c8_ = (c8_ << 8) | static_cast<uint64_t>(c0_ & 0xFF);
+            match_.byteDone(static_cast<uint8_t>(c0_), c8_);
+            c0_ = 1;
+            bitCount_ = 0;
+            for (int i = 0; i < ORDERS; i++) {
+                uint64_t context = c8_ & ((static_cast<uint64_t>(1) << (8 * CONTEXT_BYTES[i])) - 1);
+                hashes_[i] = static_cast<uint32_t>(((context + static_cast<uint64_t>(i + 1)) * 0x9E3779B97F4A7C15ull) >> 32);
+            }
+        }
+        if (bitCount_ == 0 || bitCount_ == 4) {
+            nibble_ = 1;
+            selectBuckets();
+        }
+        predict();
+    }
+
+private:
+    // Context lengths of the hashed models, in bytes.
+    static constexpr int ORDERS = 5;
+    static constexpr int CONTEXT_BYTES[ORDERS] = {1, 2, 3, 4, 6};
+    // Order 0, the hashed orders, the match model and a constant bias.
+    static constexpr int INPUTS = ORDERS + 3;
+    static constexpr int32_t INITIAL_WEIGHT = 1 << 14;
+    // Mixer step, in 1/4096 of the error.
+    static constexpr int LEARNING_RATE = 2;
+
+    // A 16-counter bucket per context and nibble; slot 0 is unused and the
+    // rest are indexed by the nibble bits seen so far behind a leading 1.
+    void selectBuckets() {
+        for (int i = 0; i < ORDERS; i++) {
+            uint32_t hash = (hashes_[i] ^ (static_cast<uint32_t>(c0_) * 0x2F0B3C55u)) * 0x85EBCA6Bu;
+            size_t bucket = (static_cast<size_t>(i) << bucketBits_) + ((hash ^ (hash >> 15)) >> (32 - bucketBits_));
+            buckets_[i] = &tables_[bucket * 16];
+        }
+    }
+
+    void predict() {
+        inputs_[0] = stretch(Counter::p(order0_[c0_]));
+        for (int i = 0; i < ORDERS; i++) {
+            inputs_[i + 1] = stretch(Counter::p(buckets_[i][nibble_]));
+        }
+        inputs_[ORDERS + 1] = match_.predict(c0_, bitCount_);
+        inputs_[INPUTS - 1] = 256;
+
+        // A separate weight set while a match is running: the models that
+        // deserve trust differ.
+        mixerContext_ = static_cast<size_t>(c0_) | (match_.active() ? 256 : 0);
+        const int32_t* weights = &weights_[mixerContext_ * INPUTS];
+        int64_t dot = 0;
+        for (int i = 0; i < INPUTS; i++) {
+            dot += static_cast<int64_t>(inputs_[i]) * weights[i];
+        }
+        int stretched = static_cast<int>(std::max<int64_t>(-2047, std::min<int64_t>(2047, dot >> 16)));
+        mixed_ = squash(stretched);
+
+        int refined = apm_.refine(mixed_, static_cast<size_t>(c0_) | static_cast<size_t>((c8_ & 0xFF) << 8));
+        p_ = std::max(1, std::min(4095, (mixed_ + 3 * refined + 2) >> 2));
+    }
+
+    std::vector<uint32_t> tables_;
+    unsigned bucketBits_;
+    uint32_t order0_[256];
+    MatchModel match_;
+    std::vector<int32_t> weights_;
+    Apm apm_;
+    uint32_t* buckets_[ORDERS];
+    uint32_t hashes_[ORDERS];
+    int inputs_[INPUTS];
+    size_t mixerContext_;
+    int c0_;
+    uint64_t c8_;
+    int nibble_;
+    int bitCount_;
+    int mixed_;
+    int p_;
+};
+
+// Carry-less binary arithmetic coder over a 32-bit range; p is P(1) in
+// 12 bits.
+class ArithmeticEncoder {
+public:
+    explicit ArithmeticEncoder(std::vector<uint8_t>& output) : output_(output), low_(0), high_(0xFFFFFFFFu) {}
+
+    void encode(int bit, int p) {
+        uint32_t mid = low_ + static_cast<uint32_t>((static_cast<uint64_t>(high_ - low_) * p) >> 12);
+        if (bit) {
+            high_ = mid;
+        } else {
+            low_ = mid + 1;
+        }
+        while ((low_ ^ high_) < (1u << 24)) {
+            output_.push_back(static_cast<uint8_t>(high_ >> 24));
+            low_ <<= 8;
+            high_ = (high_ << 8) | 0xFF;
+        }
+    }
+
+    void flush() {
+        for (int i = 0; i < 4; i++) {
+            output_.push_back(static_cast<uint8_t>(low_ >> 24));
+            low_ <<= 8;
+        }
+    }
+
+private:
+    std::vector<uint8_t>& output_;
+    uint32_t low_;
+    uint32_t high_;
+};
+
+// Reads zeros past the end, so a truncated stream decodes to garbage rather
+// than out of bounds; callers check that the stream was consumed exactly.
+class ArithmeticDecoder {
+public:
+    ArithmeticDecoder(const uint8_t* input, const uint8_t* end)
+        : ip_(input), end_(end), low_(0), high_(0xFFFFFFFFu), x_(0) {
+        for (int i = 0; i < 4; i++) {
+            x_ = (x_ << 8) | next();
+        }
+    }
+
+    int decode(int p) {
+        uint32_t mid = low_ + static_cast<uint32_t>((static_cast<uint64_t>(high_ - low_) * p) >> 12);
+        int bit = x_ <= mid;
+        if (bit) {
+            high_ = mid;
+        } else {
+            low_ = mid + 1;
+        }
+        while ((low_ ^ high_) < (1u << 24)) {
+            low_ <<= 8;
+            high_ = (high_ << 8) | 0xFF;
+            x_ = (x_ << 8) | next();
+        }
+        return bit;
+    }
+
+    bool exhausted() const {
+        return ip_ == end_;
+    }
+
+private:
+    uint32_t next() {
+        return ip_ < end_ ? *ip_++ : 0;
+    }
+
+    const uint8_t* ip_;
+    const uint8_t* end_;
+    uint32_t low_;
+    uint32_t high_;
+    uint32_t x_;
+};
+
+void encodeBytes(Predictor& predictor, const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+    ArithmeticEncoder encoder(output);
+    for (size_t i = 0; i < size; i++) {
+        for (int b = 7; b >= 0; b--) {
+            int bit = (data[i] >> b) & 1;
+            encoder.encode(bit, predictor.p());
+            predictor.update(bit);
+        }
+    }
+    encoder.flush();
+}
+
+bool decodeBytes(Predictor& predictor, const uint8_t* input, size_t inputSize, uint8_t* output, size_t size) {
+    ArithmeticDecoder decoder(input, input + inputSize);
+    for (size_t i = 0; i < size; i++) {
+        int c = 0;
+        for (int b = 0; b < 8; b++) {
+            int bit = decoder.decode(predictor.p());
+            predictor.update(bit);
+            c = (c << 1) | bit;
+        }
+        output[i] = static_cast<uint8_t>(c);
+    }
+    return decoder.exhausted();
+}
+
+}
+
+bool CMCompressor::compress(const std::string& inputFile, const std::string& outputFile, uint32_t memoryMb) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    unsigned tableBits = tableBitsFor(memoryMb, getFileSize(inputFile));
+    output.write(MAGIC, sizeof(MAGIC));
+    output.put(static_cast<char>(FORMAT_VERSION));
+    output.put(static_cast<char>(tableBits));
+
+    Predictor predictor(tableBits);
+    std::vector<uint8_t> chunk(CHUNK_SIZE);
+    std::vector<uint8_t> encoded;
+    while (true) {
+        input.read(reinterpret_cast<char*>(chunk.data()), chunk.size());
+        size_t bytesRead = static_cast<size_t>(input.gcount());
+        if (bytesRead == 0) {
+            break;
+        }
+
+        encoded.clear();
+        encodeBytes(predictor, chunk.data(), bytesRead, encoded);
+        writeU32(output, static_cast<uint32_t>(bytesRead));
+        writeU32(output, static_cast<uint32_t>(encoded.size()));
+        output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    }
+
+    if (input.bad()) {
+        std::cerr << "Error: Failed reading input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    writeU32(output, 0);
+    writeU32(output, 0);
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Compression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Original size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Compressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool CMCompressor::decompress(const std::string& inputFile, const std::string& outputFile) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    char header[sizeof(MAGIC)];
+    int version = 0;
+    int tableBits = 0;
+    if (input.read(header, sizeof(header))) {
+        version = input.get();
+        tableBits = input.get();
+    }
+    if (!input || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || version != FORMAT_VERSION ||
+        tableBits < static_cast<int>(MIN_TABLE_BITS) || tableBits > static_cast<int>(MAX_TABLE_BITS)) {
+        std::cerr << "Error: '" << inputFile << "' is not a valid context-mixing file.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    Predictor predictor(static_cast<unsigned>(tableBits));
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> chunk;
+    while (true) {
+        uint32_t rawSize, encodedSize;
+        if (!readU32(input, rawSize) || !readU32(input, encodedSize)) {
+            std::cerr << "Error: Truncated context-mixing chunk header.\n";
+            return false;
+        }
+        if (rawSize == 0) {
+            break;
+        }
+        // No bit costs more than 12 bits, plus the four-byte flush.
+        if (rawSize > CHUNK_SIZE || encodedSize > 12 * static_cast<uint64_t>(rawSize) + 8) {
+            std::cerr << "Error: Corrupt context-mixing chunk header.\n";
+            return false;
+        }
+
+        payload.resize(encodedSize);
+        if (!input.read(reinterpret_cast<char*>(payload.data()), encodedSize)) {
+            std::cerr << "Error: Truncated context-mixing chunk.\n";
+            return false;
+        }
+
+        chunk.resize(rawSize);
+        if (!decodeBytes(predictor, payload.data(), payload.size(), chunk.data(), rawSize)) {
+            std::cerr << "Error: Corrupt context-mixing data.\n";
+            return false;
+        }
+        output.write(reinterpret_cast<const char*>(chunk.data()), rawSize);
+    }
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Decompression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Compressed size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Decompressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool CMCompressor::isValidCMFile(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool CMCompressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                 uint32_t memoryMb) {
+    unsigned tableBits = tableBitsFor(memoryMb, input.size());
+    output.clear();
+    writeVarint(output, input.size());
+    output.push_back(static_cast<uint8_t>(tableBits));
+    if (input.empty()) {
+        return true;
+    }
+
+    Predictor predictor(tableBits);
+    encodeBytes(predictor, input.data(), input.size(), output);
+    return true;
+}
+
+bool CMCompressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    uint64_t rawSize;
+    if (!readVarint(ip, end, rawSize) || rawSize > maxSize || ip == end || *ip < MIN_TABLE_BITS ||
+        *ip > MAX_TABLE_BITS) {
+        return false;
+    }
+    unsigned tableBits = *ip++;
+    output.clear();
+    if (rawSize == 0) {
+        return ip == end;
+    }
+    // The encoder sizes the tables to the block, so a larger table means a
+    // corrupt header; this also bounds the output allocation.
+    // No bit costs less than -log2(4095/4096), so no byte less than 1/400
+    // of a bit.
+    if (tableBits > tableBitsFor(MAX_MEMORY_MB, rawSize) || rawSize > (static_cast<uint64_t>(end - ip) + 1) * 4096) {
+        return false;
+    }
+
+    output.resize(static_cast<size_t>(rawSize));
+    Predictor predictor(tableBits);
+    return decodeBytes(predictor, ip, static_cast<size_t>(end - ip), output.data(), output.size());
+}
+
+size_t CMCompressor::tableMemory(uint32_t memoryMb, uint64_t inputSize) {
+    return static_cast<size_t>(BYTES_PER_SLOT) << tableBitsFor(memoryMb, inputSize);
+}
+
+unsigned CMCompressor::tableBitsFor(uint32_t memoryMb, uint64_t inputSize) {
+    memoryMb = std::max(MIN_MEMORY_MB, std::min(MAX_MEMORY_MB, memoryMb));
+    uint64_t budget = static_cast<uint64_t>(memoryMb) << 20;
+    // A byte touches two 16-counter buckets per table.
+    uint64_t useful = inputSize > (UINT64_MAX >> 5) ? UINT64_MAX : inputSize * 32;
+    unsigned bits = MIN_TABLE_BITS;
+    while (bits < MAX_TABLE_BITS && (static_cast<uint64_t>(BYTES_PER_SLOT) << (bits + 1)) <= budget &&
+           (static_cast<uint64_t>(1) << bits) < useful) {
+        bits++;
+    }
+    return bits;
+}
+
+void CMCompressor::writeU32(std::ofstream& output, uint32_t value) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(value & 0xFF),
+        static_cast<unsigned char>((value >> 8) & 0xFF),
+        static_cast<unsigned char>((value >> 16) & 0xFF),
+        static_cast<unsigned char>((value >> 24) & 0xFF)
+    };
+    output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+bool CMCompressor::readU32(std::ifstream& input, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!input.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    value = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+bool CMCompressor::fileExists(const std::string& filename) {
+    return std::filesystem::exists(filename);
+}
+
+size_t CMCompressor::getFileSize(const std::string& filename) {
+    try {
+        return std::filesystem::file_size(filename);
+    } catch (const std::filesystem::filesystem_error&) {
+        return 0;
+    }
+}
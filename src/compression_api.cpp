@@ -2,10 +2,33 @@
 #include "rle.h"
 #include "huffman.h"
 #include "lzw.h"
+#include "lz77.h"
+#include "lzh.h"
+#include "ans.h"
+#include "rans.h"
+#include "bwt.h"
+#include "cm.h"
+#include "block_compressor.h"
+#include "transform_chain.h"
+#include "algorithm_selector.h"
+#include "thread_pool.h"
+#include "progress_reporter.h"
+#include "admission_controller.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 static thread_local char last_error[256] = {0};
 
@@ -29,7 +52,228 @@ double calculate_speed_mbps(uint64_t bytes, double time_ms) {
     return megabytes / seconds;
 }
 
+// Hints the OS to start reading a file we are about to process, so the
+// next batch job finds its input in the page cache.
+void prefetch_file(const char* filename) {
+#if defined(POSIX_FADV_WILLNEED)
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+#else
+    (void)filename;
+#endif
+}
+
+LZ77Params to_lz77_params(const CompressionOptions* options) {
+    LZ77Params params;
+    if (options && options->lz77_window_size > 0) {
+        params.windowSize = options->lz77_window_size;
+    }
+    if (options && options->lz77_chain_depth > 0) {
+        params.chainDepth = options->lz77_chain_depth;
+    }
+    if (options && options->lz77_level > 0) {
+        params.level = options->lz77_level;
+    }
+    if (options) {
+        switch (options->lz77_match_finder) {
+            case MATCH_FINDER_HASH_CHAIN:
+                params.matchFinder = LZ77MatchFinder::HASH_CHAIN;
+                break;
+            case MATCH_FINDER_BINARY_TREE:
+                params.matchFinder = LZ77MatchFinder::BINARY_TREE;
+                break;
+            case MATCH_FINDER_SUFFIX_ARRAY:
+                params.matchFinder = LZ77MatchFinder::SUFFIX_ARRAY;
+                break;
+            default:
+                break;
+        }
+    }
+    return params;
+}
+
+EntropyCoder to_entropy_coder(const CompressionOptions* options) {
+    switch (options ? options->entropy_stage : ENTROPY_STAGE_DEFAULT) {
+        case ENTROPY_STAGE_HUFFMAN:
+            return EntropyCoder::HUFFMAN;
+        case ENTROPY_STAGE_TANS:
+            return EntropyCoder::TANS;
+        default:
+            return EntropyCoder::RANS;
+    }
+}
+
+uint32_t to_cm_memory(const CompressionOptions* options) {
+    return options && options->cm_memory_mb > 0 ? options->cm_memory_mb : CMCompressor::DEFAULT_MEMORY_MB;
+}
+
+uint32_t to_rebuild_interval(const CompressionOptions* options) {
+    return options && options->huffman_rebuild_interval > 0 ? options->huffman_rebuild_interval
+                                                           : HuffmanCompressor::DEFAULT_REBUILD_INTERVAL;
+}
+
+// Stages of options->chain; empty when it is missing or does not parse.
+std::vector<uint8_t> to_chain(const CompressionOptions* options) {
+    std::vector<uint8_t> stages;
+    if (!options || !options->chain || !TransformChain::parse(options->chain, stages)) {
+        stages.clear();
+    }
+    return stages;
+}
+
+// Chains and fused pipelines always use the block container, at the
+// default size if none is set.
+uint64_t to_block_size(CompressionAlgorithm algorithm, const CompressionOptions* options) {
+    uint64_t blockSize = options ? options->block_size : 0;
+    return blockSize == 0 && BlockCodec::isBlockOnly(algorithm) ? COMPRESSION_DEFAULT_BLOCK_SIZE : blockSize;
+}
+
+// The single-stream codecs read and write whole files in one call, with no
+// block boundary at which to wait on a token bucket, so throttling needs
+// the block container.
+bool requests_throttling(const CompressionOptions* options) {
+    return options && (options->max_read_mbps > 0 || options->max_write_mbps > 0 || options->max_cpu_percent > 0);
+}
+
+// What a job reserves from the admission controller: its worker threads and
+// a rough estimate of its buffers. A block job keeps threads + 2 blocks in
+// flight, each holding an input and an output buffer; a legacy single-stream
+// job is charged for its whole input held twice, except BWT, which works on
+// a batch of blocks at a time. Context mixing adds its model tables per
+// stream or block; a decoder is charged for what this caller's options
+// would allocate, since the real size is only in the file. Adaptive Huffman
+// holds a segment or two.
+AdmissionController::Request admission_request(CompressionAlgorithm algorithm, const CompressionOptions* options,
+                                               const char* input_file, CompressionOperation operation) {
+    AdmissionController::Request request;
+    request.priority = options ? options->priority : 0;
+
+    uint64_t blockSize = to_block_size(algorithm, options);
+    if (operation == OPERATION_DECOMPRESS) {
+        CompressionAlgorithm framedAlgorithm;
+        uint32_t framedBlockSize;
+        blockSize = BlockCompressor::readHeader(input_file, framedAlgorithm, framedBlockSize) ? framedBlockSize : 0;
+    }
+
+    if (blockSize > 0) {
+        request.threads = options && options->threads > 0 ? options->threads : ThreadPool::instance().size();
+        request.memory = (request.threads + 2) * blockSize * 2;
+        // Linked blocks also carry the window before them.
+        if (operation == OPERATION_COMPRESS && options && options->lz77_link_blocks) {
+            uint32_t window = LZ77Compressor::normalizedWindow(to_lz77_params(options).windowSize);
+            request.memory += (request.threads + 2) * static_cast<uint64_t>(window);
+        }
+        std::vector<uint8_t> chain = algorithm == ALGORITHM_CHAIN ? to_chain(options) : std::vector<uint8_t>();
+        if (algorithm == ALGORITHM_CM || std::find(chain.begin(), chain.end(), ALGORITHM_CM) != chain.end()) {
+            request.memory += request.threads * CMCompressor::tableMemory(to_cm_memory(options), blockSize);
+        }
+    } else if (algorithm == ALGORITHM_BWT) {
+        request.threads = options && options->threads > 0 ? options->threads : ThreadPool::instance().size();
+        uint64_t blocks = get_file_size_internal(input_file) / BWTCompressor::BLOCK_SIZE + 1;
+        request.memory = std::min<uint64_t>(request.threads, blocks) * BWTCompressor::BLOCK_MEMORY;
+    } else if (algorithm == ALGORITHM_CM) {
+        request.threads = 1;
+        uint64_t size = get_file_size_internal(input_file);
+        request.memory = std::min<uint64_t>(size, CMCompressor::CHUNK_SIZE) * 2 +
+                         CMCompressor::tableMemory(to_cm_memory(options), size);
+    } else if (algorithm == ALGORITHM_HUFFMAN_ADAPTIVE) {
+        // Streams one segment at a time.
+        request.threads = 1;
+        request.memory = static_cast<uint64_t>(HuffmanCompressor::MAX_REBUILD_INTERVAL) * 2;
+    } else {
+        request.threads = 1;
+        request.memory = get_file_size_internal(input_file) * 2;
+    }
+    return request;
+}
+
+BlockOptions to_block_options(const CompressionOptions* options, const std::atomic<bool>* cancelled,
+                              size_t threads) {
+    BlockOptions blockOptions;
+    blockOptions.threads = threads;
+    if (options) {
+        blockOptions.blockSize = options->block_size;
+    }
+    blockOptions.cancelled = cancelled;
+    if (options) {
+        blockOptions.progressCallback = options->progress_callback;
+        blockOptions.progressUserData = options->progress_user_data;
+        blockOptions.progressIntervalMs = options->progress_interval_ms;
+        blockOptions.maxReadBytesPerSecond = options->max_read_mbps * 1024.0 * 1024.0;
+        blockOptions.maxWriteBytesPerSecond = options->max_write_mbps * 1024.0 * 1024.0;
+        blockOptions.maxCpuPercent = options->max_cpu_percent;
+        if (options->checkpoint_path) {
+            blockOptions.checkpointFile = options->checkpoint_path;
+        }
+        if (options->checkpoint_interval_blocks > 0) {
+            blockOptions.checkpointInterval = options->checkpoint_interval_blocks;
+        }
+        blockOptions.resume = options->resume != 0;
+        blockOptions.codec.lz77 = to_lz77_params(options);
+        blockOptions.codec.entropy = to_entropy_coder(options);
+        blockOptions.codec.cmMemoryMb = to_cm_memory(options);
+        blockOptions.codec.huffmanRebuildInterval = to_rebuild_interval(options);
+        blockOptions.codec.chain = to_chain(options);
+        blockOptions.linkBlocks = options->lz77_link_blocks != 0;
+    }
+    return blockOptions;
+}
+
+void init_compression_options(CompressionOptions* options) {
+    if (!options) {
+        set_error("Invalid parameters");
+        return;
+    }
+
+    memset(options, 0, sizeof(CompressionOptions));
+    options->threads = 0;
+    options->block_size = COMPRESSION_DEFAULT_BLOCK_SIZE;
+}
+
+// threads is the worker count granted by the admission controller.
+int run_compression(CompressionAlgorithm algorithm, const char* input_file, const char* output_file,
+                    const CompressionOptions* options, const std::atomic<bool>* cancelled,
+                    size_t threads, CompressionMetrics* metrics);
+
+int run_decompression(CompressionAlgorithm algorithm, const char* input_file, const char* output_file,
+                      const CompressionOptions* options, const std::atomic<bool>* cancelled,
+                      size_t threads, CompressionMetrics* metrics);
+
+int run_operation(CompressionOperation operation, CompressionAlgorithm algorithm, const char* input_file,
+                  const char* output_file, const CompressionOptions* options, const std::atomic<bool>* cancelled,
+                  size_t threads, CompressionMetrics* metrics) {
+    return operation == OPERATION_DECOMPRESS
+        ? run_decompression(algorithm, input_file, output_file, options, cancelled, threads, metrics)
+        : run_compression(algorithm, input_file, output_file, options, cancelled, threads, metrics);
+}
+
+// Synchronous entry point: waits for admission on the calling thread.
+int run_admitted(CompressionOperation operation, CompressionAlgorithm algorithm, const char* input_file,
+                 const char* output_file, const CompressionOptions* options, CompressionMetrics* metrics) {
+    if (!input_file || !output_file || !metrics) {
+        set_error("Invalid parameters");
+        return 0;
+    }
+
+    AdmissionController::Ticket ticket =
+        AdmissionController::instance().acquire(admission_request(algorithm, options, input_file, operation));
+    return run_operation(operation, algorithm, input_file, output_file, options, nullptr, ticket.threads(), metrics);
+}
+
 int compress_file(CompressionAlgorithm algorithm, const char* input_file, const char* output_file, CompressionMetrics* metrics) {
+    return compress_file_ex(algorithm, input_file, output_file, nullptr, metrics);
+}
+
+int compress_file_ex(CompressionAlgorithm algorithm, const char* input_file, const char* output_file,
+                     const CompressionOptions* options, CompressionMetrics* metrics) {
+    return run_admitted(OPERATION_COMPRESS, algorithm, input_file, output_file, options, metrics);
+}
+
+int run_compression(CompressionAlgorithm algorithm, const char* input_file, const char* output_file,
+                    const CompressionOptions* options, const std::atomic<bool>* cancelled,
+                    size_t threads, CompressionMetrics* metrics) {
     if (!input_file || !output_file || !metrics) {
         set_error("Invalid parameters");
         return 0;
@@ -51,19 +295,80 @@ int compress_file(CompressionAlgorithm algorithm, const char* input_file, const
     bool success = false;
 
     try {
-        switch (algorithm) {
-            case ALGORITHM_RLE:
-                success = RLECompressor::compress(input_str, output_str);
-                break;
-            case ALGORITHM_HUFFMAN:
-                success = HuffmanCompressor::compress(input_str, output_str);
-                break;
-            case ALGORITHM_LZW:
-                success = LZWCompressor::compress(input_str, output_str);
-                break;
-            default:
-                strcpy(metrics->error_message, "Invalid algorithm");
-                return 0;
+        if (algorithm == ALGORITHM_CHAIN && to_chain(options).empty()) {
+            strcpy(metrics->error_message, "Invalid transform chain");
+            return 0;
+        }
+        if (to_block_size(algorithm, options) > 0) {
+            BlockOptions blockOptions = to_block_options(options, cancelled, threads);
+            blockOptions.blockSize = to_block_size(algorithm, options);
+            CompressionAlgorithm framedAlgorithm = algorithm;
+            if (algorithm == ALGORITHM_AUTO) {
+                AlgorithmChoice choice;
+                if (!AlgorithmSelector::select(input_str, choice)) {
+                    strcpy(metrics->error_message, "Failed to sample input file");
+                    return 0;
+                }
+                framedAlgorithm = choice.algorithm;
+                blockOptions.autoSelected = true;
+                // An explicit level wins over the selector's.
+                if (choice.lz77Level > 0 && !(options && options->lz77_level > 0)) {
+                    blockOptions.codec.lz77.level = choice.lz77Level;
+                }
+            }
+            success = BlockCompressor::compress(framedAlgorithm, input_str, output_str, blockOptions);
+        } else if (requests_throttling(options)) {
+            strcpy(metrics->error_message, "Throttling requires block mode");
+            return 0;
+        } else {
+            // Single-stream codecs have no block boundaries, so they only
+            // get the final report.
+            ProgressReporter progress(options ? options->progress_callback : nullptr,
+                                      options ? options->progress_user_data : nullptr,
+                                      options ? options->progress_interval_ms : 0,
+                                      metrics->original_size_bytes);
+            switch (algorithm) {
+                case ALGORITHM_RLE:
+                    success = RLECompressor::compress(input_str, output_str);
+                    break;
+                case ALGORITHM_HUFFMAN:
+                    success = HuffmanCompressor::compress(input_str, output_str);
+                    break;
+                case ALGORITHM_LZW:
+                    success = LZWCompressor::compress(input_str, output_str);
+                    break;
+                case ALGORITHM_LZ77:
+                    success = LZ77Compressor::compress(input_str, output_str, to_lz77_params(options));
+                    break;
+                case ALGORITHM_LZH:
+                    success = LZHCompressor::compress(input_str, output_str, to_lz77_params(options));
+                    break;
+                case ALGORITHM_ANS:
+                    success = ANSCompressor::compress(input_str, output_str);
+                    break;
+                case ALGORITHM_RANS:
+                    success = RANSCompressor::compress(input_str, output_str);
+                    break;
+                case ALGORITHM_BWT:
+                    success = BWTCompressor::compress(input_str, output_str, to_entropy_coder(options), threads);
+                    break;
+                case ALGORITHM_CM:
+                    success = CMCompressor::compress(input_str, output_str, to_cm_memory(options));
+                    break;
+                case ALGORITHM_HUFFMAN_O1:
+                    success = HuffmanCompressor::compressOrder1(input_str, output_str);
+                    break;
+                case ALGORITHM_HUFFMAN_ADAPTIVE:
+                    success = HuffmanCompressor::compressAdaptive(input_str, output_str, to_rebuild_interval(options));
+                    break;
+                default:
+                    strcpy(metrics->error_message, "Invalid algorithm");
+                    return 0;
+            }
+            if (success) {
+                progress.advance(metrics->original_size_bytes);
+                progress.finish();
+            }
         }
     } catch (const std::exception& e) {
         strcpy(metrics->error_message, e.what());
@@ -89,7 +394,7 @@ int compress_file(CompressionAlgorithm algorithm, const char* input_file, const
                                                               metrics->compression_time_ms);
         metrics->success = 1;
     } else {
-        strcpy(metrics->error_message, "Compression failed");
+        strcpy(metrics->error_message, cancelled && cancelled->load() ? "Operation cancelled" : "Compression failed");
         metrics->success = 0;
     }
 
@@ -97,6 +402,17 @@ int compress_file(CompressionAlgorithm algorithm, const char* input_file, const
 }
 
 int decompress_file(CompressionAlgorithm algorithm, const char* input_file, const char* output_file, CompressionMetrics* metrics) {
+    return decompress_file_ex(algorithm, input_file, output_file, nullptr, metrics);
+}
+
+int decompress_file_ex(CompressionAlgorithm algorithm, const char* input_file, const char* output_file,
+                       const CompressionOptions* options, CompressionMetrics* metrics) {
+    return run_admitted(OPERATION_DECOMPRESS, algorithm, input_file, output_file, options, metrics);
+}
+
+int run_decompression(CompressionAlgorithm algorithm, const char* input_file, const char* output_file,
+                      const CompressionOptions* options, const std::atomic<bool>* cancelled,
+                      size_t threads, CompressionMetrics* metrics) {
     if (!input_file || !output_file || !metrics) {
         set_error("Invalid parameters");
         return 0;
@@ -117,20 +433,69 @@ int decompress_file(CompressionAlgorithm algorithm, const char* input_file, cons
     auto start_time = std::chrono::high_resolution_clock::now();
     bool success = false;
 
+    CompressionAlgorithm framedAlgorithm;
+    uint32_t framedBlockSize;
+    bool framed = BlockCompressor::readHeader(input_str, framedAlgorithm, framedBlockSize);
+    if (framed && framedAlgorithm != algorithm && algorithm != ALGORITHM_AUTO) {
+        strcpy(metrics->error_message, "File was compressed with a different algorithm");
+        return 0;
+    }
+
     try {
-        switch (algorithm) {
-            case ALGORITHM_RLE:
-                success = RLECompressor::decompress(input_str, output_str);
-                break;
-            case ALGORITHM_HUFFMAN:
-                success = HuffmanCompressor::decompress(input_str, output_str);
-                break;
-            case ALGORITHM_LZW:
-                success = LZWCompressor::decompress(input_str, output_str);
-                break;
-            default:
-                strcpy(metrics->error_message, "Invalid algorithm");
-                return 0;
+        if (framed) {
+            success = BlockCompressor::decompress(input_str, output_str, to_block_options(options, cancelled, threads));
+        } else if (requests_throttling(options)) {
+            strcpy(metrics->error_message, "Throttling requires block mode");
+            return 0;
+        } else {
+            // Single-stream codecs have no block boundaries, so they only
+            // get the final report.
+            ProgressReporter progress(options ? options->progress_callback : nullptr,
+                                      options ? options->progress_user_data : nullptr,
+                                      options ? options->progress_interval_ms : 0,
+                                      metrics->compressed_size_bytes);
+            switch (algorithm) {
+                case ALGORITHM_RLE:
+                    success = RLECompressor::decompress(input_str, output_str);
+                    break;
+                case ALGORITHM_HUFFMAN:
+                    success = HuffmanCompressor::decompress(input_str, output_str);
+                    break;
+                case ALGORITHM_LZW:
+                    success = LZWCompressor::decompress(input_str, output_str);
+                    break;
+                case ALGORITHM_LZ77:
+                    success = LZ77Compressor::decompress(input_str, output_str);
+                    break;
+                case ALGORITHM_LZH:
+                    success = LZHCompressor::decompress(input_str, output_str);
+                    break;
+                case ALGORITHM_ANS:
+                    success = ANSCompressor::decompress(input_str, output_str);
+                    break;
+                case ALGORITHM_RANS:
+                    success = RANSCompressor::decompress(input_str, output_str);
+                    break;
+                case ALGORITHM_BWT:
+                    success = BWTCompressor::decompress(input_str, output_str, threads);
+                    break;
+                case ALGORITHM_CM:
+                    success = CMCompressor::decompress(input_str, output_str);
+                    break;
+                case ALGORITHM_HUFFMAN_O1:
+                    success = HuffmanCompressor::decompressOrder1(input_str, output_str);
+                    break;
+                case ALGORITHM_HUFFMAN_ADAPTIVE:
+                    success = HuffmanCompressor::decompressAdaptive(input_str, output_str);
+                    break;
+                default:
+                    strcpy(metrics->error_message, "Invalid algorithm");
+                    return 0;
+            }
+            if (success) {
+                progress.advance(metrics->compressed_size_bytes);
+                progress.finish();
+            }
         }
     } catch (const std::exception& e) {
         strcpy(metrics->error_message, e.what());
@@ -156,13 +521,285 @@ int decompress_file(CompressionAlgorithm algorithm, const char* input_file, cons
                                                                 metrics->decompression_time_ms);
         metrics->success = 1;
     } else {
-        strcpy(metrics->error_message, "Decompression failed");
+        strcpy(metrics->error_message, cancelled && cancelled->load() ? "Operation cancelled" : "Decompression failed");
         metrics->success = 0;
     }
 
     return success ? 1 : 0;
 }
 
+int compress_files_batch(const CompressionJob* jobs, uint32_t count, const CompressionOptions* options,
+                         CompressionMetrics* results) {
+    if ((!jobs || !results) && count > 0) {
+        set_error("Invalid parameters");
+        return 0;
+    }
+
+    ThreadPool& pool = ThreadPool::instance();
+    const uint32_t lookahead = static_cast<uint32_t>(pool.size());
+    std::atomic<uint32_t> failures(0);
+
+    for (uint32_t i = 0; i < count && i < lookahead; i++) {
+        if (jobs[i].input_file) prefetch_file(jobs[i].input_file);
+    }
+
+    // Admission is waited for here, on the calling thread, so queued jobs
+    // never park a pool worker that admitted jobs need.
+    AdmissionController& admission = AdmissionController::instance();
+    TaskGroup group(pool);
+    for (uint32_t i = 0; i < count; i++) {
+        const CompressionJob& job = jobs[i];
+        CompressionMetrics* metrics = &results[i];
+
+        memset(metrics, 0, sizeof(CompressionMetrics));
+        if (!job.input_file || !job.output_file) {
+            strcpy(metrics->error_message, "Invalid parameters");
+            failures++;
+            continue;
+        }
+
+        auto ticket = std::make_shared<AdmissionController::Ticket>(
+            admission.acquire(admission_request(job.algorithm, options, job.input_file, job.operation)));
+        group.run([&, i, ticket]() {
+            const CompressionJob& job = jobs[i];
+
+            if (i + lookahead < count && jobs[i + lookahead].input_file) {
+                prefetch_file(jobs[i + lookahead].input_file);
+            }
+
+            int ok = run_operation(job.operation, job.algorithm, job.input_file, job.output_file,
+                                   options, nullptr, ticket->threads(), &results[i]);
+            if (!ok) {
+                failures++;
+            }
+        });
+    }
+    group.wait();
+
+    return failures == 0 ? 1 : 0;
+}
+
+struct CompressionJobState {
+    CompressionAlgorithm algorithm;
+    CompressionOperation operation;
+    std::string input_file;
+    std::string output_file;
+    CompressionOptions options;
+    std::string checkpoint_path;
+    bool has_options;
+    CompressionJobCallback callback;
+    void* user_data;
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> references{2};  // caller's handle + the queued task
+    AdmissionController::Ticket ticket;
+    uint64_t admission_sequence = 0;
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    CompressionJobStatus status = JOB_QUEUED;
+    CompressionMetrics metrics{};
+};
+
+void release_job_reference(CompressionJobState* job) {
+    if (--job->references == 0) {
+        delete job;
+    }
+}
+
+void finish_job(CompressionJobState* job, CompressionJobStatus status, const CompressionMetrics& metrics) {
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->metrics = metrics;
+        job->status = status;
+        job->finished.notify_all();
+    }
+
+    if (job->callback) {
+        job->callback(job, status, &job->metrics, job->user_data);
+    }
+}
+
+void run_job(CompressionJobState* job) {
+    bool cancelledWhileQueued = false;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        cancelledWhileQueued = job->status == JOB_CANCELLED;
+        if (!cancelledWhileQueued) {
+            job->status = JOB_RUNNING;
+        }
+    }
+    if (cancelledWhileQueued) {
+        job->ticket = AdmissionController::Ticket();
+        release_job_reference(job);
+        return;
+    }
+
+    const CompressionOptions* options = job->has_options ? &job->options : nullptr;
+    CompressionMetrics metrics;
+    int ok = run_operation(job->operation, job->algorithm, job->input_file.c_str(), job->output_file.c_str(),
+                           options, &job->cancelled, job->ticket.threads(), &metrics);
+    job->ticket = AdmissionController::Ticket();
+
+    CompressionJobStatus status = ok ? JOB_SUCCEEDED : JOB_FAILED;
+    if (!ok && job->cancelled.load()) {
+        status = JOB_CANCELLED;
+        // Checkpointed output is kept so the job can be resumed.
+        if (job->checkpoint_path.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(job->output_file, ec);
+        }
+    }
+
+    finish_job(job, status, metrics);
+    release_job_reference(job);
+}
+
+CompressionJobHandle submit_compression_job(const CompressionJob* job, const CompressionOptions* options,
+                                            CompressionJobCallback callback, void* user_data) {
+    if (!job || !job->input_file || !job->output_file) {
+        set_error("Invalid parameters");
+        return nullptr;
+    }
+
+    CompressionJobState* state = new CompressionJobState();
+    state->algorithm = job->algorithm;
+    state->operation = job->operation;
+    state->input_file = job->input_file;
+    state->output_file = job->output_file;
+    state->has_options = options != nullptr;
+    if (options) {
+        state->options = *options;
+        if (options->checkpoint_path) {
+            state->checkpoint_path = options->checkpoint_path;
+            state->options.checkpoint_path = state->checkpoint_path.c_str();
+        }
+    }
+    state->callback = callback;
+    state->user_data = user_data;
+
+    // The job enters the pool only once admitted; until then it holds no
+    // worker.
+    state->admission_sequence = AdmissionController::instance().enqueue(
+        admission_request(job->algorithm, options, job->input_file, job->operation),
+        [state](AdmissionController::Ticket ticket) {
+            state->ticket = std::move(ticket);
+            ThreadPool::instance().submit([state]() { run_job(state); });
+        });
+    return state;
+}
+
+CompressionJobStatus poll_compression_job(CompressionJobHandle job, CompressionMetrics* metrics) {
+    if (!job) {
+        set_error("Invalid parameters");
+        return JOB_FAILED;
+    }
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    if (metrics && job->status >= JOB_SUCCEEDED) {
+        *metrics = job->metrics;
+    }
+    return job->status;
+}
+
+CompressionJobStatus wait_compression_job(CompressionJobHandle job, CompressionMetrics* metrics) {
+    if (!job) {
+        set_error("Invalid parameters");
+        return JOB_FAILED;
+    }
+
+    // Help the pool while waiting so a wait issued from a worker thread
+    // cannot block the job it is waiting for.
+    ThreadPool& pool = ThreadPool::instance();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(job->mutex);
+            if (job->status >= JOB_SUCCEEDED) {
+                if (metrics) {
+                    *metrics = job->metrics;
+                }
+                return job->status;
+            }
+        }
+        if (!pool.runPendingTask()) {
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->finished.wait_for(lock, std::chrono::milliseconds(1),
+                                   [job] { return job->status >= JOB_SUCCEEDED; });
+        }
+    }
+}
+
+int cancel_compression_job(CompressionJobHandle job) {
+    if (!job) {
+        set_error("Invalid parameters");
+        return 0;
+    }
+
+    job->cancelled = true;
+
+    // A job that has not started yet finishes right away; a running one
+    // stops at its next block boundary.
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (job->status >= JOB_SUCCEEDED) {
+            return 0;
+        }
+        if (job->status == JOB_RUNNING) {
+            return 1;
+        }
+        memset(&job->metrics, 0, sizeof(job->metrics));
+        strcpy(job->metrics.error_message, "Operation cancelled");
+        job->status = JOB_CANCELLED;
+        job->finished.notify_all();
+    }
+
+    if (job->callback) {
+        job->callback(job, JOB_CANCELLED, &job->metrics, job->user_data);
+    }
+
+    // A job still waiting for admission leaves the queue now rather than
+    // blocking the jobs behind it; run_job will never see it, so its
+    // reference is dropped here. Once admitted, run_job drops it instead.
+    if (AdmissionController::instance().cancel(job->admission_sequence)) {
+        release_job_reference(job);
+    }
+    return 1;
+}
+
+void release_compression_job(CompressionJobHandle job) {
+    if (job) {
+        release_job_reference(job);
+    }
+}
+
+int set_thread_pool_size(uint32_t threads) {
+    return ThreadPool::configure(threads) ? 1 : 0;
+}
+
+int configure_thread_pool(uint32_t threads, int pin_workers) {
+    return ThreadPool::configure(threads, pin_workers != 0) ? 1 : 0;
+}
+
+uint32_t get_thread_pool_size(void) {
+    return static_cast<uint32_t>(ThreadPool::instance().size());
+}
+
+int configure_admission_control(const AdmissionLimits* limits) {
+    AdmissionController::Limits configured;
+    if (limits) {
+        if (limits->policy != ADMISSION_FIFO && limits->policy != ADMISSION_PRIORITY) {
+            set_error("Invalid admission policy");
+            return 0;
+        }
+        configured.maxJobs = limits->max_concurrent_jobs;
+        configured.maxThreads = limits->max_worker_threads;
+        configured.maxMemory = limits->max_buffer_memory;
+        configured.priorityOrder = limits->policy == ADMISSION_PRIORITY;
+    }
+    AdmissionController::instance().configure(configured);
+    return 1;
+}
+
 int get_file_size(const char* filename, uint64_t* size) {
     if (!filename || !size) {
         set_error("Invalid parameters");
@@ -178,6 +815,18 @@ const char* get_algorithm_name(CompressionAlgorithm algorithm) {
         case ALGORITHM_RLE: return "Run-Length Encoding";
         case ALGORITHM_HUFFMAN: return "Huffman Coding";
         case ALGORITHM_LZW: return "LZW";
+        case ALGORITHM_LZ77: return "LZ77";
+        case ALGORITHM_LZH: return "LZ77 + Huffman";
+        case ALGORITHM_ANS: return "tANS";
+        case ALGORITHM_RANS: return "Interleaved rANS";
+        case ALGORITHM_BWT: return "BWT";
+        case ALGORITHM_CM: return "Context mixing";
+        case ALGORITHM_HUFFMAN_O1: return "Order-1 Huffman";
+        case ALGORITHM_HUFFMAN_ADAPTIVE: return "Adaptive Huffman";
+        case ALGORITHM_CHAIN: return "Transform chain";
+        case ALGORITHM_RLE_HUFFMAN: return "Fused RLE + Huffman";
+        case ALGORITHM_DELTA_RLE_HUFFMAN: return "Fused delta + RLE + Huffman";
+        case ALGORITHM_AUTO: return "Automatic";
         default: return "Unknown";
     }
 }
@@ -0,0 +1,416 @@
+#include "daemon.h"
+#include "compression_api.h"
+#include "transform_chain.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+const int POLL_INTERVAL_MS = 200;
+
+// A connection thread; finished is set as it returns, so the accept loop
+// can join it without blocking.
+struct Connection {
+    std::thread thread;
+    std::atomic<bool> finished{false};
+};
+
+void joinFinished(std::list<std::unique_ptr<Connection>>& connections) {
+    for (auto it = connections.begin(); it != connections.end();) {
+        if ((*it)->finished) {
+            (*it)->thread.join();
+            it = connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<std::string> splitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    std::string field;
+    std::istringstream stream(line);
+    while (std::getline(stream, field, '\t')) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+#ifndef _WIN32
+void onStopSignal(int) {
+    stopRequested = true;
+}
+
+bool makeAddress(const std::string& socketPath, sockaddr_un& address) {
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Socket path '" << socketPath << "' is too long.\n";
+        return false;
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    return true;
+}
+#endif
+
+}
+
+#ifndef _WIN32
+
+bool CompressionDaemon::serve(const std::string& socketPath) {
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return false;
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::cerr << "Error: Cannot create socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+
+    // A socket file left behind by a daemon that died is replaced; one that
+    // still accepts connections belongs to a live daemon.
+    if (connect(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        std::cerr << "Error: A daemon is already listening on '" << socketPath << "'.\n";
+        close(listener);
+        return false;
+    }
+    close(listener);
+    unlink(socketPath.c_str());
+
+    // Owner-only, on top of the peer check, so other users cannot even
+    // connect where the file system honours socket permissions.
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        chmod(socketPath.c_str(), S_IRUSR | S_IWUSR) != 0 || listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Error: Cannot listen on '" << socketPath << "': " << std::strerror(errno) << "\n";
+        if (listener >= 0) {
+            close(listener);
+        }
+        return false;
+    }
+
+    stopRequested = false;
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    // Asking for the pool size starts it now, so the first request does not
+    // pay for it.
+    std::cout << "Listening on " << socketPath << " with " << get_thread_pool_size() << " worker threads" << std::endl;
+
+    // Each connection has a thread, which mostly waits: for the client, or
+    // in the admission controller for its job's turn. Past MAX_CONNECTIONS
+    // new clients are left in the listen backlog.
+    std::list<std::unique_ptr<Connection>> connections;
+    while (!stopRequested) {
+        joinFinished(connections);
+        if (connections.size() >= MAX_CONNECTIONS) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+            continue;
+        }
+        pollfd waiting = {listener, POLLIN, 0};
+        if (poll(&waiting, 1, POLL_INTERVAL_MS) <= 0) {
+            continue;
+        }
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        if (!isTrustedPeer(client)) {
+            writeAll(client, "ERR\tPermission denied\n");
+            close(client);
+            continue;
+        }
+        connections.push_back(std::make_unique<Connection>());
+        Connection* connection = connections.back().get();
+        connection->thread = std::thread([connection, client] {
+            handleConnection(client);
+            connection->finished = true;
+        });
+    }
+
+    // Connections finish the request they are running, then notice the stop.
+    close(listener);
+    unlink(socketPath.c_str());
+    for (const std::unique_ptr<Connection>& connection : connections) {
+        connection->thread.join();
+    }
+
+    std::cout << "Daemon stopped" << std::endl;
+    return true;
+}
+
+bool CompressionDaemon::submit(const std::string& socketPath, const DaemonRequest& request, std::string& reply,
+                               CompressionProgressCallback progress) {
+    std::string line = request.mode + "\t" + request.algorithm + "\t" + std::to_string(request.blockSize) + "\t" +
+                       request.inputFile + "\t" + request.outputFile;
+    for (const auto& option : request.options) {
+        line += "\t" + option.first + "=" + option.second;
+    }
+    for (const std::string* field : {&request.inputFile, &request.outputFile}) {
+        if (field->find_first_of("\t\n") != std::string::npos) {
+            std::cerr << "Error: File names sent to the daemon cannot contain tabs or newlines.\n";
+            return false;
+        }
+    }
+    for (const auto& option : request.options) {
+        if (option.second.find_first_of("\t\n") != std::string::npos) {
+            std::cerr << "Error: Options sent to the daemon cannot contain tabs or newlines.\n";
+            return false;
+        }
+    }
+
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return false;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Error: Cannot connect to daemon at '" << socketPath << "': " << std::strerror(errno) << "\n";
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+
+    std::string buffer;
+    bool ok = writeAll(fd, line + "\n");
+    while (ok && (ok = readLine(fd, buffer, reply)) && reply.compare(0, 9, "PROGRESS\t") == 0) {
+        CompressionProgress report = {};
+        std::istringstream fields(reply.substr(9));
+        fields >> report.bytes_processed >> report.total_bytes >> report.throughput_mbps >> report.eta_seconds;
+        if (progress) {
+            progress(&report, nullptr);
+        }
+    }
+    close(fd);
+
+    if (!ok) {
+        std::cerr << "Error: Daemon closed the connection.\n";
+    }
+    return ok;
+}
+
+void CompressionDaemon::handleConnection(int fd) {
+    std::string buffer;
+    std::string line;
+    while (readLine(fd, buffer, line)) {
+        if (!writeAll(fd, handleRequest(fd, line) + "\n")) {
+            break;
+        }
+    }
+    close(fd);
+}
+
+bool CompressionDaemon::isTrustedPeer(int fd) {
+    uid_t uid;
+#ifdef SO_PEERCRED
+    ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0) {
+        return false;
+    }
+    uid = credentials.uid;
+#else
+    gid_t gid;
+    if (getpeereid(fd, &uid, &gid) != 0) {
+        return false;
+    }
+#endif
+    return uid == geteuid() || uid == 0;
+}
+
+bool CompressionDaemon::readLine(int fd, std::string& buffer, std::string& line) {
+    while (true) {
+        size_t newline = buffer.find('\n');
+        if (newline != std::string::npos) {
+            line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            return true;
+        }
+
+        // Wake up periodically so idle connections notice a shutdown.
+        pollfd waiting = {fd, POLLIN, 0};
+        int ready = poll(&waiting, 1, POLL_INTERVAL_MS);
+        if (ready == 0) {
+            if (stopRequested) {
+                return false;
+            }
+            continue;
+        }
+
+        char chunk[4096];
+        ssize_t received = ready > 0 ? recv(fd, chunk, sizeof(chunk), 0) : -1;
+        if (received <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<size_t>(received));
+    }
+}
+
+bool CompressionDaemon::writeAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+#else
+
+bool CompressionDaemon::serve(const std::string&) {
+    std::cerr << "Error: Daemon mode requires Unix domain sockets and is not available on Windows.\n";
+    return false;
+}
+
+bool CompressionDaemon::submit(const std::string&, const DaemonRequest&, std::string&, CompressionProgressCallback) {
+    std::cerr << "Error: Daemon mode requires Unix domain sockets and is not available on Windows.\n";
+    return false;
+}
+
+void CompressionDaemon::handleConnection(int) {}
+
+bool CompressionDaemon::isTrustedPeer(int) {
+    return false;
+}
+
+bool CompressionDaemon::readLine(int, std::string&, std::string&) {
+    return false;
+}
+
+bool CompressionDaemon::writeAll(int, const std::string&) {
+    return false;
+}
+
+#endif
+
+void CompressionDaemon::sendProgress(const CompressionProgress* progress, void* userData) {
+    writeAll(*static_cast<int*>(userData), "PROGRESS\t" + std::to_string(progress->bytes_processed) + "\t" +
+                                               std::to_string(progress->total_bytes) + "\t" +
+                                               std::to_string(progress->throughput_mbps) + "\t" +
+                                               std::to_string(progress->eta_seconds) + "\n");
+}
+
+std::string CompressionDaemon::handleRequest(int fd, const std::string& line) {
+    std::vector<std::string> fields = splitFields(line);
+    if (fields.size() < 5) {
+        return "ERR\tMalformed request";
+    }
+
+    // A chain's stages are checked when the job runs.
+    CompressionAlgorithm algorithm;
+    if (!TransformChain::algorithmId(fields[1], algorithm)) {
+        return "ERR\tUnknown algorithm";
+    }
+
+    CompressionOptions options;
+    init_compression_options(&options);
+    try {
+        options.block_size = static_cast<uint32_t>(std::stoul(fields[2]));
+    } catch (...) {
+        return "ERR\tInvalid block size";
+    }
+    if (algorithm == ALGORITHM_CHAIN) {
+        options.chain = fields[1].c_str();
+    }
+
+    // The same names, values and ranges as the CLI options; the client
+    // has already checked them.
+    std::string checkpoint;
+    for (size_t i = 5; i < fields.size(); i++) {
+        size_t equals = fields[i].find('=');
+        std::string name = fields[i].substr(0, equals);
+        std::string value = equals == std::string::npos ? std::string() : fields[i].substr(equals + 1);
+        try {
+            if (name == "level") {
+                options.lz77_level = static_cast<uint32_t>(std::stoul(value));
+            } else if (name == "window") {
+                options.lz77_window_size = static_cast<uint32_t>(std::stoul(value));
+            } else if (name == "chain-depth") {
+                options.lz77_chain_depth = static_cast<uint32_t>(std::stoul(value));
+            } else if (name == "match-finder" && value == "hc") {
+                options.lz77_match_finder = MATCH_FINDER_HASH_CHAIN;
+            } else if (name == "match-finder" && value == "bt") {
+                options.lz77_match_finder = MATCH_FINDER_BINARY_TREE;
+            } else if (name == "match-finder" && value == "sa") {
+                options.lz77_match_finder = MATCH_FINDER_SUFFIX_ARRAY;
+            } else if (name == "link-blocks") {
+                options.lz77_link_blocks = std::stoi(value);
+            } else if (name == "entropy" && value == "huffman") {
+                options.entropy_stage = ENTROPY_STAGE_HUFFMAN;
+            } else if (name == "entropy" && value == "tans") {
+                options.entropy_stage = ENTROPY_STAGE_TANS;
+            } else if (name == "entropy" && value == "rans") {
+                options.entropy_stage = ENTROPY_STAGE_RANS;
+            } else if (name == "memory") {
+                options.cm_memory_mb = static_cast<uint32_t>(std::stoul(value));
+            } else if (name == "rebuild-interval") {
+                options.huffman_rebuild_interval = static_cast<uint32_t>(std::stoul(value));
+            } else if (name == "threads") {
+                options.threads = static_cast<uint32_t>(std::stoul(value));
+            } else if (name == "checkpoint") {
+                checkpoint = value;
+                options.checkpoint_path = checkpoint.c_str();
+            } else if (name == "resume") {
+                options.resume = std::stoi(value);
+            } else if (name == "max-read-mbps") {
+                options.max_read_mbps = std::stod(value);
+            } else if (name == "max-write-mbps") {
+                options.max_write_mbps = std::stod(value);
+            } else if (name == "max-cpu") {
+                options.max_cpu_percent = static_cast<uint32_t>(std::stoul(value));
+            } else if (name == "progress") {
+                options.progress_callback = std::stoi(value) ? sendProgress : nullptr;
+                options.progress_user_data = &fd;
+            } else {
+                return "ERR\tUnsupported option '" + name + "'";
+            }
+        } catch (...) {
+            return "ERR\tInvalid value for '" + name + "'";
+        }
+    }
+
+    CompressionMetrics metrics;
+    int ok;
+    double timeMs;
+    if (fields[0] == "compress") {
+        ok = compress_file_ex(algorithm, fields[3].c_str(), fields[4].c_str(), &options, &metrics);
+        timeMs = metrics.compression_time_ms;
+    } else if (fields[0] == "decompress") {
+        ok = decompress_file_ex(algorithm, fields[3].c_str(), fields[4].c_str(), &options, &metrics);
+        timeMs = metrics.decompression_time_ms;
+    } else {
+        return "ERR\tUnknown mode";
+    }
+
+    if (!ok) {
+        return std::string("ERR\t") + (metrics.error_message[0] ? metrics.error_message : get_last_error());
+    }
+    return "OK\t" + std::to_string(metrics.original_size_bytes) + "\t" +
+           std::to_string(metrics.compressed_size_bytes) + "\t" + std::to_string(timeMs);
+}
@@ -0,0 +1,61 @@
+#include "entropy_backend.h"
+#include "huffman.h"
+#include "ans.h"
+#include "rans.h"
+#include <cstring>
+
+bool EntropyBackend::isValid(uint8_t coder) {
+    return coder <= static_cast<uint8_t>(EntropyCoder::RANS);
+}
+
+const char* EntropyBackend::name(EntropyCoder coder) {
+    switch (coder) {
+        case EntropyCoder::HUFFMAN:
+            return "huffman";
+        case EntropyCoder::TANS:
+            return "tans";
+        case EntropyCoder::RANS:
+            return "rans";
+    }
+    return "unknown";
+}
+
+void EntropyBackend::encode(EntropyCoder coder, const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+    switch (coder) {
+        case EntropyCoder::HUFFMAN: {
+            // The Huffman block format is self-delimiting and works on whole
+            // vectors.
+            std::vector<uint8_t> input(data, data + size);
+            std::vector<uint8_t> encoded;
+            HuffmanCompressor::compressBlock(input, encoded);
+            output.insert(output.end(), encoded.begin(), encoded.end());
+            break;
+        }
+        case EntropyCoder::TANS:
+            ANSCompressor::encode(data, size, output);
+            break;
+        case EntropyCoder::RANS:
+            RANSCompressor::encode(data, size, output);
+            break;
+    }
+}
+
+bool EntropyBackend::decode(EntropyCoder coder, const uint8_t* input, size_t inputSize, uint8_t* output,
+                            size_t rawSize) {
+    switch (coder) {
+        case EntropyCoder::HUFFMAN: {
+            std::vector<uint8_t> encoded(input, input + inputSize);
+            std::vector<uint8_t> decoded;
+            if (!HuffmanCompressor::decompressBlock(encoded, decoded, rawSize) || decoded.size() != rawSize) {
+                return false;
+            }
+            std::memcpy(output, decoded.data(), rawSize);
+            return true;
+        }
+        case EntropyCoder::TANS:
+            return ANSCompressor::decode(input, inputSize, output, rawSize);
+        case EntropyCoder::RANS:
+            return RANSCompressor::decode(input, inputSize, output, rawSize);
+    }
+    return false;
+}
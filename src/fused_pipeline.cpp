@@ -0,0 +1,4 @@
+#include "fused_pipeline.h"
+
+template class FusedPipeline<RLEStage, HuffmanStage>;
+template class FusedPipeline<DeltaStage<4>, RLEStage, HuffmanStage>;
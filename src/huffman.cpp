@@ -3,6 +3,302 @@
 #include <fstream>
 #include <filesystem>
 #include <bitset>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr unsigned CONTEXTS = 256;
+constexpr int MAX_CLUSTER_ROUNDS = 8;
+
+// Byte frequencies per previous byte, indexed [context * 256 + symbol]. The
+// first byte counts as following a 0.
+using ContextCounts = std::vector<uint32_t>;
+
+// A grouping of contexts into code tables.
+struct ContextClusters {
+    unsigned tables = 0;
+    std::vector<uint8_t> map;
+    std::vector<uint8_t> lengths;   // [table * 256 + symbol]
+    uint64_t bits = UINT64_MAX;     // header and codes
+};
+
+unsigned mapBits(unsigned tables) {
+    unsigned bits = 0;
+    while ((1u << bits) < tables) {
+        bits++;
+    }
+    return bits;
+}
+
+// Moves every context to the table that codes it most cheaply and rebuilds
+// the tables from their contexts until nothing moves. Costs come from
+// smoothed table frequencies, so a context can move to a table that has not
+// seen all of its symbols yet. contextCost receives each context's cost in
+// bits under its final table.
+void refineClusters(const ContextCounts& counts, const std::vector<unsigned>& active, unsigned tables,
+                    std::vector<uint8_t>& map, std::vector<double>& contextCost) {
+    std::vector<uint64_t> frequencies(tables * 256);
+    std::vector<uint64_t> totals(tables);
+    std::vector<double> cost(tables * 256);
+    for (int round = 0; round < MAX_CLUSTER_ROUNDS; round++) {
+        std::fill(frequencies.begin(), frequencies.end(), 0);
+        std::fill(totals.begin(), totals.end(), 0);
+        for (unsigned context : active) {
+            for (unsigned symbol = 0; symbol < 256; symbol++) {
+                frequencies[map[context] * 256 + symbol] += counts[context * 256 + symbol];
+                totals[map[context]] += counts[context * 256 + symbol];
+            }
+        }
+        for (unsigned table = 0; table < tables; table++) {
+            double scale = 1.0 / (static_cast<double>(totals[table]) + 128.0);
+            for (unsigned symbol = 0; symbol < 256; symbol++) {
+                cost[table * 256 + symbol] =
+                    -std::log2((static_cast<double>(frequencies[table * 256 + symbol]) + 0.5) * scale);
+            }
+        }
+
+        bool moved = false;
+        for (unsigned context : active) {
+            const uint32_t* row = &counts[context * 256];
+            unsigned best = map[context];
+            double bestCost = HUGE_VAL;
+            for (unsigned table = 0; table < tables; table++) {
+                double sum = 0;
+                for (unsigned symbol = 0; symbol < 256; symbol++) {
+                    if (row[symbol]) {
+                        sum += row[symbol] * cost[table * 256 + symbol];
+                    }
+                }
+                if (sum < bestCost) {
+                    bestCost = sum;
+                    best = table;
+                }
+            }
+            contextCost[context] = bestCost;
+            if (best != map[context]) {
+                map[context] = static_cast<uint8_t>(best);
+                moved = true;
+            }
+        }
+        if (!moved) {
+            break;
+        }
+    }
+}
+
+// Drops tables no context uses, builds length-limited codes for the rest
+// and counts the exact size in bits.
+ContextClusters finishClusters(const ContextCounts& counts, const std::vector<unsigned>& active,
+                               unsigned tables, const std::vector<uint8_t>& map) {
+    std::vector<int> renumber(tables, -1);
+    ContextClusters clusters;
+    clusters.map.assign(CONTEXTS, 0);
+    for (unsigned context : active) {
+        if (renumber[map[context]] < 0) {
+            renumber[map[context]] = static_cast<int>(clusters.tables++);
+        }
+        clusters.map[context] = static_cast<uint8_t>(renumber[map[context]]);
+    }
+
+    std::vector<uint32_t> frequencies(clusters.tables * 256, 0);
+    for (unsigned context : active) {
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            frequencies[clusters.map[context] * 256 + symbol] += counts[context * 256 + symbol];
+        }
+    }
+
+    clusters.bits = 3 + CONTEXTS * mapBits(clusters.tables) + clusters.tables * 256 * 4;
+    clusters.lengths.resize(clusters.tables * 256);
+    for (unsigned table = 0; table < clusters.tables; table++) {
+        std::vector<uint32_t> tableFrequencies(frequencies.begin() + table * 256,
+                                               frequencies.begin() + (table + 1) * 256);
+        std::vector<uint8_t> lengths =
+            HuffmanCompressor::buildCodeLengths(tableFrequencies, CanonicalHuffmanDecoder::TABLE_BITS);
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            clusters.lengths[table * 256 + symbol] = lengths[symbol];
+            clusters.bits += static_cast<uint64_t>(tableFrequencies[symbol]) * lengths[symbol];
+        }
+    }
+    return clusters;
+}
+
+// Grows the table count one split at a time: the context that its table
+// codes worst relative to its own statistics seeds the next table. Returns
+// the smallest of the groupings with 1 to maxTables tables.
+ContextClusters clusterContexts(const ContextCounts& counts, unsigned maxTables) {
+    std::vector<unsigned> active;
+    std::vector<double> selfCost(CONTEXTS, 0);
+    for (unsigned context = 0; context < CONTEXTS; context++) {
+        const uint32_t* row = &counts[context * 256];
+        uint64_t total = 0;
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            total += row[symbol];
+        }
+        if (total == 0) {
+            continue;
+        }
+        active.push_back(context);
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            if (row[symbol]) {
+                selfCost[context] -= row[symbol] * std::log2(static_cast<double>(row[symbol]) / total);
+            }
+        }
+    }
+
+    std::vector<uint8_t> map(CONTEXTS, 0);
+    std::vector<double> contextCost(CONTEXTS, 0);
+    refineClusters(counts, active, 1, map, contextCost);
+    ContextClusters best = finishClusters(counts, active, 1, map);
+
+    for (unsigned tables = 2; tables <= maxTables && tables <= active.size(); tables++) {
+        unsigned seed = active[0];
+        double worst = -1;
+        for (unsigned context : active) {
+            double excess = contextCost[context] - selfCost[context];
+            if (excess > worst) {
+                worst = excess;
+                seed = context;
+            }
+        }
+        map[seed] = static_cast<uint8_t>(tables - 1);
+        refineClusters(counts, active, tables, map, contextCost);
+
+        ContextClusters candidate = finishClusters(counts, active, tables, map);
+        if (candidate.bits < best.bits) {
+            best = std::move(candidate);
+        }
+    }
+    return best;
+}
+
+// The code both sides of the adaptive mode share. Each is fed every segment
+// once it is coded, so both rebuild the same code at the same point.
+class AdaptiveHuffmanModel {
+public:
+    AdaptiveHuffmanModel() : counts_(256, 1), total_(256) {
+        rebuild();
+    }
+
+    void encode(const uint8_t* data, size_t size, std::vector<uint8_t>& output) const {
+        BitBufferWriter writer(output);
+        for (size_t i = 0; i < size; i++) {
+            writer.write(codes_[data[i]], lengths_[data[i]]);
+        }
+        writer.flush();
+    }
+
+    // Decodes exactly rawSize bytes from all of input[0, inputSize).
+    bool decode(const uint8_t* input, size_t inputSize, uint8_t* output, size_t rawSize) const {
+        BitBufferReader reader(input, inputSize);
+        for (size_t i = 0; i < rawSize; i++) {
+            int symbol = decoder_.decode(reader);
+            if (symbol < 0) {
+                return false;
+            }
+            output[i] = static_cast<uint8_t>(symbol);
+        }
+        return !reader.overrun() && reader.bytesConsumed() == inputSize;
+    }
+
+    void update(const uint8_t* data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            counts_[data[i]]++;
+        }
+        total_ += size;
+        // Halving keeps the code following recent data; counts stay at
+        // least 1 so every byte keeps a code.
+        while (total_ > MAX_TOTAL) {
+            total_ = 0;
+            for (uint32_t& count : counts_) {
+                count = (count + 1) / 2;
+                total_ += count;
+            }
+        }
+        rebuild();
+    }
+
+private:
+    static constexpr uint64_t MAX_TOTAL = 1u << 16;
+
+    void rebuild() {
+        lengths_ = HuffmanCompressor::buildCodeLengths(counts_, CanonicalHuffmanDecoder::MAX_CODE_LENGTH);
+        codes_ = HuffmanCompressor::buildCanonicalCodes(lengths_);
+        decoder_.build(lengths_.data(), lengths_.size());
+    }
+
+    std::vector<uint32_t> counts_;
+    uint64_t total_;
+    std::vector<uint8_t> lengths_;
+    std::vector<uint32_t> codes_;
+    CanonicalHuffmanDecoder decoder_;
+};
+
+// Segments start small so the code adapts quickly, then settle at the
+// interval.
+size_t segmentSize(size_t index, uint32_t interval) {
+    size_t size = HuffmanCompressor::MIN_REBUILD_INTERVAL;
+    for (size_t i = 0; i < index && size < interval; i++) {
+        size <<= 1;
+    }
+    return std::min<size_t>(size, interval);
+}
+
+// Appends the framed coding of data[0, size) to output and feeds it to the
+// model; coded is scratch space.
+void encodeSegment(AdaptiveHuffmanModel& model, const uint8_t* data, size_t size, std::vector<uint8_t>& coded,
+                   std::vector<uint8_t>& output) {
+    coded.clear();
+    model.encode(data, size, coded);
+    writeVarint(output, size);
+    writeVarint(output, coded.size());
+    output.insert(output.end(), coded.begin(), coded.end());
+    model.update(data, size);
+}
+
+// Every byte costs at least one bit and at most MAX_CODE_LENGTH.
+bool validSegment(uint64_t rawSize, uint64_t codedSize) {
+    return rawSize <= HuffmanCompressor::MAX_REBUILD_INTERVAL && rawSize <= codedSize * 8 &&
+           codedSize <= (rawSize * CanonicalHuffmanDecoder::MAX_CODE_LENGTH + 7) / 8;
+}
+
+bool readVarint(std::istream& input, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = input.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void writeU32LE(std::ofstream& output, uint32_t value) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(value & 0xFF),
+        static_cast<unsigned char>((value >> 8) & 0xFF),
+        static_cast<unsigned char>((value >> 16) & 0xFF),
+        static_cast<unsigned char>((value >> 24) & 0xFF)
+    };
+    output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+bool readU32LE(std::ifstream& input, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!input.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    value = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+}
 
 bool HuffmanCompressor::compress(const std::string& inputFile, const std::string& outputFile) {
     if (!fileExists(inputFile)) {
@@ -85,6 +381,642 @@ bool HuffmanCompressor::isValidHuffmanFile(const std::string& filename) {
     return true;
 }
 
+bool HuffmanCompressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+    output.clear();
+    if (input.empty()) {
+        return true;
+    }
+    
+    auto appendU32 = [&output](uint32_t value) {
+        unsigned char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        output.insert(output.end(), bytes, bytes + sizeof(value));
+    };
+    
+    FrequencyTable frequencies = buildFrequencyTable(input);
+    appendU32(static_cast<uint32_t>(input.size()));
+    
+    if (frequencies.size() == 1) {
+        output.push_back(input[0]);
+        return true;
+    }
+    
+    HuffmanTree root = buildHuffmanTree(frequencies);
+    CodeTable codeTable;
+    generateCodes(root, "", codeTable);
+    
+    std::vector<bool> serializedTree;
+    serializeTree(root, serializedTree);
+    appendU32(static_cast<uint32_t>(serializedTree.size()));
+    
+    unsigned char byte = 0;
+    int bitsInByte = 0;
+    auto putBit = [&](bool bit) {
+        byte = static_cast<unsigned char>((byte << 1) | (bit ? 1 : 0));
+        if (++bitsInByte == 8) {
+            output.push_back(byte);
+            byte = 0;
+            bitsInByte = 0;
+        }
+    };
+    auto flushBits = [&]() {
+        if (bitsInByte > 0) {
+            output.push_back(static_cast<unsigned char>(byte << (8 - bitsInByte)));
+            byte = 0;
+            bitsInByte = 0;
+        }
+    };
+    
+    for (bool bit : serializedTree) {
+        putBit(bit);
+    }
+    flushBits();
+    
+    uint64_t encodedBits = 0;
+    for (const auto& pair : frequencies) {
+        encodedBits += static_cast<uint64_t>(pair.second) * codeTable.at(pair.first).length();
+    }
+    if (encodedBits > UINT32_MAX) {
+        std::cerr << "Error: Huffman block is too large to encode.\n";
+        return false;
+    }
+    appendU32(static_cast<uint32_t>(encodedBits));
+    
+    output.reserve(output.size() + static_cast<size_t>((encodedBits + 7) / 8));
+    for (uint8_t ch : input) {
+        for (char bit : codeTable.at(ch)) {
+            putBit(bit == '1');
+        }
+    }
+    flushBits();
+    
+    return true;
+}
+
+bool HuffmanCompressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                        size_t maxSize) {
+    output.clear();
+    if (input.empty()) {
+        return true;
+    }
+    
+    size_t pos = 0;
+    auto readU32 = [&](uint32_t& value) {
+        if (pos + sizeof(value) > input.size()) {
+            return false;
+        }
+        std::memcpy(&value, input.data() + pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    };
+    
+    uint32_t originalSize;
+    if (!readU32(originalSize)) {
+        std::cerr << "Error: Truncated Huffman block header.\n";
+        return false;
+    }
+    if (originalSize > maxSize) {
+        std::cerr << "Error: Huffman block claims " << originalSize << " bytes, more than " << maxSize << ".\n";
+        return false;
+    }
+    
+    uint32_t treeSize;
+    if (!readU32(treeSize)) {
+        if (pos >= input.size()) {
+            return originalSize == 0;
+        }
+        output.assign(originalSize, input[pos]);
+        return true;
+    }
+    
+    size_t treeBytes = (static_cast<size_t>(treeSize) + 7) / 8;
+    if (pos + treeBytes > input.size()) {
+        std::cerr << "Error: Truncated Huffman tree.\n";
+        return false;
+    }
+    
+    std::vector<bool> serializedTree;
+    serializedTree.reserve(treeSize);
+    for (uint32_t i = 0; i < treeSize; i++) {
+        serializedTree.push_back((input[pos + i / 8] >> (7 - i % 8)) & 1);
+    }
+    pos += treeBytes;
+    
+    size_t index = 0;
+    HuffmanTree root = deserializeTree(serializedTree, index);
+    
+    uint32_t encodedBits;
+    if (!root || !readU32(encodedBits) || pos + (static_cast<size_t>(encodedBits) + 7) / 8 > input.size()) {
+        std::cerr << "Error: Corrupt Huffman block.\n";
+        return false;
+    }
+    
+    output.reserve(originalSize);
+    const uint8_t* data = input.data() + pos;
+    HuffmanNode* current = root.get();
+    for (uint32_t i = 0; i < encodedBits; i++) {
+        bool bit = (data[i / 8] >> (7 - i % 8)) & 1;
+        current = bit ? current->right.get() : current->left.get();
+        if (!current) {
+            std::cerr << "Error: Corrupt Huffman block.\n";
+            return false;
+        }
+        
+        if (current->isLeaf()) {
+            output.push_back(current->character);
+            current = root.get();
+        }
+    }
+    
+    return output.size() == originalSize;
+}
+
+bool HuffmanCompressor::compressOrder1(const std::string& inputFile, const std::string& outputFile) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    output.write(ORDER1_MAGIC, sizeof(ORDER1_MAGIC));
+    output.put(static_cast<char>(ORDER1_VERSION));
+
+    std::vector<uint8_t> chunk(ORDER1_CHUNK_SIZE);
+    std::vector<uint8_t> encoded;
+    while (true) {
+        input.read(reinterpret_cast<char*>(chunk.data()), chunk.size());
+        size_t bytesRead = static_cast<size_t>(input.gcount());
+        if (bytesRead == 0) {
+            break;
+        }
+
+        encoded.clear();
+        encodeOrder1(chunk.data(), bytesRead, encoded);
+        writeU32LE(output, static_cast<uint32_t>(bytesRead));
+        writeU32LE(output, static_cast<uint32_t>(encoded.size()));
+        output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    }
+
+    if (input.bad()) {
+        std::cerr << "Error: Failed reading input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    writeU32LE(output, 0);
+    writeU32LE(output, 0);
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Compression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Original size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Compressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool HuffmanCompressor::decompressOrder1(const std::string& inputFile, const std::string& outputFile) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    char header[sizeof(ORDER1_MAGIC)];
+    int version = 0;
+    if (input.read(header, sizeof(header))) {
+        version = input.get();
+    }
+    if (!input || std::memcmp(header, ORDER1_MAGIC, sizeof(ORDER1_MAGIC)) != 0 || version != ORDER1_VERSION) {
+        std::cerr << "Error: '" << inputFile << "' is not a valid order-1 Huffman file.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> chunk;
+    while (true) {
+        uint32_t rawSize, encodedSize;
+        if (!readU32LE(input, rawSize) || !readU32LE(input, encodedSize)) {
+            std::cerr << "Error: Truncated order-1 Huffman chunk header.\n";
+            return false;
+        }
+        if (rawSize == 0) {
+            break;
+        }
+        // Codes are at most TABLE_BITS long; the tables take under 1.2 KB.
+        if (rawSize > ORDER1_CHUNK_SIZE ||
+            encodedSize > static_cast<uint64_t>(rawSize) * CanonicalHuffmanDecoder::TABLE_BITS / 8 + 2048) {
+            std::cerr << "Error: Corrupt order-1 Huffman chunk header.\n";
+            return false;
+        }
+
+        payload.resize(encodedSize);
+        if (!input.read(reinterpret_cast<char*>(payload.data()), encodedSize)) {
+            std::cerr << "Error: Truncated order-1 Huffman chunk.\n";
+            return false;
+        }
+
+        chunk.resize(rawSize);
+        if (!decodeOrder1(payload.data(), payload.size(), chunk.data(), rawSize)) {
+            std::cerr << "Error: Corrupt order-1 Huffman data.\n";
+            return false;
+        }
+        output.write(reinterpret_cast<const char*>(chunk.data()), rawSize);
+    }
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Decompression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Compressed size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Decompressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool HuffmanCompressor::isValidOrder1File(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(ORDER1_MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, ORDER1_MAGIC, sizeof(ORDER1_MAGIC)) == 0;
+}
+
+bool HuffmanCompressor::compressOrder1Block(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+    output.clear();
+    writeVarint(output, input.size());
+    if (!input.empty()) {
+        encodeOrder1(input.data(), input.size(), output);
+    }
+    return true;
+}
+
+bool HuffmanCompressor::decompressOrder1Block(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                              size_t maxSize) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    uint64_t rawSize;
+    if (!readVarint(ip, end, rawSize) || rawSize > maxSize) {
+        return false;
+    }
+    output.clear();
+    if (rawSize == 0) {
+        return ip == end;
+    }
+    // Every byte costs at least one bit.
+    if (rawSize > static_cast<uint64_t>(end - ip) * 8) {
+        return false;
+    }
+
+    output.resize(static_cast<size_t>(rawSize));
+    return decodeOrder1(ip, static_cast<size_t>(end - ip), output.data(), output.size());
+}
+
+void HuffmanCompressor::encodeOrder1(const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+    ContextCounts counts(CONTEXTS * 256, 0);
+    uint8_t previous = 0;
+    for (size_t i = 0; i < size; i++) {
+        counts[previous * 256 + data[i]]++;
+        previous = data[i];
+    }
+
+    ContextClusters clusters = clusterContexts(counts, MAX_CONTEXT_TABLES);
+    std::vector<uint32_t> codes;
+    for (unsigned table = 0; table < clusters.tables; table++) {
+        std::vector<uint8_t> lengths(clusters.lengths.begin() + table * 256,
+                                     clusters.lengths.begin() + (table + 1) * 256);
+        std::vector<uint32_t> tableCodes = buildCanonicalCodes(lengths);
+        codes.insert(codes.end(), tableCodes.begin(), tableCodes.end());
+    }
+
+    output.reserve(output.size() + static_cast<size_t>((clusters.bits + 7) / 8));
+    BitBufferWriter writer(output);
+    writer.write(clusters.tables - 1, 3);
+    unsigned bits = mapBits(clusters.tables);
+    if (bits > 0) {
+        for (unsigned context = 0; context < CONTEXTS; context++) {
+            writer.write(clusters.map[context], bits);
+        }
+    }
+    for (uint8_t length : clusters.lengths) {
+        writer.write(length, 4);
+    }
+
+    // Row offsets into codes and lengths for each context's table.
+    unsigned rows[CONTEXTS];
+    for (unsigned context = 0; context < CONTEXTS; context++) {
+        rows[context] = clusters.map[context] * 256u;
+    }
+    previous = 0;
+    for (size_t i = 0; i < size; i++) {
+        unsigned index = rows[previous] + data[i];
+        writer.write(codes[index], clusters.lengths[index]);
+        previous = data[i];
+    }
+    writer.flush();
+}
+
+bool HuffmanCompressor::decodeOrder1(const uint8_t* input, size_t inputSize, uint8_t* output, size_t rawSize) {
+    BitBufferReader reader(input, inputSize);
+    unsigned tables = reader.read(3) + 1;
+    unsigned bits = mapBits(tables);
+    uint8_t map[CONTEXTS] = {};
+    for (unsigned context = 0; context < CONTEXTS && bits > 0; context++) {
+        map[context] = static_cast<uint8_t>(reader.read(bits));
+        if (map[context] >= tables) {
+            return false;
+        }
+    }
+
+    CanonicalHuffmanDecoder decoders[MAX_CONTEXT_TABLES];
+    uint8_t lengths[256];
+    for (unsigned table = 0; table < tables; table++) {
+        for (unsigned symbol = 0; symbol < 256; symbol++) {
+            lengths[symbol] = static_cast<uint8_t>(reader.read(4));
+            if (lengths[symbol] > CanonicalHuffmanDecoder::TABLE_BITS) {
+                return false;
+            }
+        }
+        if (!decoders[table].build(lengths, 256)) {
+            return false;
+        }
+    }
+
+    const CanonicalHuffmanDecoder* contextDecoders[CONTEXTS];
+    for (unsigned context = 0; context < CONTEXTS; context++) {
+        contextDecoders[context] = &decoders[map[context]];
+    }
+    uint8_t previous = 0;
+    for (size_t i = 0; i < rawSize; i++) {
+        int symbol = contextDecoders[previous]->decode(reader);
+        if (symbol < 0) {
+            return false;
+        }
+        previous = static_cast<uint8_t>(symbol);
+        output[i] = previous;
+    }
+    return !reader.overrun() && reader.bytesConsumed() == inputSize;
+}
+
+bool HuffmanCompressor::compressAdaptive(const std::string& inputFile, const std::string& outputFile,
+                                         uint32_t interval) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    if (!compressStream(input, output, interval)) {
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Compression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Original size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Compressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool HuffmanCompressor::decompressAdaptive(const std::string& inputFile, const std::string& outputFile) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    if (!decompressStream(input, output)) {
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Decompression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Compressed size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Decompressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool HuffmanCompressor::compressStream(std::istream& input, std::ostream& output, uint32_t interval) {
+    unsigned intervalBits = rebuildIntervalBits(interval);
+    interval = 1u << intervalBits;
+    output.write(ADAPTIVE_MAGIC, sizeof(ADAPTIVE_MAGIC));
+    output.put(static_cast<char>(ADAPTIVE_VERSION));
+    output.put(static_cast<char>(intervalBits));
+
+    AdaptiveHuffmanModel model;
+    std::vector<uint8_t> segment(interval);
+    std::vector<uint8_t> coded;
+    std::vector<uint8_t> framed;
+    for (size_t index = 0;; index++) {
+        size_t size = segmentSize(index, interval);
+        input.read(reinterpret_cast<char*>(segment.data()), size);
+        size_t bytesRead = static_cast<size_t>(input.gcount());
+        if (bytesRead > 0) {
+            framed.clear();
+            encodeSegment(model, segment.data(), bytesRead, coded, framed);
+            output.write(reinterpret_cast<const char*>(framed.data()), framed.size());
+            output.flush();
+        }
+        if (bytesRead < size) {
+            break;
+        }
+    }
+
+    if (input.bad()) {
+        std::cerr << "Error: Failed reading the input stream.\n";
+        return false;
+    }
+
+    output.put(0);
+    output.flush();
+    if (!output) {
+        std::cerr << "Error: Failed writing the output stream.\n";
+        return false;
+    }
+    return true;
+}
+
+bool HuffmanCompressor::decompressStream(std::istream& input, std::ostream& output) {
+    char header[sizeof(ADAPTIVE_MAGIC)];
+    int version = 0;
+    int intervalBits = 0;
+    if (input.read(header, sizeof(header))) {
+        version = input.get();
+        intervalBits = input.get();
+    }
+    if (!input || std::memcmp(header, ADAPTIVE_MAGIC, sizeof(ADAPTIVE_MAGIC)) != 0 || version != ADAPTIVE_VERSION ||
+        intervalBits < 0 || intervalBits > 31 || (1u << intervalBits) < MIN_REBUILD_INTERVAL ||
+        (1u << intervalBits) > MAX_REBUILD_INTERVAL) {
+        std::cerr << "Error: Input is not a valid adaptive Huffman stream.\n";
+        return false;
+    }
+    uint32_t interval = 1u << intervalBits;
+
+    AdaptiveHuffmanModel model;
+    std::vector<uint8_t> coded;
+    std::vector<uint8_t> segment;
+    while (true) {
+        uint64_t rawSize, codedSize;
+        if (!readVarint(input, rawSize)) {
+            std::cerr << "Error: Truncated adaptive Huffman stream.\n";
+            return false;
+        }
+        if (rawSize == 0) {
+            break;
+        }
+        if (!readVarint(input, codedSize) || rawSize > interval || !validSegment(rawSize, codedSize)) {
+            std::cerr << "Error: Corrupt adaptive Huffman segment header.\n";
+            return false;
+        }
+
+        coded.resize(static_cast<size_t>(codedSize));
+        if (!input.read(reinterpret_cast<char*>(coded.data()), static_cast<std::streamsize>(coded.size()))) {
+            std::cerr << "Error: Truncated adaptive Huffman segment.\n";
+            return false;
+        }
+
+        segment.resize(static_cast<size_t>(rawSize));
+        if (!model.decode(coded.data(), coded.size(), segment.data(), segment.size())) {
+            std::cerr << "Error: Corrupt adaptive Huffman data.\n";
+            return false;
+        }
+        output.write(reinterpret_cast<const char*>(segment.data()), static_cast<std::streamsize>(segment.size()));
+        output.flush();
+        model.update(segment.data(), segment.size());
+    }
+
+    if (!output) {
+        std::cerr << "Error: Failed writing the output stream.\n";
+        return false;
+    }
+    return true;
+}
+
+bool HuffmanCompressor::isValidAdaptiveFile(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(ADAPTIVE_MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, ADAPTIVE_MAGIC, sizeof(ADAPTIVE_MAGIC)) == 0;
+}
+
+bool HuffmanCompressor::compressAdaptiveBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                              uint32_t interval) {
+    interval = 1u << rebuildIntervalBits(interval);
+    output.clear();
+    AdaptiveHuffmanModel model;
+    std::vector<uint8_t> coded;
+    size_t pos = 0;
+    for (size_t index = 0; pos < input.size(); index++) {
+        size_t size = std::min(segmentSize(index, interval), input.size() - pos);
+        encodeSegment(model, input.data() + pos, size, coded, output);
+        pos += size;
+    }
+    output.push_back(0);
+    return true;
+}
+
+bool HuffmanCompressor::decompressAdaptiveBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                                size_t maxSize) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    AdaptiveHuffmanModel model;
+    output.clear();
+    while (true) {
+        uint64_t rawSize, codedSize;
+        if (!readVarint(ip, end, rawSize)) {
+            return false;
+        }
+        if (rawSize == 0) {
+            return ip == end;
+        }
+        if (!readVarint(ip, end, codedSize) || !validSegment(rawSize, codedSize) ||
+            codedSize > static_cast<uint64_t>(end - ip) || rawSize > maxSize - output.size()) {
+            return false;
+        }
+
+        size_t start = output.size();
+        output.resize(start + static_cast<size_t>(rawSize));
+        if (!model.decode(ip, static_cast<size_t>(codedSize), output.data() + start, static_cast<size_t>(rawSize))) {
+            return false;
+        }
+        model.update(output.data() + start, static_cast<size_t>(rawSize));
+        ip += codedSize;
+    }
+}
+
+unsigned HuffmanCompressor::rebuildIntervalBits(uint32_t interval) {
+    unsigned bits = 0;
+    while ((1u << bits) < MIN_REBUILD_INTERVAL ||
+           ((1u << bits) < interval && (1u << bits) < MAX_REBUILD_INTERVAL)) {
+        bits++;
+    }
+    return bits;
+}
+
+HuffmanCompressor::FrequencyTable HuffmanCompressor::buildFrequencyTable(const std::vector<uint8_t>& data) {
+    FrequencyTable frequencies;
+    for (uint8_t ch : data) {
+        frequencies[ch]++;
+    }
+    return frequencies;
+}
+
 HuffmanCompressor::FrequencyTable HuffmanCompressor::buildFrequencyTable(const std::string& filename) {
     FrequencyTable frequencies;
     std::ifstream file(filename, std::ios::binary);
@@ -316,4 +1248,190 @@ size_t HuffmanCompressor::getFileSize(const std::string& filename) {
     } catch (const std::filesystem::filesystem_error&) {
         return 0;
     }
-}
\ No newline at end of file
+}
+
+std::vector<uint8_t> HuffmanCompressor::buildCodeLengths(const std::vector<uint32_t>& frequencies,
+                                                         unsigned maxLength) {
+    std::vector<uint8_t> lengths(frequencies.size(), 0);
+
+    std::vector<uint32_t> symbols;
+    for (uint32_t symbol = 0; symbol < frequencies.size(); symbol++) {
+        if (frequencies[symbol] > 0) {
+            symbols.push_back(symbol);
+        }
+    }
+    if (symbols.empty()) {
+        return lengths;
+    }
+    if (symbols.size() == 1) {
+        lengths[symbols[0]] = 1;
+        return lengths;
+    }
+
+    std::sort(symbols.begin(), symbols.end(), [&](uint32_t a, uint32_t b) {
+        return frequencies[a] != frequencies[b] ? frequencies[a] < frequencies[b] : a < b;
+    });
+
+    // Leaves sorted by weight come first; merged nodes are created in
+    // non-decreasing weight order, so the two lightest nodes are always at
+    // the front of one of the two runs.
+    const size_t leafCount = symbols.size();
+    std::vector<uint64_t> weight(2 * leafCount - 1);
+    std::vector<size_t> parent(2 * leafCount - 1);
+    for (size_t i = 0; i < leafCount; i++) {
+        weight[i] = frequencies[symbols[i]];
+    }
+    size_t nextLeaf = 0;
+    size_t nextMerged = leafCount;
+    auto takeLightest = [&](size_t created) {
+        if (nextLeaf < leafCount && (nextMerged == created || weight[nextLeaf] <= weight[nextMerged])) {
+            return nextLeaf++;
+        }
+        return nextMerged++;
+    };
+    for (size_t node = leafCount; node < weight.size(); node++) {
+        size_t first = takeLightest(node);
+        size_t second = takeLightest(node);
+        weight[node] = weight[first] + weight[second];
+        parent[first] = node;
+        parent[second] = node;
+    }
+
+    std::vector<unsigned> depth(weight.size(), 0);
+    for (size_t node = weight.size() - 1; node-- > 0;) {
+        depth[node] = depth[parent[node]] + 1;
+    }
+
+    // Clamp overlong codes, then pay back the excess Kraft sum by
+    // lengthening the rarest of the longest codes that can still grow.
+    const uint64_t capacity = static_cast<uint64_t>(1) << maxLength;
+    uint64_t kraft = 0;
+    for (size_t i = 0; i < leafCount; i++) {
+        depth[i] = std::min(depth[i], maxLength);
+        kraft += capacity >> depth[i];
+    }
+    while (kraft > capacity) {
+        size_t chosen = leafCount;
+        for (unsigned length = maxLength - 1; length > 0 && chosen == leafCount; length--) {
+            for (size_t i = 0; i < leafCount; i++) {
+                if (depth[i] == length) {
+                    chosen = i;
+                    break;
+                }
+            }
+        }
+        if (chosen == leafCount) {
+            break;
+        }
+        kraft -= capacity >> (depth[chosen] + 1);
+        depth[chosen]++;
+    }
+
+    for (size_t i = 0; i < leafCount; i++) {
+        lengths[symbols[i]] = static_cast<uint8_t>(depth[i]);
+    }
+    return lengths;
+}
+
+std::vector<uint32_t> HuffmanCompressor::buildCanonicalCodes(const std::vector<uint8_t>& lengths) {
+    unsigned maxLength = 0;
+    for (uint8_t length : lengths) {
+        maxLength = std::max<unsigned>(maxLength, length);
+    }
+
+    std::vector<uint32_t> lengthCounts(maxLength + 1, 0);
+    for (uint8_t length : lengths) {
+        lengthCounts[length]++;
+    }
+    lengthCounts[0] = 0;
+
+    std::vector<uint32_t> nextCode(maxLength + 1, 0);
+    uint32_t code = 0;
+    for (unsigned length = 1; length <= maxLength; length++) {
+        code = (code + lengthCounts[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+
+    std::vector<uint32_t> codes(lengths.size(), 0);
+    for (size_t symbol = 0; symbol < lengths.size(); symbol++) {
+        unsigned length = lengths[symbol];
+        if (length == 0) {
+            continue;
+        }
+        uint32_t value = nextCode[length]++;
+        uint32_t reversed = 0;
+        for (unsigned bit = 0; bit < length; bit++) {
+            reversed = (reversed << 1) | ((value >> bit) & 1);
+        }
+        codes[symbol] = reversed;
+    }
+    return codes;
+}
+
+bool CanonicalHuffmanDecoder::build(const uint8_t* lengths, size_t count) {
+    std::fill(std::begin(counts_), std::end(counts_), 0);
+    for (size_t symbol = 0; symbol < count; symbol++) {
+        if (lengths[symbol] > MAX_CODE_LENGTH) {
+            return false;
+        }
+        counts_[lengths[symbol]]++;
+    }
+    counts_[0] = 0;
+
+    // Each length may use at most what the shorter ones left over.
+    int32_t left = 1;
+    for (unsigned length = 1; length <= MAX_CODE_LENGTH; length++) {
+        left = (left << 1) - counts_[length];
+        if (left < 0) {
+            return false;
+        }
+    }
+
+    uint16_t offsets[MAX_CODE_LENGTH + 2];
+    offsets[1] = 0;
+    for (unsigned length = 1; length <= MAX_CODE_LENGTH; length++) {
+        offsets[length + 1] = static_cast<uint16_t>(offsets[length] + counts_[length]);
+    }
+    symbols_.assign(offsets[MAX_CODE_LENGTH + 1], 0);
+    for (size_t symbol = 0; symbol < count; symbol++) {
+        if (lengths[symbol] != 0) {
+            symbols_[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+        }
+    }
+
+    table_.assign(static_cast<size_t>(1) << TABLE_BITS, 0);
+    std::vector<uint8_t> codeLengths(lengths, lengths + count);
+    std::vector<uint32_t> codes = HuffmanCompressor::buildCanonicalCodes(codeLengths);
+    for (size_t symbol = 0; symbol < count; symbol++) {
+        unsigned length = lengths[symbol];
+        if (length == 0 || length > TABLE_BITS) {
+            continue;
+        }
+        uint16_t entry = static_cast<uint16_t>((symbol << 4) | length);
+        for (uint32_t index = codes[symbol]; index < table_.size(); index += 1u << length) {
+            table_[index] = entry;
+        }
+    }
+    return true;
+}
+
+int CanonicalHuffmanDecoder::decodeSlow(BitBufferReader& reader) const {
+    // Canonical codes of one length are consecutive, so walk the lengths
+    // keeping the first code of each and the index of its first symbol.
+    uint32_t bits = reader.peek(MAX_CODE_LENGTH);
+    int32_t code = 0;
+    int32_t first = 0;
+    int32_t index = 0;
+    for (unsigned length = 1; length <= MAX_CODE_LENGTH; length++) {
+        code |= (bits >> (length - 1)) & 1;
+        int32_t count = counts_[length];
+        if (code - first < count) {
+            reader.consume(length);
+            return symbols_[index + code - first];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
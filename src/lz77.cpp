@@ -0,0 +1,944 @@
+#include "lz77.h"
+#include "bit_buffer.h"
+#include "suffix_array.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+inline uint32_t load32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t ceilLog2(size_t value) {
+    uint32_t log = 0;
+    while ((static_cast<size_t>(1) << log) < value) {
+        log++;
+    }
+    return log;
+}
+
+// Length of the common prefix of a and b, compared 8 bytes at a time.
+size_t commonLength(const uint8_t* a, const uint8_t* b, size_t limit) {
+    size_t length = 0;
+    while (length + 8 <= limit && load64(a + length) == load64(b + length)) {
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) {
+        length++;
+    }
+    return length;
+}
+
+struct Match {
+    uint32_t length;
+    uint32_t offset;
+};
+
+enum class Strategy { LAZY, OPTIMAL };
+
+struct LevelSettings {
+    Strategy strategy;
+    LZ77MatchFinder finder;
+    // Positions looked ahead for a better match; 0 parses greedily.
+    uint32_t lazySteps;
+    uint32_t chainDepth;
+    // A match this long ends the search, and the optimal parser takes it
+    // without pricing alternatives.
+    uint32_t niceLength;
+};
+
+const uint32_t UNLIMITED = UINT32_MAX;
+
+const LevelSettings LEVELS[] = {
+    {Strategy::LAZY, LZ77MatchFinder::HASH_CHAIN, 0, 4, UNLIMITED},
+    {Strategy::LAZY, LZ77MatchFinder::HASH_CHAIN, 0, 16, UNLIMITED},
+    {Strategy::LAZY, LZ77MatchFinder::HASH_CHAIN, 0, 32, UNLIMITED},
+    {Strategy::LAZY, LZ77MatchFinder::HASH_CHAIN, 1, 32, UNLIMITED},
+    {Strategy::LAZY, LZ77MatchFinder::HASH_CHAIN, 1, 64, UNLIMITED},
+    {Strategy::LAZY, LZ77MatchFinder::HASH_CHAIN, 2, 64, UNLIMITED},
+    {Strategy::LAZY, LZ77MatchFinder::HASH_CHAIN, 2, 256, UNLIMITED},
+    {Strategy::OPTIMAL, LZ77MatchFinder::BINARY_TREE, 0, 64, 128},
+    {Strategy::OPTIMAL, LZ77MatchFinder::BINARY_TREE, 0, 256, 256},
+};
+
+const LevelSettings& levelSettings(uint32_t level) {
+    level = std::min(std::max(level, LZ77Compressor::MIN_LEVEL), LZ77Compressor::MAX_LEVEL);
+    return LEVELS[level - LZ77Compressor::MIN_LEVEL];
+}
+
+// A minimum-length match is only worth it with a short offset.
+bool worthMatching(size_t length, size_t offset) {
+    return length > LZ77Compressor::MIN_MATCH || offset < (1u << 14);
+}
+
+uint32_t floorLog2(uint32_t value) {
+    uint32_t log = 0;
+    while (value >>= 1) {
+        log++;
+    }
+    return log;
+}
+
+// Hash chains over 4-byte prefixes, sized for what one parse call can see
+// so small blocks do not pay for a large window. Every position from the
+// history start on goes through exactly one of find() or skip(), in order.
+class HashChainMatchFinder {
+public:
+    HashChainMatchFinder(const uint8_t* data, size_t historyStart, size_t end, size_t window, uint32_t depth,
+                         uint32_t niceLength)
+        : data_(data), end_(end), window_(window), depth_(std::max<uint32_t>(depth, 1)), niceLength_(niceLength) {
+        size_t chainSize =
+            static_cast<size_t>(1) << ceilLog2(std::min(window, std::max<size_t>(end - historyStart, 1)));
+        chainMask_ = chainSize - 1;
+        hashBits_ = std::min<uint32_t>(18, std::max<uint32_t>(10, ceilLog2(chainSize) - 3));
+        head_.assign(static_cast<size_t>(1) << hashBits_, -1);
+        chain_.resize(chainSize);
+    }
+
+    // Collects the candidates at position that are longer than every
+    // closer one, so lengths increase and offsets grow with them, then
+    // indexes position. Needs MIN_MATCH bytes left.
+    void find(size_t position, std::vector<Match>& matches) {
+        matches.clear();
+        const size_t limit = end_ - position;
+        size_t bestLength = LZ77Compressor::MIN_MATCH - 1;
+
+        int32_t candidate = head_[hashAt(position)];
+        for (uint32_t tried = 0; tried < depth_ && candidate >= 0; tried++) {
+            size_t match = static_cast<size_t>(candidate);
+            size_t offset = position - match;
+            if (offset >= window_) {
+                break;
+            }
+            // Only a candidate that extends past the current best can win.
+            if (data_[match + bestLength] == data_[position + bestLength]) {
+                size_t length = commonLength(data_ + match, data_ + position, limit);
+                if (length > bestLength && worthMatching(length, offset)) {
+                    bestLength = length;
+                    matches.push_back({static_cast<uint32_t>(length), static_cast<uint32_t>(offset)});
+                    if (length == limit || length >= niceLength_) {
+                        break;
+                    }
+                }
+            }
+            candidate = chain_[match & chainMask_];
+        }
+
+        insert(position);
+    }
+
+    void skip(size_t position) {
+        if (position + LZ77Compressor::MIN_MATCH <= end_) {
+            insert(position);
+        }
+    }
+
+private:
+    uint32_t hashAt(size_t position) const {
+        return (load32(data_ + position) * 2654435761u) >> (32 - hashBits_);
+    }
+
+    void insert(size_t position) {
+        uint32_t hash = hashAt(position);
+        chain_[position & chainMask_] = head_[hash];
+        head_[hash] = static_cast<int32_t>(position);
+    }
+
+    const uint8_t* data_;
+    size_t end_;
+    size_t window_;
+    uint32_t depth_;
+    uint32_t niceLength_;
+    size_t chainMask_;
+    uint32_t hashBits_;
+    std::vector<int32_t> head_;
+    std::vector<int32_t> chain_;
+};
+
+// Binary trees over 4-byte hash buckets (bt4). Each bucket keeps its
+// positions in a tree ordered by the suffix that follows them, rebuilt
+// around the newest position on every insertion, so a search descends
+// towards the longest matches instead of walking every candidate. The
+// depth bounds the nodes visited, which keeps repetitive data from
+// degrading the way long hash chains do.
+class BinaryTreeMatchFinder {
+public:
+    BinaryTreeMatchFinder(const uint8_t* data, size_t historyStart, size_t end, size_t window, uint32_t depth,
+                          uint32_t niceLength)
+        : data_(data), end_(end), window_(window), depth_(std::max<uint32_t>(depth, 1)),
+          treeLength_(std::min(niceLength, MAX_TREE_LENGTH)) {
+        size_t cyclicSize =
+            static_cast<size_t>(1) << ceilLog2(std::min(window, std::max<size_t>(end - historyStart, 1)));
+        cyclicMask_ = cyclicSize - 1;
+        hashBits_ = std::min<uint32_t>(20, std::max<uint32_t>(10, ceilLog2(cyclicSize) - 2));
+        head_.assign(static_cast<size_t>(1) << hashBits_, -1);
+        children_.resize(2 * cyclicSize);
+    }
+
+    void find(size_t position, std::vector<Match>& matches) {
+        matches.clear();
+        update(position, &matches);
+        // The tree only orders suffixes by their first treeLength_ bytes;
+        // a match that long is extended here.
+        if (!matches.empty() && matches.back().length == treeLength_) {
+            Match& longest = matches.back();
+            longest.length += static_cast<uint32_t>(commonLength(data_ + position - longest.offset + treeLength_,
+                                                                 data_ + position + treeLength_,
+                                                                 end_ - position - treeLength_));
+        }
+    }
+
+    // Inside a long match every position would repeat the tree walk of
+    // the one before it, so after a full-length match the next half tree
+    // length of skipped positions stays out of the tree; the earlier copy
+    // they match already covers them.
+    void skip(size_t position) {
+        if (position + LZ77Compressor::MIN_MATCH <= end_ && position >= skipUntil_) {
+            update(position, nullptr);
+        }
+    }
+
+private:
+    // Longer compares would make every insertion on repetitive data cost
+    // as much as the match it sits in.
+    static constexpr uint32_t MAX_TREE_LENGTH = 273;
+
+    // Inserts position as the root of its bucket's tree, splitting the old
+    // tree into the suffixes below and above it. Visited nodes that beat
+    // every closer one are reported when matches is given.
+    void update(size_t position, std::vector<Match>* matches) {
+        const size_t limit = std::min<size_t>(end_ - position, treeLength_);
+        uint32_t hash = (load32(data_ + position) * 2654435761u) >> (32 - hashBits_);
+        int32_t candidate = head_[hash];
+        head_[hash] = static_cast<int32_t>(position);
+
+        // Where the next smaller and larger subtrees get attached.
+        int32_t* smaller = &children_[2 * (position & cyclicMask_)];
+        int32_t* larger = smaller + 1;
+        size_t smallerLength = 0;
+        size_t largerLength = 0;
+        size_t bestLength = LZ77Compressor::MIN_MATCH - 1;
+
+        for (uint32_t visited = 0;; visited++) {
+            if (candidate < 0 || visited == depth_ || position - static_cast<size_t>(candidate) >= window_) {
+                *smaller = -1;
+                *larger = -1;
+                return;
+            }
+            const size_t match = static_cast<size_t>(candidate);
+            int32_t* pair = &children_[2 * (match & cyclicMask_)];
+            // Everything in this subtree shares the shorter of the two
+            // bounding prefixes with position.
+            size_t known = std::min(smallerLength, largerLength);
+            size_t length = known + commonLength(data_ + match + known, data_ + position + known, limit - known);
+
+            if (matches && length > bestLength && worthMatching(length, position - match)) {
+                bestLength = length;
+                matches->push_back({static_cast<uint32_t>(length), static_cast<uint32_t>(position - match)});
+            }
+            if (length == limit) {
+                // Position replaces an equal node and inherits its subtrees.
+                *smaller = pair[0];
+                *larger = pair[1];
+                if (length == treeLength_) {
+                    skipUntil_ = position + treeLength_ / 2;
+                }
+                return;
+            }
+            if (data_[match + length] < data_[position + length]) {
+                *smaller = candidate;
+                smaller = pair + 1;
+                candidate = *smaller;
+                smallerLength = length;
+            } else {
+                *larger = candidate;
+                larger = pair;
+                candidate = *larger;
+                largerLength = length;
+            }
+        }
+    }
+
+    const uint8_t* data_;
+    size_t end_;
+    size_t window_;
+    uint32_t depth_;
+    uint32_t treeLength_;
+    size_t skipUntil_ = 0;
+    size_t cyclicMask_;
+    uint32_t hashBits_;
+    std::vector<int32_t> head_;
+    // Left (smaller) and right (larger) child of each position in the window.
+    std::vector<int32_t> children_;
+};
+
+// Sorts every suffix of the visible data once, for whole-block parsing at
+// the top level. The longest earlier matches of a position are its nearest
+// neighbours in suffix order, with the common prefix the minimum LCP on
+// the way. At most depth neighbours are examined on each side, so the time
+// per position is bounded however repetitive the data.
+class SuffixArrayMatchFinder {
+public:
+    SuffixArrayMatchFinder(const uint8_t* data, size_t historyStart, size_t end, size_t window, uint32_t depth,
+                           uint32_t niceLength)
+        : base_(historyStart), window_(window), depth_(std::max<uint32_t>(depth, 1)), niceLength_(niceLength) {
+        sa_ = SuffixArray::build(data + historyStart, end - historyStart);
+        rank_ = SuffixArray::inverse(sa_);
+        lcp_ = SuffixArray::buildLcp(data + historyStart, sa_, rank_);
+    }
+
+    void find(size_t position, std::vector<Match>& matches) {
+        matches.clear();
+        candidates_.clear();
+        const size_t rank = static_cast<size_t>(rank_[position - base_]);
+        scan(position, rank, -1);
+        scan(position, rank, 1);
+
+        // Keep the candidates that are longer than every closer one.
+        std::sort(candidates_.begin(), candidates_.end(),
+                  [](const Match& a, const Match& b) { return a.offset < b.offset; });
+        uint32_t bestLength = LZ77Compressor::MIN_MATCH - 1;
+        for (const Match& candidate : candidates_) {
+            if (candidate.length > bestLength && worthMatching(candidate.length, candidate.offset)) {
+                bestLength = candidate.length;
+                matches.push_back(candidate);
+            }
+        }
+    }
+
+    // The suffix order already covers every position.
+    void skip(size_t) {}
+
+private:
+    void scan(size_t position, size_t rank, int direction) {
+        size_t length = SIZE_MAX;
+        size_t index = rank;
+        for (uint32_t visited = 0; visited < depth_; visited++) {
+            if (direction < 0) {
+                if (index == 0) {
+                    return;
+                }
+                length = std::min(length, static_cast<size_t>(lcp_[index]));
+                index--;
+            } else {
+                if (index + 1 == sa_.size()) {
+                    return;
+                }
+                index++;
+                length = std::min(length, static_cast<size_t>(lcp_[index]));
+            }
+            if (length < LZ77Compressor::MIN_MATCH) {
+                return;
+            }
+            const size_t candidate = base_ + static_cast<size_t>(sa_[index]);
+            if (candidate < position && position - candidate < window_) {
+                candidates_.push_back({static_cast<uint32_t>(length), static_cast<uint32_t>(position - candidate)});
+                if (length >= niceLength_) {
+                    return;
+                }
+            }
+        }
+    }
+
+    size_t base_;
+    size_t window_;
+    uint32_t depth_;
+    uint32_t niceLength_;
+    std::vector<int32_t> sa_;
+    std::vector<int32_t> rank_;
+    std::vector<int32_t> lcp_;
+    std::vector<Match> candidates_;
+};
+
+// Greedy and lazy matching: after finding a match, look up to lazySteps
+// positions ahead and defer to a later match when it is worth more than
+// the literal it costs. Lengths are worth 4 points per byte against the
+// log2 of the offset, so a slightly longer but much farther match loses.
+template <typename Finder>
+void parseLazy(size_t start, size_t end, Finder& finder, uint32_t lazySteps,
+               std::vector<LZ77Sequence>& sequences) {
+    const size_t minMatch = LZ77Compressor::MIN_MATCH;
+    std::vector<Match> matches;
+    size_t indexed = start;
+    auto longestAt = [&](size_t position) {
+        finder.find(position, matches);
+        indexed = position + 1;
+        return matches.empty() ? Match{0, 0} : matches.back();
+    };
+    auto gain = [](const Match& match) {
+        return static_cast<int64_t>(match.length) * 4 - floorLog2(match.offset);
+    };
+
+    size_t position = start;
+    size_t anchor = start;
+    while (position + minMatch <= end) {
+        Match best = longestAt(position);
+        if (best.length < minMatch) {
+            position++;
+            continue;
+        }
+
+        for (uint32_t step = 1; step <= lazySteps && position + 1 + minMatch <= end; step++) {
+            Match next = longestAt(position + 1);
+            if (next.length < minMatch || gain(next) <= gain(best) + (step == 1 ? 4 : 7)) {
+                break;
+            }
+            position++;
+            best = next;
+        }
+
+        sequences.push_back({static_cast<uint32_t>(position - anchor), best.length, best.offset});
+        position += best.length;
+        for (; indexed < position; indexed++) {
+            finder.skip(indexed);
+        }
+        anchor = position;
+    }
+
+    if (anchor < end) {
+        sequences.push_back({static_cast<uint32_t>(end - anchor), 0, 0});
+    }
+}
+
+// Price-based parsing: a shortest-path search over segments of up to
+// OPTIMAL_SPAN positions, where every literal and every length of every
+// candidate match is an edge weighted by the cost model. The model sees the
+// committed segment before the next one is priced.
+template <typename Finder>
+void parseOptimal(const uint8_t* data, size_t start, size_t end, Finder& finder, uint32_t niceLength,
+                  LZ77CostModel& costs, std::vector<LZ77Sequence>& sequences) {
+    const size_t OPTIMAL_SPAN = 4096;
+    const uint32_t INFINITE_COST = UINT32_MAX;
+    const size_t minMatch = LZ77Compressor::MIN_MATCH;
+
+    // How the cheapest known path reaches each position of the segment;
+    // length 0 means by a literal.
+    struct Node {
+        uint32_t cost;
+        uint32_t length;
+        uint32_t offset;
+    };
+    std::vector<Node> nodes(OPTIMAL_SPAN + niceLength + 1);
+    std::vector<Match> matches;
+    std::vector<Match> path;
+    uint32_t literalRun = 0;
+
+    size_t position = start;
+    while (position < end) {
+        const size_t reach = std::min(end - position, OPTIMAL_SPAN + niceLength);
+        const size_t span = std::min(end - position, OPTIMAL_SPAN);
+        nodes[0] = {0, 0, 0};
+        for (size_t i = 1; i <= reach; i++) {
+            nodes[i].cost = INFINITE_COST;
+        }
+        auto relax = [&](size_t target, uint32_t cost, uint32_t length, uint32_t offset) {
+            if (cost < nodes[target].cost) {
+                nodes[target] = {cost, length, offset};
+            }
+        };
+
+        Match forced = {0, 0};
+        size_t cut = 0;
+        for (; cut < span; cut++) {
+            const size_t current = position + cut;
+            const uint32_t base = nodes[cut].cost;
+            relax(cut + 1, base + costs.literalCost(data[current]), 0, 0);
+            if (current + minMatch > end) {
+                continue;
+            }
+
+            finder.find(current, matches);
+            if (!matches.empty() && matches.back().length >= niceLength) {
+                forced = matches.back();
+                break;
+            }
+            uint32_t length = minMatch;
+            for (const Match& match : matches) {
+                const uint32_t offsetCost = costs.offsetCost(match.offset);
+                for (; length <= match.length; length++) {
+                    relax(cut + length, base + offsetCost + costs.lengthCost(length), length, match.offset);
+                }
+            }
+        }
+
+        path.clear();
+        for (size_t i = cut; i > 0;) {
+            const Node& node = nodes[i];
+            path.push_back({node.length, node.offset});
+            i -= node.length > 0 ? node.length : 1;
+        }
+        std::reverse(path.begin(), path.end());
+        if (forced.length > 0) {
+            path.push_back(forced);
+        }
+
+        for (const Match& step : path) {
+            if (step.length == 0) {
+                costs.observeLiteral(data[position]);
+                literalRun++;
+                position++;
+            } else {
+                costs.observeMatch(step.length, step.offset);
+                sequences.push_back({literalRun, step.length, step.offset});
+                literalRun = 0;
+                position += step.length;
+            }
+        }
+        // Only the start of a forced match went through the finder.
+        if (forced.length > 0) {
+            for (size_t skipped = position - forced.length + 1; skipped < position; skipped++) {
+                finder.skip(skipped);
+            }
+        }
+        costs.refresh();
+    }
+
+    if (literalRun > 0) {
+        sequences.push_back({literalRun, 0, 0});
+    }
+}
+
+void writeLength(std::vector<uint8_t>& output, size_t extra) {
+    while (extra >= 255) {
+        output.push_back(255);
+        extra -= 255;
+    }
+    output.push_back(static_cast<uint8_t>(extra));
+}
+
+bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (ip == end) {
+            return false;
+        }
+        byte = *ip++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+}
+
+uint32_t LZ77CostModel::literalCost(uint8_t) const {
+    return 8 * SCALE;
+}
+
+uint32_t LZ77CostModel::lengthCost(uint32_t length) const {
+    // The token byte, plus 255-run bytes once the nibble overflows.
+    uint32_t extra = length - LZ77Compressor::MIN_MATCH;
+    uint32_t bytes = 1 + (extra >= 15 ? 1 + (extra - 15) / 255 : 0);
+    return bytes * 8 * SCALE;
+}
+
+uint32_t LZ77CostModel::offsetCost(uint32_t offset) const {
+    uint32_t bytes = 1;
+    while (offset >= 0x80) {
+        offset >>= 7;
+        bytes++;
+    }
+    return bytes * 8 * SCALE;
+}
+
+bool LZ77Compressor::compress(const std::string& inputFile, const std::string& outputFile,
+                              const LZ77Params& params) {
+    return compressStream(inputFile, outputFile, MAGIC, params,
+                          [](const uint8_t* data, size_t start, size_t end, const LZ77Params& effective,
+                             std::vector<uint8_t>& encoded) {
+                              std::vector<LZ77Sequence> sequences;
+                              parse(data, start, end, effective, sequences);
+                              encodeSequences(data, start, sequences, encoded);
+                          });
+}
+
+bool LZ77Compressor::decompress(const std::string& inputFile, const std::string& outputFile) {
+    return decompressStream(inputFile, outputFile, MAGIC, "LZ77", decodeSequences);
+}
+
+bool LZ77Compressor::compressStream(const std::string& inputFile, const std::string& outputFile,
+                                    const char magic[4], const LZ77Params& params, const ChunkEncoder& encode) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    LZ77Params effective = params;
+    effective.windowSize = normalizedWindow(params.windowSize);
+
+    output.write(magic, sizeof(MAGIC));
+    output.put(static_cast<char>(FORMAT_VERSION));
+    output.put(static_cast<char>(ceilLog2(effective.windowSize)));
+
+    // The buffer holds up to one window of history followed by the chunk
+    // being parsed. Chunks are at least a window long so re-indexing the
+    // history costs no more than the chunk itself.
+    const size_t chunkSize = std::max<size_t>(CHUNK_SIZE, effective.windowSize);
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> encoded;
+
+    while (true) {
+        size_t historySize = buffer.size();
+        buffer.resize(historySize + chunkSize);
+        input.read(reinterpret_cast<char*>(buffer.data() + historySize), chunkSize);
+        size_t bytesRead = static_cast<size_t>(input.gcount());
+        buffer.resize(historySize + bytesRead);
+        if (bytesRead == 0) {
+            break;
+        }
+
+        encoded.clear();
+        encode(buffer.data(), historySize, buffer.size(), effective, encoded);
+
+        writeU32(output, static_cast<uint32_t>(bytesRead));
+        writeU32(output, static_cast<uint32_t>(encoded.size()));
+        output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+
+        if (buffer.size() > effective.windowSize) {
+            buffer.erase(buffer.begin(), buffer.end() - effective.windowSize);
+        }
+    }
+
+    if (input.bad()) {
+        std::cerr << "Error: Failed reading input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    writeU32(output, 0);
+    writeU32(output, 0);
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Compression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Original size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Compressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool LZ77Compressor::decompressStream(const std::string& inputFile, const std::string& outputFile,
+                                      const char magic[4], const std::string& formatName,
+                                      const ChunkDecoder& decode) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    char header[sizeof(MAGIC)];
+    int version = 0;
+    int windowLog = 0;
+    if (input.read(header, sizeof(header))) {
+        version = input.get();
+        windowLog = input.get();
+    }
+    if (!input || std::memcmp(header, magic, sizeof(MAGIC)) != 0 || version != FORMAT_VERSION ||
+        windowLog < static_cast<int>(ceilLog2(MIN_WINDOW)) || windowLog > static_cast<int>(ceilLog2(MAX_WINDOW))) {
+        std::cerr << "Error: '" << inputFile << "' is not a valid " << formatName << " file.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    const size_t window = static_cast<size_t>(1) << windowLog;
+    const size_t maxChunk = std::max<size_t>(CHUNK_SIZE, window);
+    std::vector<uint8_t> buffer;
+    std::vector<uint8_t> payload;
+
+    while (true) {
+        uint32_t rawSize, encodedSize;
+        if (!readU32(input, rawSize) || !readU32(input, encodedSize)) {
+            std::cerr << "Error: Truncated " << formatName << " chunk header.\n";
+            return false;
+        }
+        if (rawSize == 0) {
+            break;
+        }
+        if (rawSize > maxChunk || encodedSize > 2 * static_cast<size_t>(rawSize) + 64) {
+            std::cerr << "Error: Corrupt " << formatName << " chunk header.\n";
+            return false;
+        }
+
+        payload.resize(encodedSize);
+        if (!input.read(reinterpret_cast<char*>(payload.data()), encodedSize)) {
+            std::cerr << "Error: Truncated " << formatName << " chunk.\n";
+            return false;
+        }
+
+        size_t historySize = buffer.size();
+        buffer.resize(historySize + rawSize + COPY_SLACK);
+        if (!decode(payload.data(), payload.size(), buffer.data(), historySize, rawSize)) {
+            std::cerr << "Error: Corrupt " << formatName << " data.\n";
+            return false;
+        }
+        buffer.resize(historySize + rawSize);
+        output.write(reinterpret_cast<const char*>(buffer.data() + historySize), rawSize);
+
+        if (buffer.size() > window) {
+            buffer.erase(buffer.begin(), buffer.end() - window);
+        }
+    }
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Decompression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Compressed size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Decompressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool LZ77Compressor::isValidLZ77File(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool LZ77Compressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                   const LZ77Params& params, size_t historySize) {
+    std::vector<LZ77Sequence> sequences;
+    parse(input.data(), historySize, input.size(), params, sequences);
+
+    output.clear();
+    writeVarint(output, input.size() - historySize);
+    encodeSequences(input.data(), historySize, sequences, output);
+    return true;
+}
+
+bool LZ77Compressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                     size_t maxSize, size_t historySize) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    uint64_t rawSize;
+    // A sequence cannot expand more than 255 output bytes per input byte.
+    if (!readVarint(ip, end, rawSize) || rawSize > maxSize ||
+        rawSize > static_cast<uint64_t>(input.size()) * 255 + 64) {
+        return false;
+    }
+
+    output.resize(historySize + static_cast<size_t>(rawSize) + COPY_SLACK);
+    if (!decodeSequences(ip, static_cast<size_t>(end - ip), output.data(), historySize,
+                         static_cast<size_t>(rawSize))) {
+        return false;
+    }
+    output.resize(historySize + static_cast<size_t>(rawSize));
+    return true;
+}
+
+void LZ77Compressor::parse(const uint8_t* data, size_t start, size_t end, const LZ77Params& params,
+                           std::vector<LZ77Sequence>& sequences, LZ77CostModel* costs) {
+    const LevelSettings& settings = levelSettings(params.level);
+    const size_t window = normalizedWindow(params.windowSize);
+    const uint32_t depth = params.chainDepth > 0 ? params.chainDepth : settings.chainDepth;
+    const size_t historyStart = start > window ? start - window : 0;
+
+    LZ77CostModel formatCosts;
+    auto run = [&](auto& finder) {
+        for (size_t position = historyStart; position < start; position++) {
+            finder.skip(position);
+        }
+        if (settings.strategy == Strategy::OPTIMAL) {
+            parseOptimal(data, start, end, finder, settings.niceLength, costs ? *costs : formatCosts, sequences);
+        } else {
+            parseLazy(start, end, finder, settings.lazySteps, sequences);
+        }
+    };
+
+    LZ77MatchFinder finderKind = params.matchFinder != LZ77MatchFinder::LEVEL_DEFAULT ? params.matchFinder
+                                                                                     : settings.finder;
+    switch (finderKind) {
+        case LZ77MatchFinder::LEVEL_DEFAULT:
+        case LZ77MatchFinder::HASH_CHAIN: {
+            HashChainMatchFinder finder(data, historyStart, end, window, depth, settings.niceLength);
+            run(finder);
+            break;
+        }
+        case LZ77MatchFinder::BINARY_TREE: {
+            BinaryTreeMatchFinder finder(data, historyStart, end, window, depth, settings.niceLength);
+            run(finder);
+            break;
+        }
+        case LZ77MatchFinder::SUFFIX_ARRAY: {
+            SuffixArrayMatchFinder finder(data, historyStart, end, window, depth, settings.niceLength);
+            run(finder);
+            break;
+        }
+    }
+}
+
+void LZ77Compressor::encodeSequences(const uint8_t* data, size_t start, const std::vector<LZ77Sequence>& sequences,
+                                     std::vector<uint8_t>& output) {
+    const uint8_t* literals = data + start;
+    for (const LZ77Sequence& sequence : sequences) {
+        size_t literalLength = sequence.literalLength;
+        size_t matchExtra = sequence.matchLength > 0 ? sequence.matchLength - MIN_MATCH : 0;
+
+        output.push_back(static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) |
+                                              std::min<size_t>(matchExtra, 15)));
+        if (literalLength >= 15) {
+            writeLength(output, literalLength - 15);
+        }
+        output.insert(output.end(), literals, literals + literalLength);
+        literals += literalLength;
+
+        if (sequence.matchLength > 0) {
+            writeVarint(output, sequence.offset);
+            if (matchExtra >= 15) {
+                writeLength(output, matchExtra - 15);
+            }
+            literals += sequence.matchLength;
+        }
+    }
+}
+
+bool LZ77Compressor::decodeSequences(const uint8_t* input, size_t inputSize, uint8_t* output, size_t start,
+                                     size_t rawSize) {
+    const uint8_t* ip = input;
+    const uint8_t* ipEnd = input + inputSize;
+    uint8_t* op = output + start;
+    uint8_t* opEnd = op + rawSize;
+
+    while (op < opEnd) {
+        if (ip == ipEnd) {
+            return false;
+        }
+        uint8_t token = *ip++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(ip, ipEnd, literalLength)) {
+            return false;
+        }
+        if (literalLength > static_cast<size_t>(ipEnd - ip) || literalLength > static_cast<size_t>(opEnd - op)) {
+            return false;
+        }
+        std::memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+        if (op == opEnd) {
+            break;
+        }
+
+        uint64_t offset;
+        if (!readVarint(ip, ipEnd, offset)) {
+            return false;
+        }
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(ip, ipEnd, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > static_cast<uint64_t>(op - output) ||
+            matchLength > static_cast<size_t>(opEnd - op)) {
+            return false;
+        }
+        copyMatch(op, static_cast<size_t>(offset), matchLength);
+        op += matchLength;
+    }
+
+    return ip == ipEnd;
+}
+
+// Copies a match of length bytes from offset bytes back. With offsets of 8
+// or more each 8-byte load reads bytes that are already final, so the copy
+// may run up to 7 bytes past the end. Shorter offsets repeat a pattern:
+// each memcpy doubles the span that is already laid out.
+void LZ77Compressor::copyMatch(uint8_t* op, size_t offset, size_t length) {
+    const uint8_t* source = op - offset;
+    if (offset >= 8) {
+        uint8_t* end = op + length;
+        while (op < end) {
+            std::memcpy(op, source, 8);
+            op += 8;
+            source += 8;
+        }
+        return;
+    }
+
+    while (length > 0) {
+        size_t chunk = std::min(length, static_cast<size_t>(op - source));
+        std::memcpy(op, source, chunk);
+        op += chunk;
+        length -= chunk;
+    }
+}
+
+
+uint32_t LZ77Compressor::normalizedWindow(uint32_t windowSize) {
+    uint32_t clamped = std::min(std::max(windowSize, MIN_WINDOW), MAX_WINDOW);
+    return 1u << ceilLog2(clamped);
+}
+
+void LZ77Compressor::writeU32(std::ofstream& output, uint32_t value) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(value & 0xFF),
+        static_cast<unsigned char>((value >> 8) & 0xFF),
+        static_cast<unsigned char>((value >> 16) & 0xFF),
+        static_cast<unsigned char>((value >> 24) & 0xFF)
+    };
+    output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+bool LZ77Compressor::readU32(std::ifstream& input, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!input.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    value = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+bool LZ77Compressor::fileExists(const std::string& filename) {
+    return std::filesystem::exists(filename);
+}
+
+size_t LZ77Compressor::getFileSize(const std::string& filename) {
+    try {
+        return std::filesystem::file_size(filename);
+    } catch (const std::filesystem::filesystem_error&) {
+        return 0;
+    }
+}
@@ -0,0 +1,338 @@
+#include "lzh.h"
+#include "bit_buffer.h"
+#include "huffman.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+struct Bucket {
+    uint32_t symbol;
+    uint32_t extraBits;
+    uint32_t extra;
+};
+
+Bucket bucketOf(uint32_t value) {
+    if (value < 4) {
+        return {value, 0, 0};
+    }
+    uint32_t log = 0;
+    for (uint32_t rest = value; rest > 1; rest >>= 1) {
+        log++;
+    }
+    uint32_t extraBits = log - 1;
+    return {2 * log + ((value >> extraBits) & 1), extraBits, value & ((1u << extraBits) - 1)};
+}
+
+uint32_t readBucketValue(uint32_t symbol, BitBufferReader& reader) {
+    if (symbol < 4) {
+        return symbol;
+    }
+    uint32_t extraBits = (symbol >> 1) - 1;
+    return ((2 | (symbol & 1)) << extraBits) + reader.read(extraBits);
+}
+
+// Splits a match into pieces of at most maxMatch bytes, none shorter than
+// MIN_MATCH, all copying from the same offset.
+template <typename Emit>
+void splitMatch(uint32_t length, uint32_t maxMatch, Emit emit) {
+    while (length > maxMatch) {
+        uint32_t piece = length - maxMatch < LZ77Compressor::MIN_MATCH ? length - LZ77Compressor::MIN_MATCH
+                                                                       : maxMatch;
+        emit(piece);
+        length -= piece;
+    }
+    emit(length);
+}
+
+uint32_t usedSymbols(const std::vector<uint8_t>& lengths) {
+    uint32_t count = static_cast<uint32_t>(lengths.size());
+    while (count > 0 && lengths[count - 1] == 0) {
+        count--;
+    }
+    return count;
+}
+
+}
+
+// Costs follow what the Huffman codes built from the statistics so far
+// would charge. Counts start flat and are halved as they grow, so prices
+// track the recent data.
+class LZHCompressor::CostModel : public LZ77CostModel {
+public:
+    CostModel()
+        : symbolCounts_(LITERAL_LENGTH_CODES, 1), distanceCounts_(DISTANCE_CODES, 1),
+          symbolCosts_(LITERAL_LENGTH_CODES), distanceCosts_(DISTANCE_CODES) {
+        refresh();
+    }
+
+    uint32_t literalCost(uint8_t byte) const override {
+        return symbolCosts_[byte];
+    }
+
+    uint32_t lengthCost(uint32_t length) const override {
+        Bucket bucket = bucketOf(std::min(length, MAX_MATCH) - LZ77Compressor::MIN_MATCH);
+        return symbolCosts_[END_OF_BLOCK + 1 + bucket.symbol] + bucket.extraBits * SCALE;
+    }
+
+    uint32_t offsetCost(uint32_t offset) const override {
+        Bucket bucket = bucketOf(offset - 1);
+        return distanceCosts_[bucket.symbol] + bucket.extraBits * SCALE;
+    }
+
+    void observeLiteral(uint8_t byte) override {
+        symbolCounts_[byte]++;
+    }
+
+    void observeMatch(uint32_t length, uint32_t offset) override {
+        symbolCounts_[END_OF_BLOCK + 1 + bucketOf(std::min(length, MAX_MATCH) - LZ77Compressor::MIN_MATCH).symbol]++;
+        distanceCounts_[bucketOf(offset - 1).symbol]++;
+    }
+
+    void refresh() override {
+        updateCosts(symbolCounts_, symbolCosts_);
+        updateCosts(distanceCounts_, distanceCosts_);
+    }
+
+private:
+    static constexpr uint32_t DECAY_TOTAL = 1u << 16;
+
+    static void updateCosts(std::vector<uint32_t>& counts, std::vector<uint32_t>& costs) {
+        uint64_t total = 0;
+        for (uint32_t count : counts) {
+            total += count;
+        }
+        if (total > DECAY_TOTAL) {
+            total = 0;
+            for (uint32_t& count : counts) {
+                count = (count + 1) / 2;
+                total += count;
+            }
+        }
+        for (size_t symbol = 0; symbol < counts.size(); symbol++) {
+            double bits = std::log2(static_cast<double>(total) / counts[symbol]);
+            costs[symbol] = static_cast<uint32_t>(bits * SCALE + 0.5);
+        }
+    }
+
+    std::vector<uint32_t> symbolCounts_;
+    std::vector<uint32_t> distanceCounts_;
+    std::vector<uint32_t> symbolCosts_;
+    std::vector<uint32_t> distanceCosts_;
+};
+
+bool LZHCompressor::compress(const std::string& inputFile, const std::string& outputFile,
+                             const LZ77Params& params) {
+    return LZ77Compressor::compressStream(inputFile, outputFile, MAGIC, params,
+                                          [](const uint8_t* data, size_t start, size_t end,
+                                             const LZ77Params& effective, std::vector<uint8_t>& encoded) {
+                                              std::vector<LZ77Sequence> sequences;
+                                              CostModel costs;
+                                              LZ77Compressor::parse(data, start, end, effective, sequences,
+                                                                    &costs);
+                                              encodeSequences(data, start, sequences, encoded);
+                                          });
+}
+
+bool LZHCompressor::decompress(const std::string& inputFile, const std::string& outputFile) {
+    return LZ77Compressor::decompressStream(inputFile, outputFile, MAGIC, "LZH", decodeSequences);
+}
+
+bool LZHCompressor::isValidLZHFile(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool LZHCompressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                  const LZ77Params& params, size_t historySize) {
+    std::vector<LZ77Sequence> sequences;
+    CostModel costs;
+    LZ77Compressor::parse(input.data(), historySize, input.size(), params, sequences, &costs);
+
+    output.clear();
+    writeVarint(output, input.size() - historySize);
+    encodeSequences(input.data(), historySize, sequences, output);
+    return true;
+}
+
+bool LZHCompressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                    size_t maxSize, size_t historySize) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    uint64_t rawSize;
+    // Every symbol costs at least a bit and yields at most MAX_MATCH bytes.
+    if (!readVarint(ip, end, rawSize) || rawSize > maxSize ||
+        rawSize > static_cast<uint64_t>(input.size()) * 8 * MAX_MATCH) {
+        return false;
+    }
+
+    output.resize(historySize + static_cast<size_t>(rawSize) + LZ77Compressor::COPY_SLACK);
+    if (!decodeSequences(ip, static_cast<size_t>(end - ip), output.data(), historySize,
+                         static_cast<size_t>(rawSize))) {
+        return false;
+    }
+    output.resize(historySize + static_cast<size_t>(rawSize));
+    return true;
+}
+
+void LZHCompressor::encodeSequences(const uint8_t* data, size_t start, const std::vector<LZ77Sequence>& sequences,
+                                    std::vector<uint8_t>& output) {
+    const size_t outputStart = output.size();
+    output.push_back(MODE_HUFFMAN);
+    BitBufferWriter writer(output);
+
+    const uint8_t* literals = data + start;
+    std::vector<uint32_t> literalFrequencies;
+    std::vector<uint32_t> distanceFrequencies;
+    size_t next = 0;
+    do {
+        // Take whole sequences until the sub-block has enough symbols.
+        literalFrequencies.assign(LITERAL_LENGTH_CODES, 0);
+        distanceFrequencies.assign(DISTANCE_CODES, 0);
+        size_t end = next;
+        size_t symbols = 0;
+        const uint8_t* cursor = literals;
+        while (end < sequences.size() && symbols < SUBBLOCK_SYMBOLS) {
+            const LZ77Sequence& sequence = sequences[end++];
+            for (uint32_t i = 0; i < sequence.literalLength; i++) {
+                literalFrequencies[cursor[i]]++;
+            }
+            cursor += sequence.literalLength + sequence.matchLength;
+            symbols += sequence.literalLength;
+            if (sequence.matchLength > 0) {
+                splitMatch(sequence.matchLength, MAX_MATCH, [&](uint32_t piece) {
+                    literalFrequencies[END_OF_BLOCK + 1 + bucketOf(piece - LZ77Compressor::MIN_MATCH).symbol]++;
+                    distanceFrequencies[bucketOf(sequence.offset - 1).symbol]++;
+                    symbols++;
+                });
+            }
+        }
+        literalFrequencies[END_OF_BLOCK] = 1;
+
+        std::vector<uint8_t> literalLengths = HuffmanCompressor::buildCodeLengths(literalFrequencies, MAX_CODE_LENGTH);
+        std::vector<uint8_t> distanceLengths =
+            HuffmanCompressor::buildCodeLengths(distanceFrequencies, MAX_CODE_LENGTH);
+        std::vector<uint32_t> literalCodes = HuffmanCompressor::buildCanonicalCodes(literalLengths);
+        std::vector<uint32_t> distanceCodes = HuffmanCompressor::buildCanonicalCodes(distanceLengths);
+        uint32_t literalCount = usedSymbols(literalLengths);
+        uint32_t distanceCount = usedSymbols(distanceLengths);
+
+        writer.write(end == sequences.size() ? 1 : 0, 1);
+        writer.write(literalCount - (END_OF_BLOCK + 1), 6);
+        writer.write(distanceCount, 6);
+        for (uint32_t symbol = 0; symbol < literalCount; symbol++) {
+            writer.write(literalLengths[symbol], 4);
+        }
+        for (uint32_t symbol = 0; symbol < distanceCount; symbol++) {
+            writer.write(distanceLengths[symbol], 4);
+        }
+
+        for (size_t index = next; index < end; index++) {
+            const LZ77Sequence& sequence = sequences[index];
+            for (uint32_t i = 0; i < sequence.literalLength; i++) {
+                writer.write(literalCodes[literals[i]], literalLengths[literals[i]]);
+            }
+            literals += sequence.literalLength + sequence.matchLength;
+            if (sequence.matchLength == 0) {
+                continue;
+            }
+            Bucket distance = bucketOf(sequence.offset - 1);
+            splitMatch(sequence.matchLength, MAX_MATCH, [&](uint32_t piece) {
+                Bucket length = bucketOf(piece - LZ77Compressor::MIN_MATCH);
+                uint32_t symbol = END_OF_BLOCK + 1 + length.symbol;
+                writer.write(literalCodes[symbol], literalLengths[symbol]);
+                writer.write(length.extra, length.extraBits);
+                writer.write(distanceCodes[distance.symbol], distanceLengths[distance.symbol]);
+                writer.write(distance.extra, distance.extraBits);
+            });
+        }
+        writer.write(literalCodes[END_OF_BLOCK], literalLengths[END_OF_BLOCK]);
+        next = end;
+    } while (next < sequences.size());
+    writer.flush();
+
+    // Incompressible input is stored, so a chunk never grows by more than
+    // its mode byte.
+    const size_t rawSize = static_cast<size_t>(literals - (data + start));
+    if (output.size() - outputStart > rawSize + 1) {
+        output.resize(outputStart);
+        output.push_back(MODE_STORED);
+        output.insert(output.end(), data + start, data + start + rawSize);
+    }
+}
+
+bool LZHCompressor::decodeSequences(const uint8_t* input, size_t inputSize, uint8_t* output, size_t start,
+                                    size_t rawSize) {
+    if (inputSize == 0) {
+        return false;
+    }
+    if (input[0] == MODE_STORED) {
+        if (inputSize - 1 != rawSize) {
+            return false;
+        }
+        std::memcpy(output + start, input + 1, rawSize);
+        return true;
+    }
+    if (input[0] != MODE_HUFFMAN) {
+        return false;
+    }
+
+    BitBufferReader reader(input + 1, inputSize - 1);
+    uint8_t* op = output + start;
+    uint8_t* opEnd = op + rawSize;
+    CanonicalHuffmanDecoder literalDecoder;
+    CanonicalHuffmanDecoder distanceDecoder;
+    uint8_t lengths[LITERAL_LENGTH_CODES + DISTANCE_CODES];
+
+    bool final = false;
+    while (!final) {
+        final = reader.read(1) != 0;
+        uint32_t literalCount = reader.read(6) + END_OF_BLOCK + 1;
+        uint32_t distanceCount = reader.read(6);
+        if (literalCount > LITERAL_LENGTH_CODES || distanceCount > DISTANCE_CODES) {
+            return false;
+        }
+        for (uint32_t symbol = 0; symbol < literalCount + distanceCount; symbol++) {
+            lengths[symbol] = static_cast<uint8_t>(reader.read(4));
+        }
+        if (reader.overrun() || !literalDecoder.build(lengths, literalCount) ||
+            !distanceDecoder.build(lengths + literalCount, distanceCount)) {
+            return false;
+        }
+
+        while (true) {
+            int symbol = literalDecoder.decode(reader);
+            if (symbol < static_cast<int>(END_OF_BLOCK)) {
+                if (symbol < 0 || op == opEnd) {
+                    return false;
+                }
+                *op++ = static_cast<uint8_t>(symbol);
+                continue;
+            }
+            if (symbol == static_cast<int>(END_OF_BLOCK)) {
+                break;
+            }
+
+            size_t length = readBucketValue(static_cast<uint32_t>(symbol) - END_OF_BLOCK - 1, reader) +
+                            LZ77Compressor::MIN_MATCH;
+            int distanceSymbol = distanceDecoder.decode(reader);
+            if (distanceSymbol < 0) {
+                return false;
+            }
+            size_t offset = static_cast<size_t>(readBucketValue(static_cast<uint32_t>(distanceSymbol), reader)) + 1;
+            if (offset > static_cast<size_t>(op - output) || length > static_cast<size_t>(opEnd - op)) {
+                return false;
+            }
+            LZ77Compressor::copyMatch(op, offset, length);
+            op += length;
+        }
+        if (reader.overrun()) {
+            return false;
+        }
+    }
+
+    return op == opEnd && reader.bytesConsumed() == inputSize - 1;
+}
@@ -5,9 +5,12 @@
 
 #include "lzw.h"
 #include <iostream>
+#include <cstring>
 #include <filesystem>
+#include <limits>
+#include <sstream>
 
-BitWriter::BitWriter(std::ofstream& output) : output_(output), buffer_(0), bitsInBuffer_(0) {}
+BitWriter::BitWriter(std::ostream& output) : output_(output), buffer_(0), bitsInBuffer_(0) {}
 
 BitWriter::~BitWriter() {
     flush();
@@ -45,7 +48,7 @@ void BitWriter::flush() {
     }
 }
 
-BitReader::BitReader(std::ifstream& input) : input_(input), buffer_(0), bitsInBuffer_(0), endOfFile_(false) {}
+BitReader::BitReader(std::istream& input) : input_(input), buffer_(0), bitsInBuffer_(0), endOfFile_(false) {}
 
 uint32_t BitReader::readBits(int numBits) {
     uint32_t result = 0;
@@ -114,6 +117,9 @@ bool LZWCompressor::compress(const std::string& inputFile, const std::string& ou
         return false;
     }
     
+    output.write(MAGIC, sizeof(MAGIC));
+    output.put(static_cast<char>(FORMAT_VERSION));
+    
     bool success = false;
     
     {
@@ -152,11 +158,23 @@ bool LZWCompressor::decompress(const std::string& inputFile, const std::string&
         return false;
     }
     
+    char header[sizeof(MAGIC) + 1];
+    bool versioned = input.read(header, sizeof(header)) && std::memcmp(header, MAGIC, sizeof(MAGIC)) == 0;
+    if (versioned && static_cast<uint8_t>(header[sizeof(MAGIC)]) != FORMAT_VERSION) {
+        std::cerr << "Error: Unsupported LZW format version " << static_cast<int>(static_cast<uint8_t>(header[sizeof(MAGIC)]))
+                  << ".\n";
+        return false;
+    }
+    if (!versioned) {
+        input.clear();
+        input.seekg(0);
+    }
+    
     bool success = false;
     
     {
         BitReader reader(input);
-        success = decompressData(reader, output);
+        success = decompressData(reader, output, !versioned, std::numeric_limits<uint64_t>::max());
     }
     
     input.close();
@@ -180,6 +198,39 @@ bool LZWCompressor::isValidLZWFile(const std::string& filename) {
     return fileSize > 0;
 }
 
+bool LZWCompressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+    std::istringstream in(std::string(input.begin(), input.end()), std::ios::binary);
+    std::ostringstream out(std::ios::binary);
+    
+    bool success = false;
+    
+    {
+        BitWriter writer(out);
+        success = compressData(in, writer);
+    }
+    
+    const std::string encoded = out.str();
+    output.assign(encoded.begin(), encoded.end());
+    return success;
+}
+
+// Blocks have no header of their own; they always use the version 2 stream.
+bool LZWCompressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize) {
+    std::istringstream in(std::string(input.begin(), input.end()), std::ios::binary);
+    std::ostringstream out(std::ios::binary);
+    
+    bool success = false;
+    
+    {
+        BitReader reader(in);
+        success = decompressData(reader, out, false, maxSize);
+    }
+    
+    const std::string decoded = out.str();
+    output.assign(decoded.begin(), decoded.end());
+    return success;
+}
+
 LZWCompressor::CompressionDictionary LZWCompressor::buildCompressionDictionary() {
     CompressionDictionary dict;
     
@@ -204,7 +255,7 @@ LZWCompressor::DecompressionDictionary LZWCompressor::buildDecompressionDictiona
     return dict;
 }
 
-bool LZWCompressor::compressData(std::ifstream& input, BitWriter& writer) {
+bool LZWCompressor::compressData(std::istream& input, BitWriter& writer) {
     CompressionDictionary dict = buildCompressionDictionary();
     uint16_t nextCode = FIRST_CODE;
     uint16_t codeWidth = INITIAL_CODE_WIDTH;
@@ -243,14 +294,30 @@ bool LZWCompressor::compressData(std::ifstream& input, BitWriter& writer) {
         }
     }
     
+    // The decoder widens before reading once the entry it is about to add
+    // needs the wider code, so the stop code follows the same rule.
+    if (nextCode + 1u > (1u << codeWidth) && codeWidth < MAX_CODE_WIDTH) {
+        codeWidth++;
+    }
+    
     writer.writeBits(STOP_CODE, codeWidth);
     return true;
 }
 
-bool LZWCompressor::decompressData(BitReader& reader, std::ofstream& output) {
+bool LZWCompressor::decompressData(BitReader& reader, std::ostream& output, bool lateWidening, uint64_t maxSize) {
     DecompressionDictionary dict = buildDecompressionDictionary();
     uint16_t nextCode = FIRST_CODE;
     uint16_t codeWidth = INITIAL_CODE_WIDTH;
+    uint64_t written = 0;
+    auto emit = [&](const std::string& text) {
+        if (text.length() > maxSize - written) {
+            std::cerr << "Error: LZW data decodes to more than " << maxSize << " bytes.\n";
+            return false;
+        }
+        written += text.length();
+        output.write(text.c_str(), text.length());
+        return true;
+    };
     
     if (!reader.hasData()) {
         return true;
@@ -267,16 +334,26 @@ bool LZWCompressor::decompressData(BitReader& reader, std::ofstream& output) {
     }
     
     std::string prevString = dict[prevCode];
-    output.write(prevString.c_str(), prevString.length());
+    if (!emit(prevString)) {
+        return false;
+    }
     
     while (true) {
         if (!reader.hasData()) {
             break;
         }
         
+        // The decoder adds each entry one code later than the encoder, so
+        // widen as soon as the encoder's pending entry would need it. The
+        // original format widened after reading instead, which only decodes
+        // streams too short to reach 512 entries; it is kept for old files.
+        if (!lateWidening && nextCode + 1u > (1u << codeWidth) && codeWidth < MAX_CODE_WIDTH) {
+            codeWidth++;
+        }
+        
         uint16_t code = reader.readBits(codeWidth);
         
-        if (nextCode > (1u << codeWidth) && codeWidth < MAX_CODE_WIDTH) {
+        if (lateWidening && nextCode > (1u << codeWidth) && codeWidth < MAX_CODE_WIDTH) {
             codeWidth++;
         }
         
@@ -294,9 +371,15 @@ bool LZWCompressor::decompressData(BitReader& reader, std::ofstream& output) {
             if (prevCode == STOP_CODE) {
                 break;
             }
+            if (prevCode >= dict.size()) {
+                std::cerr << "Error: Invalid LZW code " << prevCode << " in compressed data.\n";
+                return false;
+            }
             
             prevString = dict[prevCode];
-            output.write(prevString.c_str(), prevString.length());
+            if (!emit(prevString)) {
+                return false;
+            }
             continue;
         }
         
@@ -310,7 +393,9 @@ bool LZWCompressor::decompressData(BitReader& reader, std::ofstream& output) {
             return false;
         }
         
-        output.write(currentString.c_str(), currentString.length());
+        if (!emit(currentString)) {
+            return false;
+        }
         
         if (nextCode < MAX_DICTIONARY_SIZE) {
             dict.push_back(prevString + currentString[0]);
@@ -1,18 +1,71 @@
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 #include "rle.h"
 #include "huffman.h"
 #include "lzw.h"
+#include "lz77.h"
+#include "lzh.h"
+#include "ans.h"
+#include "rans.h"
+#include "bwt.h"
+#include "cm.h"
+#include "block_compressor.h"
+#include "block_codec.h"
+#include "transform_chain.h"
+#include "algorithm_selector.h"
+#include "thread_pool.h"
+#include "daemon.h"
 #include "cxxopts.hpp"
 
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+static void printProgress(const CompressionProgress* progress, void*) {
+    double percent = progress->total_bytes > 0
+        ? 100.0 * static_cast<double>(progress->bytes_processed) / static_cast<double>(progress->total_bytes)
+        : 100.0;
+    std::cerr << "\rProgress: " << static_cast<int>(percent) << "% "
+              << progress->throughput_mbps << " MB/s, ETA " << progress->eta_seconds << " s   ";
+    if (progress->bytes_processed >= progress->total_bytes) {
+        std::cerr << std::endl;
+    }
+}
+
 int main(int argc, char* argv[]) {
     cxxopts::Options options("compress", "Multi-Algorithm Compression Tool");
     
     options.add_options()
-        ("algo", "Compression algorithm: 'rle', 'huffman', or 'lzw'", cxxopts::value<std::string>())
+        ("algo", "Compression algorithm: 'rle', 'huffman', 'lzw', 'lz77', 'lzh', 'ans', 'rans', 'bwt', 'cm', 'huffman1', 'ahuffman', 'rle-huffman', 'delta4-rle-huffman', 'auto' (chosen from a sample of the input), or a chain of stages joined by '+' (also 'mtf', 'delta', 'bwt-raw')", cxxopts::value<std::string>())
         ("mode", "Operation mode: 'compress' or 'decompress'", cxxopts::value<std::string>())
-        ("input", "Input file path", cxxopts::value<std::string>())
-        ("output", "Output file path", cxxopts::value<std::string>())
+        ("input", "Input file path ('-' for standard input with ahuffman)", cxxopts::value<std::string>())
+        ("output", "Output file path ('-' for standard output with ahuffman)", cxxopts::value<std::string>())
+        ("threads", "Worker threads for block mode (0 = one per usable CPU)", cxxopts::value<size_t>())
+        ("pin-threads", "Bind each worker thread to its own CPU")
+        ("block-size", "Compress in independent blocks of this many bytes, in parallel", cxxopts::value<size_t>())
+        ("progress", "Print progress, throughput and ETA in block mode")
+        ("max-read-mbps", "Throttle input reads to this many MB/s in block mode", cxxopts::value<double>())
+        ("max-write-mbps", "Throttle output writes to this many MB/s in block mode", cxxopts::value<double>())
+        ("max-cpu", "Limit block mode to this percent of one core", cxxopts::value<uint32_t>())
+        ("checkpoint", "Save block-mode compression progress to this file", cxxopts::value<std::string>())
+        ("resume", "Continue compression from the --checkpoint file if it matches")
+        ("window", "LZ77/LZH window size in bytes (64 KB - 16 MB)", cxxopts::value<uint32_t>())
+        ("chain-depth", "LZ77/LZH match candidates examined per position", cxxopts::value<uint32_t>())
+        ("level", "LZ77/LZH level: 1 (fastest) to 9 (smallest), default 3", cxxopts::value<uint32_t>())
+        ("match-finder", "LZ77/LZH match finder: 'hc' (hash chain), 'bt' (binary tree), or 'sa' (suffix array)",
+         cxxopts::value<std::string>())
+        ("link-blocks", "LZ77/LZH block mode: let each block match into the window before it")
+        ("entropy", "BWT entropy stage: 'huffman', 'tans', or 'rans' (default)", cxxopts::value<std::string>())
+        ("memory", "Context-mixing model memory in MB (1 - 4096), default 64", cxxopts::value<uint32_t>())
+        ("rebuild-interval", "Adaptive Huffman: bytes between code rebuilds (256 - 1048576), default 4096",
+         cxxopts::value<uint32_t>())
+        ("daemon", "Run as a compression daemon listening on --socket")
+        ("socket", "Unix socket of the daemon; without --daemon, forward this job to it", cxxopts::value<std::string>())
         ("h,help", "Show help information");
     
     try {
@@ -27,8 +80,33 @@ int main(int argc, char* argv[]) {
             std::cout << "  ./compress --algo huffman --mode decompress --input sample.huf --output restored.txt" << std::endl;
             std::cout << "  ./compress --algo lzw --mode compress --input sample.txt --output sample.lzw" << std::endl;
             std::cout << "  ./compress --algo lzw --mode decompress --input sample.lzw --output restored.txt" << std::endl;
+            std::cout << "  ./compress --algo lz77 --mode compress --window 4194304 --input sample.txt --output sample.lz77" << std::endl;
+            std::cout << "  ./compress --algo lzh --mode compress --level 9 --input sample.txt --output sample.lzh" << std::endl;
+            std::cout << "  ./compress --algo lzh --mode compress --block-size 1048576 --link-blocks --input big.txt --output big.lzh" << std::endl;
+            std::cout << "  ./compress --algo bwt --mode compress --entropy tans --input sample.txt --output sample.bwt" << std::endl;
+            std::cout << "  ./compress --algo huffman1 --mode compress --input sample.txt --output sample.huf1" << std::endl;
+            std::cout << "  tail -f app.log | ./compress --algo ahuffman --mode compress --input - --output log.hufs" << std::endl;
+            std::cout << "  ./compress --algo cm --mode compress --memory 256 --input sample.txt --output sample.cm" << std::endl;
+            std::cout << "  ./compress --algo delta4-rle-huffman --mode compress --input samples.pcm --output samples.drh" << std::endl;
+            std::cout << "  ./compress --algo auto --mode compress --input data.bin --output data.auto" << std::endl;
+            std::cout << "  ./compress --algo bwt-raw+mtf+rle+ans --mode compress --input sample.txt --output sample.chain" << std::endl;
+            std::cout << "  ./compress --algo lzw --mode compress --block-size 1048576 --threads 8 --input big.txt --output big.lzw" << std::endl;
+            std::cout << "  ./compress --daemon --socket /tmp/compressd.sock" << std::endl;
+            std::cout << "  ./compress --socket /tmp/compressd.sock --algo lzw --mode compress --input sample.txt --output sample.lzw" << std::endl;
             return 0;
         }
+
+        if (result.count("daemon")) {
+            if (!result.count("socket")) {
+                std::cerr << "Error: --daemon requires --socket" << std::endl;
+                return 1;
+            }
+            if (result.count("threads") || result.count("pin-threads")) {
+                ThreadPool::configure(result.count("threads") ? result["threads"].as<size_t>() : 0,
+                                      result.count("pin-threads") > 0);
+            }
+            return CompressionDaemon::serve(result["socket"].as<std::string>()) ? 0 : 1;
+        }
         
         if (!result.count("algo")) {
             std::cerr << "Error: --algo parameter is required" << std::endl;
@@ -55,8 +133,24 @@ int main(int argc, char* argv[]) {
         std::string inputFile = result["input"].as<std::string>();
         std::string outputFile = result["output"].as<std::string>();
         
-        if (algorithm != "rle" && algorithm != "huffman" && algorithm != "lzw") {
-            std::cerr << "Error: Supported algorithms are 'rle', 'huffman', and 'lzw'" << std::endl;
+        CompressionAlgorithm algorithmId;
+        if (!TransformChain::algorithmId(algorithm, algorithmId)) {
+            std::string names;
+            for (const std::string& name : TransformChain::algorithmNames()) {
+                names += (names.empty() ? "'" : "', '") + name;
+            }
+            std::cerr << "Error: Supported algorithms are " << names << "', or a chain of them joined by '+'"
+                      << std::endl;
+            return 1;
+        }
+        // A chain such as "rle+huffman" always runs in block mode, where
+        // its stages are recorded in the header; so do the fused pipelines
+        // and auto, which have no single-stream format.
+        bool chained = algorithmId == ALGORITHM_CHAIN;
+        std::vector<uint8_t> chain;
+        if (chained && !TransformChain::parse(algorithm, chain)) {
+            std::cerr << "Error: Invalid chain '" << algorithm << "'; stages are the algorithm names plus "
+                      << "'mtf', 'delta', and 'bwt-raw', at most " << TransformChain::MAX_STAGES << std::endl;
             return 1;
         }
         
@@ -65,21 +159,211 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
-        if (inputFile == outputFile) {
+        bool standardStreams = inputFile == "-" || outputFile == "-";
+        if (inputFile == outputFile && !standardStreams) {
             std::cerr << "Error: Input and output files cannot be the same" << std::endl;
             return 1;
         }
         
-        std::cout << "Multi-Algorithm Compression Tool" << std::endl;
-        std::cout << "Algorithm: " << algorithm << std::endl;
-        std::cout << "Mode: " << mode << std::endl;
-        std::cout << "Input: " << inputFile << std::endl;
-        std::cout << "Output: " << outputFile << std::endl;
-        std::cout << "---" << std::endl;
+        BlockOptions blockOptions;
+        bool blockMode = result.count("block-size") > 0 || result.count("threads") > 0 ||
+                         result.count("max-read-mbps") > 0 || result.count("max-write-mbps") > 0 ||
+                         result.count("max-cpu") > 0 || result.count("checkpoint") > 0 ||
+                         result.count("link-blocks") > 0 || BlockCodec::isBlockOnly(algorithmId);
+        blockOptions.codec.chain = chain;
+        if (result.count("threads")) {
+            blockOptions.threads = result["threads"].as<size_t>();
+        }
+        if (result.count("threads") || result.count("pin-threads")) {
+            ThreadPool::configure(blockOptions.threads, result.count("pin-threads") > 0);
+        }
+        if (result.count("block-size")) {
+            blockOptions.blockSize = result["block-size"].as<size_t>();
+        }
+        if (result.count("progress")) {
+            blockOptions.progressCallback = printProgress;
+        }
+        if (result.count("max-read-mbps")) {
+            blockOptions.maxReadBytesPerSecond = result["max-read-mbps"].as<double>() * 1024.0 * 1024.0;
+        }
+        if (result.count("max-write-mbps")) {
+            blockOptions.maxWriteBytesPerSecond = result["max-write-mbps"].as<double>() * 1024.0 * 1024.0;
+        }
+        if (result.count("max-cpu")) {
+            blockOptions.maxCpuPercent = result["max-cpu"].as<uint32_t>();
+        }
+        if (result.count("window")) {
+            blockOptions.codec.lz77.windowSize = result["window"].as<uint32_t>();
+        }
+        if (result.count("chain-depth")) {
+            blockOptions.codec.lz77.chainDepth = result["chain-depth"].as<uint32_t>();
+        }
+        if (result.count("level")) {
+            uint32_t level = result["level"].as<uint32_t>();
+            if (level < LZ77Compressor::MIN_LEVEL || level > LZ77Compressor::MAX_LEVEL) {
+                std::cerr << "Error: --level must be between " << LZ77Compressor::MIN_LEVEL << " and "
+                          << LZ77Compressor::MAX_LEVEL << std::endl;
+                return 1;
+            }
+            blockOptions.codec.lz77.level = level;
+        }
+        if (result.count("match-finder")) {
+            std::string finder = result["match-finder"].as<std::string>();
+            if (finder == "hc") {
+                blockOptions.codec.lz77.matchFinder = LZ77MatchFinder::HASH_CHAIN;
+            } else if (finder == "bt") {
+                blockOptions.codec.lz77.matchFinder = LZ77MatchFinder::BINARY_TREE;
+            } else if (finder == "sa") {
+                blockOptions.codec.lz77.matchFinder = LZ77MatchFinder::SUFFIX_ARRAY;
+            } else {
+                std::cerr << "Error: --match-finder must be 'hc', 'bt', or 'sa'" << std::endl;
+                return 1;
+            }
+        }
+        if (result.count("entropy")) {
+            std::string entropy = result["entropy"].as<std::string>();
+            if (entropy == "huffman") {
+                blockOptions.codec.entropy = EntropyCoder::HUFFMAN;
+            } else if (entropy == "tans") {
+                blockOptions.codec.entropy = EntropyCoder::TANS;
+            } else if (entropy == "rans") {
+                blockOptions.codec.entropy = EntropyCoder::RANS;
+            } else {
+                std::cerr << "Error: --entropy must be 'huffman', 'tans', or 'rans'" << std::endl;
+                return 1;
+            }
+        }
+        if (result.count("memory")) {
+            blockOptions.codec.cmMemoryMb = result["memory"].as<uint32_t>();
+            if (blockOptions.codec.cmMemoryMb < CMCompressor::MIN_MEMORY_MB ||
+                blockOptions.codec.cmMemoryMb > CMCompressor::MAX_MEMORY_MB) {
+                std::cerr << "Error: --memory must be between 1 and 4096" << std::endl;
+                return 1;
+            }
+        }
+        blockOptions.linkBlocks = result.count("link-blocks") > 0;
+        if (result.count("checkpoint")) {
+            blockOptions.checkpointFile = result["checkpoint"].as<std::string>();
+            blockOptions.resume = result.count("resume") > 0;
+        } else if (result.count("resume")) {
+            std::cerr << "Error: --resume requires --checkpoint" << std::endl;
+            return 1;
+        }
+        
+        if (standardStreams && (algorithmId != ALGORITHM_HUFFMAN_ADAPTIVE || blockMode || result.count("socket"))) {
+            std::cerr << "Error: '-' for standard input or output is only supported by ahuffman in "
+                      << "single-stream mode" << std::endl;
+            return 1;
+        }
+        // The daemon's pool is configured when it starts.
+        if (result.count("socket") && result.count("pin-threads")) {
+            std::cerr << "Error: --pin-threads applies to the daemon, not to a job sent to it" << std::endl;
+            return 1;
+        }
+        if (result.count("rebuild-interval")) {
+            blockOptions.codec.huffmanRebuildInterval = result["rebuild-interval"].as<uint32_t>();
+            if (blockOptions.codec.huffmanRebuildInterval < HuffmanCompressor::MIN_REBUILD_INTERVAL ||
+                blockOptions.codec.huffmanRebuildInterval > HuffmanCompressor::MAX_REBUILD_INTERVAL) {
+                std::cerr << "Error: --rebuild-interval must be between 256 and 1048576" << std::endl;
+                return 1;
+            }
+        }
+
+        // Compressed data on standard output leaves only standard error for
+        // messages.
+        std::ostream& console = outputFile == "-" ? std::cerr : std::cout;
+        console << "Multi-Algorithm Compression Tool" << std::endl;
+        console << "Algorithm: " << algorithm << std::endl;
+        console << "Mode: " << mode << std::endl;
+        console << "Input: " << inputFile << std::endl;
+        console << "Output: " << outputFile << std::endl;
+        console << "---" << std::endl;
         
         bool success = false;
         
-        if (algorithm == "rle") {
+        if (result.count("socket")) {
+            DaemonRequest request;
+            request.mode = mode;
+            request.algorithm = algorithm;
+            request.blockSize = blockMode ? blockOptions.blockSize : 0;
+            request.inputFile = std::filesystem::absolute(inputFile).string();
+            request.outputFile = std::filesystem::absolute(outputFile).string();
+            // Every other option goes along, already checked above.
+            auto forward = [&](const char* name, const std::string& value) {
+                if (result.count(name)) {
+                    request.options.emplace_back(name, value);
+                }
+            };
+            forward("level", std::to_string(blockOptions.codec.lz77.level));
+            forward("window", std::to_string(blockOptions.codec.lz77.windowSize));
+            forward("chain-depth", std::to_string(blockOptions.codec.lz77.chainDepth));
+            forward("link-blocks", "1");
+            forward("memory", std::to_string(blockOptions.codec.cmMemoryMb));
+            forward("rebuild-interval", std::to_string(blockOptions.codec.huffmanRebuildInterval));
+            forward("threads", std::to_string(blockOptions.threads));
+            forward("max-cpu", std::to_string(blockOptions.maxCpuPercent));
+            forward("resume", "1");
+            forward("progress", "1");
+            for (const char* name : {"match-finder", "entropy"}) {
+                if (result.count(name)) {
+                    forward(name, result[name].as<std::string>());
+                }
+            }
+            for (const char* name : {"max-read-mbps", "max-write-mbps"}) {
+                if (result.count(name)) {
+                    forward(name, std::to_string(result[name].as<double>()));
+                }
+            }
+            if (result.count("checkpoint")) {
+                forward("checkpoint", std::filesystem::absolute(blockOptions.checkpointFile).string());
+            }
+
+            std::string reply;
+            success = CompressionDaemon::submit(result["socket"].as<std::string>(), request, reply,
+                                                result.count("progress") ? printProgress : nullptr);
+            if (success && reply.compare(0, 3, "OK\t") == 0) {
+                std::istringstream fields(reply.substr(3));
+                uint64_t originalSize = 0, compressedSize = 0;
+                double timeMs = 0;
+                fields >> originalSize >> compressedSize >> timeMs;
+                std::cout << "Original size: " << originalSize << " bytes" << std::endl;
+                std::cout << "Compressed size: " << compressedSize << " bytes" << std::endl;
+                std::cout << "Daemon time: " << timeMs << " ms" << std::endl;
+            } else if (success) {
+                std::cerr << "Daemon error: " << reply.substr(reply.find('\t') + 1) << std::endl;
+                success = false;
+            }
+        } else if (mode == "compress" && blockMode) {
+            CompressionAlgorithm blockAlgorithm = algorithmId;
+            if (algorithmId == ALGORITHM_AUTO) {
+                // The probe seeks around the input, so it needs a file.
+                AlgorithmChoice choice;
+                if (!AlgorithmSelector::select(inputFile, choice)) {
+                    std::cerr << "Error: --algo auto needs a readable input file" << std::endl;
+                    return 1;
+                }
+                blockAlgorithm = choice.algorithm;
+                blockOptions.autoSelected = true;
+                if (choice.lz77Level > 0 && !result.count("level")) {
+                    blockOptions.codec.lz77.level = choice.lz77Level;
+                }
+                console << "Selected: " << TransformChain::format({static_cast<uint8_t>(blockAlgorithm)});
+                if (choice.lz77Level > 0) {
+                    console << " level " << blockOptions.codec.lz77.level;
+                }
+                console << std::endl;
+            }
+            success = BlockCompressor::compress(blockAlgorithm, inputFile, outputFile, blockOptions);
+        } else if (mode == "decompress" && BlockCompressor::isBlockFile(inputFile)) {
+            CompressionAlgorithm framedAlgorithm;
+            uint32_t framedBlockSize;
+            if (BlockCompressor::isAutoSelected(inputFile) &&
+                BlockCompressor::readHeader(inputFile, framedAlgorithm, framedBlockSize)) {
+                console << "Selected: " << TransformChain::format({static_cast<uint8_t>(framedAlgorithm)})
+                        << " (automatic)" << std::endl;
+            }
+            success = BlockCompressor::decompress(inputFile, outputFile, blockOptions);
+        } else if (algorithmId == ALGORITHM_RLE) {
             if (mode == "compress") {
                 success = RLECompressor::compress(inputFile, outputFile);
             } else if (mode == "decompress") {
@@ -88,7 +372,7 @@ int main(int argc, char* argv[]) {
                 }
                 success = RLECompressor::decompress(inputFile, outputFile);
             }
-        } else if (algorithm == "huffman") {
+        } else if (algorithmId == ALGORITHM_HUFFMAN) {
             if (mode == "compress") {
                 success = HuffmanCompressor::compress(inputFile, outputFile);
             } else if (mode == "decompress") {
@@ -97,7 +381,7 @@ int main(int argc, char* argv[]) {
                 }
                 success = HuffmanCompressor::decompress(inputFile, outputFile);
             }
-        } else if (algorithm == "lzw") {
+        } else if (algorithmId == ALGORITHM_LZW) {
             if (mode == "compress") {
                 success = LZWCompressor::compress(inputFile, outputFile);
             } else if (mode == "decompress") {
@@ -106,10 +390,108 @@ int main(int argc, char* argv[]) {
                 }
                 success = LZWCompressor::decompress(inputFile, outputFile);
             }
+        } else if (algorithmId == ALGORITHM_LZ77) {
+            if (mode == "compress") {
+                success = LZ77Compressor::compress(inputFile, outputFile, blockOptions.codec.lz77);
+            } else if (mode == "decompress") {
+                if (!LZ77Compressor::isValidLZ77File(inputFile)) {
+                    std::cerr << "Warning: Input file may not be a valid LZ77 compressed file" << std::endl;
+                }
+                success = LZ77Compressor::decompress(inputFile, outputFile);
+            }
+        } else if (algorithmId == ALGORITHM_LZH) {
+            if (mode == "compress") {
+                success = LZHCompressor::compress(inputFile, outputFile, blockOptions.codec.lz77);
+            } else if (mode == "decompress") {
+                if (!LZHCompressor::isValidLZHFile(inputFile)) {
+                    std::cerr << "Warning: Input file may not be a valid LZH compressed file" << std::endl;
+                }
+                success = LZHCompressor::decompress(inputFile, outputFile);
+            }
+        } else if (algorithmId == ALGORITHM_ANS) {
+            if (mode == "compress") {
+                success = ANSCompressor::compress(inputFile, outputFile);
+            } else if (mode == "decompress") {
+                if (!ANSCompressor::isValidANSFile(inputFile)) {
+                    std::cerr << "Warning: Input file may not be a valid ANS compressed file" << std::endl;
+                }
+                success = ANSCompressor::decompress(inputFile, outputFile);
+            }
+        } else if (algorithmId == ALGORITHM_RANS) {
+            if (mode == "compress") {
+                success = RANSCompressor::compress(inputFile, outputFile);
+            } else if (mode == "decompress") {
+                if (!RANSCompressor::isValidRANSFile(inputFile)) {
+                    std::cerr << "Warning: Input file may not be a valid rANS compressed file" << std::endl;
+                }
+                success = RANSCompressor::decompress(inputFile, outputFile);
+            }
+        } else if (algorithmId == ALGORITHM_BWT) {
+            if (mode == "compress") {
+                success = BWTCompressor::compress(inputFile, outputFile, blockOptions.codec.entropy,
+                                                  blockOptions.threads);
+            } else if (mode == "decompress") {
+                if (!BWTCompressor::isValidBWTFile(inputFile)) {
+                    std::cerr << "Warning: Input file may not be a valid BWT compressed file" << std::endl;
+                }
+                success = BWTCompressor::decompress(inputFile, outputFile, blockOptions.threads);
+            }
+        } else if (algorithmId == ALGORITHM_CM) {
+            if (mode == "compress") {
+                success = CMCompressor::compress(inputFile, outputFile, blockOptions.codec.cmMemoryMb);
+            } else if (mode == "decompress") {
+                if (!CMCompressor::isValidCMFile(inputFile)) {
+                    std::cerr << "Warning: Input file may not be a valid context-mixing compressed file" << std::endl;
+                }
+                success = CMCompressor::decompress(inputFile, outputFile);
+            }
+        } else if (algorithmId == ALGORITHM_HUFFMAN_O1) {
+            if (mode == "compress") {
+                success = HuffmanCompressor::compressOrder1(inputFile, outputFile);
+            } else if (mode == "decompress") {
+                if (!HuffmanCompressor::isValidOrder1File(inputFile)) {
+                    std::cerr << "Warning: Input file may not be a valid order-1 Huffman compressed file" << std::endl;
+                }
+                success = HuffmanCompressor::decompressOrder1(inputFile, outputFile);
+            }
+        } else if (algorithmId == ALGORITHM_HUFFMAN_ADAPTIVE && standardStreams) {
+#ifdef _WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            std::ifstream inputStream;
+            std::ofstream outputStream;
+            if (inputFile != "-") {
+                inputStream.open(inputFile, std::ios::binary);
+            }
+            if (outputFile != "-") {
+                outputStream.open(outputFile, std::ios::binary);
+            }
+            std::istream& input = inputFile == "-" ? std::cin : inputStream;
+            std::ostream& output = outputFile == "-" ? std::cout : outputStream;
+            if (!input || !output) {
+                std::cerr << "Error: Cannot open '" << (input ? outputFile : inputFile) << "'" << std::endl;
+            } else if (mode == "compress") {
+                success = HuffmanCompressor::compressStream(input, output, blockOptions.codec.huffmanRebuildInterval);
+            } else if (mode == "decompress") {
+                success = HuffmanCompressor::decompressStream(input, output);
+            }
+        } else if (algorithmId == ALGORITHM_HUFFMAN_ADAPTIVE) {
+            if (mode == "compress") {
+                success = HuffmanCompressor::compressAdaptive(inputFile, outputFile,
+                                                              blockOptions.codec.huffmanRebuildInterval);
+            } else if (mode == "decompress") {
+                if (!HuffmanCompressor::isValidAdaptiveFile(inputFile)) {
+                    std::cerr << "Warning: Input file may not be a valid adaptive Huffman compressed file" << std::endl;
+                }
+                success = HuffmanCompressor::decompressAdaptive(inputFile, outputFile);
+            }
+        } else if (algorithmId == ALGORITHM_AUTO) {
+            std::cerr << "Error: Input is not a block-framed file" << std::endl;
         }
         
         if (success) {
-            std::cout << "Operation completed successfully!" << std::endl;
+            console << "Operation completed successfully!" << std::endl;
             return 0;
         } else {
             std::cerr << "Operation failed!" << std::endl;
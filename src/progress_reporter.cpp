@@ -0,0 +1,65 @@
+#include "progress_reporter.h"
+
+ProgressReporter::ProgressReporter(CompressionProgressCallback callback, void* userData,
+                                   uint32_t intervalMs, uint64_t totalBytes, uint64_t startBytes)
+    : callback_(callback), userData_(userData),
+      interval_(std::chrono::milliseconds(intervalMs > 0 ? intervalMs : COMPRESSION_DEFAULT_PROGRESS_INTERVAL_MS)),
+      totalBytes_(totalBytes), startBytes_(startBytes), processed_(startBytes), lastReportedBytes_(startBytes) {
+    if (callback_) {
+        start_ = lastReport_ = Clock::now();
+    }
+}
+
+void ProgressReporter::advance(uint64_t bytes) {
+    processed_ += bytes;
+    if (!callback_) {
+        return;
+    }
+
+    // Reaching the end is left to finish() so the last report is not doubled.
+    if (processed_ >= totalBytes_) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    if (now - lastReport_ >= interval_) {
+        report(now, false);
+    }
+}
+
+void ProgressReporter::finish() {
+    if (callback_) {
+        report(Clock::now(), true);
+    }
+}
+
+void ProgressReporter::report(Clock::time_point now, bool final) {
+    double sinceLast = std::chrono::duration<double>(now - lastReport_).count();
+    double sinceStart = std::chrono::duration<double>(now - start_).count();
+
+    CompressionProgress progress;
+    progress.bytes_processed = processed_;
+    progress.total_bytes = totalBytes_;
+    // The ETA and the final report use the average rate since the start,
+    // which is steadier than the per-interval throughput.
+    double averageRate = sinceStart > 0 ? static_cast<double>(processed_ - startBytes_) / sinceStart : 0.0;
+    if (final) {
+        progress.throughput_mbps = averageRate / (1024.0 * 1024.0);
+    } else {
+        progress.throughput_mbps = sinceLast > 0
+            ? static_cast<double>(processed_ - lastReportedBytes_) / (1024.0 * 1024.0) / sinceLast
+            : 0.0;
+    }
+
+    if (processed_ >= totalBytes_) {
+        progress.eta_seconds = 0.0;
+    } else if (averageRate > 0) {
+        progress.eta_seconds = static_cast<double>(totalBytes_ - processed_) / averageRate;
+    } else {
+        progress.eta_seconds = -1.0;
+    }
+
+    lastReport_ = now;
+    lastReportedBytes_ = processed_;
+    callback_(&progress, userData_);
+}
@@ -0,0 +1,508 @@
+#include "rans.h"
+#include "ans.h"
+#include "bit_buffer.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RANS_HAVE_AVX2 1
+#define RANS_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define RANS_HAVE_AVX2 1
+#define RANS_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace {
+
+constexpr uint32_t SCALE = 1u << RANSCompressor::SCALE_BITS;
+constexpr uint32_t SLOT_MASK = SCALE - 1;
+constexpr uint32_t LOWER_BOUND = 1u << 16;
+
+// Decode table entry for one slot: frequency - 1 and slot - cumulative
+// frequency in 12 bits each, and the symbol in the top byte, so one lookup
+// (or one gather) yields everything a step needs.
+static_assert(RANSCompressor::SCALE_BITS == 12, "decode table packs 12-bit fields");
+
+uint32_t packEntry(uint32_t frequency, uint32_t bias, uint8_t symbol) {
+    return (frequency - 1) | (bias << 12) | (static_cast<uint32_t>(symbol) << 24);
+}
+
+void writeWord(std::vector<uint8_t>& output, uint16_t word) {
+    output.push_back(static_cast<uint8_t>(word));
+    output.push_back(static_cast<uint8_t>(word >> 8));
+}
+
+// Decodes symbols [position, size) one lane at a time. Returns false if the
+// words run out.
+bool decodeScalar(const uint32_t* table, uint32_t* states, const uint8_t*& ip, const uint8_t* end, uint8_t* output,
+                  size_t position, size_t size) {
+    for (size_t i = position; i < size; i++) {
+        uint32_t& state = states[i % RANSCompressor::LANES];
+        uint32_t entry = table[state & SLOT_MASK];
+        output[i] = static_cast<uint8_t>(entry >> 24);
+        state = ((entry & 0xFFF) + 1) * (state >> RANSCompressor::SCALE_BITS) + ((entry >> 12) & 0xFFF);
+        if (state < LOWER_BOUND) {
+            if (end - ip < 2) {
+                return false;
+            }
+            state = (state << 16) | ip[0] | (static_cast<uint32_t>(ip[1]) << 8);
+            ip += 2;
+        }
+    }
+    return true;
+}
+
+#if defined(RANS_HAVE_AVX2)
+
+// For each mask of lanes needing a refill, the word each lane takes from
+// the next eight (the lanes below it that also refill come first), and how
+// many words are used.
+struct RefillTable {
+    alignas(32) uint32_t permute[256][8];
+    uint8_t count[256];
+
+    RefillTable() {
+        for (unsigned mask = 0; mask < 256; mask++) {
+            unsigned used = 0;
+            for (unsigned lane = 0; lane < 8; lane++) {
+                permute[mask][lane] = used;
+                if (mask & (1u << lane)) {
+                    used++;
+                }
+            }
+            count[mask] = static_cast<uint8_t>(used);
+        }
+    }
+};
+
+const RefillTable& refillTable() {
+    static const RefillTable table;
+    return table;
+}
+
+// Decodes whole groups of eight symbols from position 0 while at least
+// eight words remain, and returns how many symbols it decoded.
+RANS_TARGET_AVX2
+size_t decodeAvx2(const uint32_t* table, uint32_t* states, const uint8_t*& ip, const uint8_t* end, uint8_t* output,
+                  size_t size) {
+    const RefillTable& refill = refillTable();
+    const __m256i slotMask = _mm256_set1_epi32(static_cast<int>(SLOT_MASK));
+    const __m256i fieldMask = _mm256_set1_epi32(0xFFF);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i wordMax = _mm256_set1_epi32(0xFFFF);
+    // Byte 3 of each state-sized entry (the symbol) to the bottom of its
+    // 128-bit half.
+    const __m256i symbolBytes = _mm256_setr_epi8(3, 7, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                                 3, 7, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(states));
+    size_t i = 0;
+    while (i + 8 <= size && end - ip >= 16) {
+        __m256i entry = _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), _mm256_and_si256(x, slotMask), 4);
+        __m256i frequency = _mm256_add_epi32(_mm256_and_si256(entry, fieldMask), one);
+        __m256i bias = _mm256_and_si256(_mm256_srli_epi32(entry, 12), fieldMask);
+        x = _mm256_add_epi32(_mm256_mullo_epi32(frequency, _mm256_srli_epi32(x, RANSCompressor::SCALE_BITS)), bias);
+
+        __m256i symbols = _mm256_shuffle_epi8(entry, symbolBytes);
+        uint32_t low = static_cast<uint32_t>(_mm256_cvtsi256_si32(symbols));
+        uint32_t high = static_cast<uint32_t>(_mm256_extract_epi32(symbols, 4));
+        std::memcpy(output + i, &low, 4);
+        std::memcpy(output + i + 4, &high, 4);
+
+        // x <= 0xFFFF, compared unsigned.
+        __m256i needsRefill = _mm256_cmpeq_epi32(_mm256_min_epu32(x, wordMax), x);
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(needsRefill)));
+        __m256i words = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ip)));
+        words = _mm256_permutevar8x32_epi32(
+            words, _mm256_load_si256(reinterpret_cast<const __m256i*>(refill.permute[mask])));
+        __m256i refilled = _mm256_or_si256(_mm256_slli_epi32(x, 16), words);
+        x = _mm256_blendv_epi8(x, refilled, needsRefill);
+        ip += 2 * refill.count[mask];
+        i += 8;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(states), x);
+    return i;
+}
+
+bool detectAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // The OS must save the YMM registers (OSXSAVE, then XCR0 bits 1-2).
+    if (!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+}
+
+bool RANSCompressor::simdAvailable() {
+#if defined(RANS_HAVE_AVX2)
+    static const bool available = detectAvx2();
+    return available;
+#else
+    return false;
+#endif
+}
+
+bool RANSCompressor::compress(const std::string& inputFile, const std::string& outputFile) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    output.write(MAGIC, sizeof(MAGIC));
+    output.put(static_cast<char>(FORMAT_VERSION));
+
+    std::vector<uint8_t> chunk(CHUNK_SIZE);
+    std::vector<uint8_t> encoded;
+    while (true) {
+        input.read(reinterpret_cast<char*>(chunk.data()), chunk.size());
+        size_t bytesRead = static_cast<size_t>(input.gcount());
+        if (bytesRead == 0) {
+            break;
+        }
+
+        encoded.clear();
+        encode(chunk.data(), bytesRead, encoded);
+        writeU32(output, static_cast<uint32_t>(bytesRead));
+        writeU32(output, static_cast<uint32_t>(encoded.size()));
+        output.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    }
+
+    if (input.bad()) {
+        std::cerr << "Error: Failed reading input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    writeU32(output, 0);
+    writeU32(output, 0);
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Compression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Original size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Compressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool RANSCompressor::decompress(const std::string& inputFile, const std::string& outputFile) {
+    if (!fileExists(inputFile)) {
+        std::cerr << "Error: Input file '" << inputFile << "' does not exist.\n";
+        return false;
+    }
+
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open input file '" << inputFile << "'.\n";
+        return false;
+    }
+
+    char header[sizeof(MAGIC)];
+    int version = 0;
+    if (input.read(header, sizeof(header))) {
+        version = input.get();
+    }
+    if (!input || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || version != FORMAT_VERSION) {
+        std::cerr << "Error: '" << inputFile << "' is not a valid rANS file.\n";
+        return false;
+    }
+
+    std::ofstream output(outputFile, std::ios::binary);
+    if (!output.is_open()) {
+        std::cerr << "Error: Cannot create output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> chunk;
+    while (true) {
+        uint32_t rawSize, encodedSize;
+        if (!readU32(input, rawSize) || !readU32(input, encodedSize)) {
+            std::cerr << "Error: Truncated rANS chunk header.\n";
+            return false;
+        }
+        if (rawSize == 0) {
+            break;
+        }
+        // Stored segments cost one byte more than their input.
+        if (rawSize > CHUNK_SIZE || encodedSize > rawSize + rawSize / SEGMENT_SIZE + 1) {
+            std::cerr << "Error: Corrupt rANS chunk header.\n";
+            return false;
+        }
+
+        payload.resize(encodedSize);
+        if (!input.read(reinterpret_cast<char*>(payload.data()), encodedSize)) {
+            std::cerr << "Error: Truncated rANS chunk.\n";
+            return false;
+        }
+
+        chunk.resize(rawSize);
+        if (!decode(payload.data(), payload.size(), chunk.data(), rawSize)) {
+            std::cerr << "Error: Corrupt rANS data.\n";
+            return false;
+        }
+        output.write(reinterpret_cast<const char*>(chunk.data()), rawSize);
+    }
+
+    if (!output) {
+        std::cerr << "Error: Failed writing output file '" << outputFile << "'.\n";
+        return false;
+    }
+
+    input.close();
+    output.close();
+
+    std::cout << "Decompression completed: " << inputFile << " -> " << outputFile << "\n";
+    std::cout << "Compressed size: " << getFileSize(inputFile) << " bytes\n";
+    std::cout << "Decompressed size: " << getFileSize(outputFile) << " bytes\n";
+
+    return true;
+}
+
+bool RANSCompressor::isValidRANSFile(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    return input.read(magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool RANSCompressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+    output.clear();
+    writeVarint(output, input.size());
+    encode(input.data(), input.size(), output);
+    return true;
+}
+
+bool RANSCompressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output,
+                                     size_t maxSize) {
+    const uint8_t* ip = input.data();
+    const uint8_t* end = ip + input.size();
+    uint64_t rawSize;
+    // Every segment takes at least four bytes.
+    if (!readVarint(ip, end, rawSize) || rawSize > maxSize ||
+        rawSize > (static_cast<uint64_t>(input.size()) / 4 + 1) * SEGMENT_SIZE) {
+        return false;
+    }
+
+    output.resize(static_cast<size_t>(rawSize));
+    return decode(ip, static_cast<size_t>(end - ip), output.data(), output.size());
+}
+
+void RANSCompressor::encode(const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+    for (size_t offset = 0; offset < size; offset += SEGMENT_SIZE) {
+        size_t segment = std::min(SEGMENT_SIZE, size - offset);
+        if (!encodeSegment(data + offset, segment, output)) {
+            output.push_back(MODE_STORED);
+            output.insert(output.end(), data + offset, data + offset + segment);
+        }
+    }
+}
+
+bool RANSCompressor::decode(const uint8_t* input, size_t inputSize, uint8_t* output, size_t rawSize) {
+    const uint8_t* ip = input;
+    const uint8_t* end = input + inputSize;
+    for (size_t offset = 0; offset < rawSize; offset += SEGMENT_SIZE) {
+        if (!decodeSegment(ip, end, output + offset, std::min(SEGMENT_SIZE, rawSize - offset))) {
+            return false;
+        }
+    }
+    return ip == end;
+}
+
+bool RANSCompressor::encodeSegment(const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+    uint32_t counts[256] = {0};
+    for (size_t i = 0; i < size; i++) {
+        counts[data[i]]++;
+    }
+    unsigned maxSymbol = 0;
+    for (unsigned s = 0; s < 256; s++) {
+        if (counts[s] > 0) {
+            maxSymbol = s;
+        }
+    }
+
+    uint32_t frequencies[256];
+    ANSCompressor::normalizeCounts(counts, maxSymbol, size, SCALE_BITS, frequencies);
+    uint32_t cumulative[256];
+    uint32_t total = 0;
+    for (unsigned s = 0; s <= maxSymbol; s++) {
+        cumulative[s] = total;
+        total += frequencies[s];
+    }
+
+    const size_t start = output.size();
+    output.push_back(MODE_RANS);
+    output.push_back(static_cast<uint8_t>(maxSymbol));
+    for (unsigned s = 0; s <= maxSymbol; s++) {
+        writeVarint(output, frequencies[s]);
+    }
+
+    // Symbols are encoded last to first, so the words come out in reverse
+    // decoding order.
+    std::vector<uint16_t> words;
+    words.reserve(size / 2 + LANES);
+    uint32_t states[LANES];
+    std::fill(states, states + LANES, LOWER_BOUND);
+    for (size_t i = size; i-- > 0;) {
+        uint32_t& state = states[i % LANES];
+        uint8_t symbol = data[i];
+        uint32_t frequency = frequencies[symbol];
+        // Largest state that stays below 2^32 after encoding.
+        uint64_t limit = static_cast<uint64_t>((LOWER_BOUND >> SCALE_BITS) << 16) * frequency;
+        if (state >= limit) {
+            words.push_back(static_cast<uint16_t>(state));
+            state >>= 16;
+        }
+        state = ((state / frequency) << SCALE_BITS) + (state % frequency) + cumulative[symbol];
+    }
+
+    const size_t streamSize = LANES * 4 + words.size() * 2;
+    writeVarint(output, streamSize);
+    if (output.size() - start + streamSize >= size + 1) {
+        output.resize(start);
+        return false;
+    }
+    for (uint32_t state : states) {
+        writeWord(output, static_cast<uint16_t>(state));
+        writeWord(output, static_cast<uint16_t>(state >> 16));
+    }
+    for (size_t i = words.size(); i-- > 0;) {
+        writeWord(output, words[i]);
+    }
+    return true;
+}
+
+bool RANSCompressor::decodeSegment(const uint8_t*& ip, const uint8_t* end, uint8_t* output, size_t size) {
+    if (ip == end) {
+        return false;
+    }
+    uint8_t mode = *ip++;
+    if (mode == MODE_STORED) {
+        if (static_cast<size_t>(end - ip) < size) {
+            return false;
+        }
+        std::memcpy(output, ip, size);
+        ip += size;
+        return true;
+    }
+    if (mode != MODE_RANS || ip == end) {
+        return false;
+    }
+
+    const unsigned maxSymbol = *ip++;
+    std::vector<uint32_t> table(SCALE);
+    uint32_t cumulative = 0;
+    for (unsigned s = 0; s <= maxSymbol; s++) {
+        uint64_t frequency;
+        if (!readVarint(ip, end, frequency) || frequency > SCALE - cumulative) {
+            return false;
+        }
+        for (uint32_t slot = cumulative; slot < cumulative + frequency; slot++) {
+            table[slot] = packEntry(static_cast<uint32_t>(frequency), slot - cumulative, static_cast<uint8_t>(s));
+        }
+        cumulative += static_cast<uint32_t>(frequency);
+    }
+    uint64_t streamSize;
+    if (cumulative != SCALE || !readVarint(ip, end, streamSize) || streamSize > static_cast<uint64_t>(end - ip) ||
+        streamSize < LANES * 4 || streamSize % 2 != 0) {
+        return false;
+    }
+
+    const uint8_t* stream = ip;
+    const uint8_t* streamEnd = ip + streamSize;
+    uint32_t states[LANES];
+    for (unsigned lane = 0; lane < LANES; lane++) {
+        states[lane] = static_cast<uint32_t>(stream[0]) | (static_cast<uint32_t>(stream[1]) << 8) |
+                       (static_cast<uint32_t>(stream[2]) << 16) | (static_cast<uint32_t>(stream[3]) << 24);
+        stream += 4;
+        if (states[lane] < LOWER_BOUND) {
+            return false;
+        }
+    }
+
+    size_t decoded = 0;
+#if defined(RANS_HAVE_AVX2)
+    if (simdAvailable()) {
+        decoded = decodeAvx2(table.data(), states, stream, streamEnd, output, size);
+    }
+#endif
+    if (!decodeScalar(table.data(), states, stream, streamEnd, output, decoded, size)) {
+        return false;
+    }
+
+    // Every lane must have returned to the encoder's initial state.
+    for (uint32_t state : states) {
+        if (state != LOWER_BOUND) {
+            return false;
+        }
+    }
+    ip = streamEnd;
+    return stream == streamEnd;
+}
+
+void RANSCompressor::writeU32(std::ofstream& output, uint32_t value) {
+    unsigned char bytes[4] = {
+        static_cast<unsigned char>(value & 0xFF),
+        static_cast<unsigned char>((value >> 8) & 0xFF),
+        static_cast<unsigned char>((value >> 16) & 0xFF),
+        static_cast<unsigned char>((value >> 24) & 0xFF)
+    };
+    output.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+bool RANSCompressor::readU32(std::ifstream& input, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!input.read(reinterpret_cast<char*>(bytes), sizeof(bytes))) {
+        return false;
+    }
+    value = static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+            (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    return true;
+}
+
+bool RANSCompressor::fileExists(const std::string& filename) {
+    return std::filesystem::exists(filename);
+}
+
+size_t RANSCompressor::getFileSize(const std::string& filename) {
+    try {
+        return std::filesystem::file_size(filename);
+    } catch (const std::filesystem::filesystem_error&) {
+        return 0;
+    }
+}
@@ -0,0 +1,43 @@
+#include "rate_limiter.h"
+#include <algorithm>
+#include <thread>
+
+RateLimiter::RateLimiter(double ratePerSecond)
+    : rate_(std::max(ratePerSecond, 0.0)), burst_(rate_ / 10.0), tokens_(burst_), last_(Clock::now()) {}
+
+void RateLimiter::consume(double amount) {
+    if (enabled()) {
+        take(amount);
+    }
+}
+
+bool RateLimiter::acquire(double amount, const std::atomic<bool>* cancelled) {
+    if (!enabled()) {
+        return true;
+    }
+
+    double wait = take(amount);
+
+    // Sleep in short slices so cancellation is noticed promptly.
+    const double slice = 0.05;
+    while (wait > 0) {
+        if (cancelled && cancelled->load()) {
+            return false;
+        }
+        double step = std::min(wait, slice);
+        std::this_thread::sleep_for(std::chrono::duration<double>(step));
+        wait -= step;
+    }
+    return true;
+}
+
+double RateLimiter::take(double amount) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+    double elapsed = std::chrono::duration<double>(now - last_).count();
+    last_ = now;
+
+    tokens_ = std::min(burst_, tokens_ + elapsed * rate_);
+    tokens_ -= amount;
+    return tokens_ < 0 ? -tokens_ / rate_ : 0.0;
+}
@@ -110,6 +110,44 @@ bool RLECompressor::isValidRLEFile(const std::string& filename) {
     return true;
 }
 
+bool RLECompressor::compressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output) {
+    output.clear();
+    
+    size_t i = 0;
+    while (i < input.size()) {
+        uint8_t character = input[i];
+        size_t run = 1;
+        while (i + run < input.size() && input[i + run] == character && run < MAX_RUN_LENGTH) {
+            run++;
+        }
+        
+        output.push_back(static_cast<uint8_t>(run));
+        output.push_back(character);
+        i += run;
+    }
+    
+    return true;
+}
+
+bool RLECompressor::decompressBlock(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, size_t maxSize) {
+    output.clear();
+    
+    if (input.size() % 2 != 0) {
+        std::cerr << "Error: Truncated RLE block.\n";
+        return false;
+    }
+    
+    for (size_t i = 0; i < input.size(); i += 2) {
+        if (input[i] > maxSize - output.size()) {
+            std::cerr << "Error: RLE block decodes to more than " << maxSize << " bytes.\n";
+            return false;
+        }
+        output.insert(output.end(), input[i], input[i + 1]);
+    }
+    
+    return true;
+}
+
 void RLECompressor::writeRunLength(std::ofstream& output, unsigned char count, unsigned char character) {
     output.write(reinterpret_cast<const char*>(&count), 1);
     output.write(reinterpret_cast<const char*>(&character), 1);
@@ -0,0 +1,161 @@
+#include "suffix_array.h"
+#include <algorithm>
+
+namespace {
+
+// SA-IS over an integer string with symbols in [0, upper]. Suffixes are
+// classified as S-type (smaller than the next suffix) or L-type; sorting
+// the leftmost S-type (LMS) positions is enough to induce the order of all
+// the others, and the LMS substrings are sorted by recursing on their names.
+std::vector<int32_t> inducedSort(const std::vector<int32_t>& s, int32_t upper) {
+    const int32_t n = static_cast<int32_t>(s.size());
+    if (n == 0) {
+        return {};
+    }
+    if (n == 1) {
+        return {0};
+    }
+    if (n == 2) {
+        return s[0] < s[1] ? std::vector<int32_t>{0, 1} : std::vector<int32_t>{1, 0};
+    }
+
+    std::vector<int32_t> sa(n);
+    std::vector<bool> sType(n, false);
+    for (int32_t i = n - 2; i >= 0; i--) {
+        sType[i] = s[i] == s[i + 1] ? sType[i + 1] : s[i] < s[i + 1];
+    }
+
+    // Bucket starts: L-type suffixes fill each bucket from the front,
+    // S-type ones from the back.
+    std::vector<int32_t> lStart(upper + 1, 0);
+    std::vector<int32_t> sStart(upper + 1, 0);
+    for (int32_t i = 0; i < n; i++) {
+        if (!sType[i]) {
+            sStart[s[i]]++;
+        } else {
+            lStart[s[i] + 1]++;
+        }
+    }
+    for (int32_t c = 0; c <= upper; c++) {
+        sStart[c] += lStart[c];
+        if (c < upper) {
+            lStart[c + 1] += sStart[c];
+        }
+    }
+
+    std::vector<int32_t> bucket(upper + 1);
+    auto induce = [&](const std::vector<int32_t>& lms) {
+        std::fill(sa.begin(), sa.end(), -1);
+        std::copy(sStart.begin(), sStart.end(), bucket.begin());
+        for (int32_t position : lms) {
+            if (position != n) {
+                sa[bucket[s[position]]++] = position;
+            }
+        }
+        std::copy(lStart.begin(), lStart.end(), bucket.begin());
+        sa[bucket[s[n - 1]]++] = n - 1;
+        for (int32_t i = 0; i < n; i++) {
+            int32_t position = sa[i];
+            if (position >= 1 && !sType[position - 1]) {
+                sa[bucket[s[position - 1]]++] = position - 1;
+            }
+        }
+        std::copy(lStart.begin(), lStart.end(), bucket.begin());
+        for (int32_t i = n - 1; i >= 0; i--) {
+            int32_t position = sa[i];
+            if (position >= 1 && sType[position - 1]) {
+                sa[--bucket[s[position - 1] + 1]] = position - 1;
+            }
+        }
+    };
+
+    std::vector<int32_t> lmsIndex(n + 1, -1);
+    std::vector<int32_t> lms;
+    for (int32_t i = 1; i < n; i++) {
+        if (!sType[i - 1] && sType[i]) {
+            lmsIndex[i] = static_cast<int32_t>(lms.size());
+            lms.push_back(i);
+        }
+    }
+    const int32_t lmsCount = static_cast<int32_t>(lms.size());
+
+    induce(lms);
+
+    if (lmsCount > 0) {
+        std::vector<int32_t> sortedLms;
+        sortedLms.reserve(lmsCount);
+        for (int32_t position : sa) {
+            if (lmsIndex[position] != -1) {
+                sortedLms.push_back(position);
+            }
+        }
+
+        // Name each LMS substring by its rank among distinct substrings.
+        std::vector<int32_t> reduced(lmsCount);
+        int32_t names = 0;
+        reduced[lmsIndex[sortedLms[0]]] = 0;
+        for (int32_t i = 1; i < lmsCount; i++) {
+            int32_t left = sortedLms[i - 1];
+            int32_t right = sortedLms[i];
+            int32_t leftEnd = lmsIndex[left] + 1 < lmsCount ? lms[lmsIndex[left] + 1] : n;
+            int32_t rightEnd = lmsIndex[right] + 1 < lmsCount ? lms[lmsIndex[right] + 1] : n;
+            bool same = leftEnd - left == rightEnd - right;
+            if (same) {
+                while (left < leftEnd && s[left] == s[right]) {
+                    left++;
+                    right++;
+                }
+                same = left != n && right != n && s[left] == s[right];
+            }
+            if (!same) {
+                names++;
+            }
+            reduced[lmsIndex[sortedLms[i]]] = names;
+        }
+
+        std::vector<int32_t> reducedSa = inducedSort(reduced, names);
+        for (int32_t i = 0; i < lmsCount; i++) {
+            sortedLms[i] = lms[reducedSa[i]];
+        }
+        induce(sortedLms);
+    }
+    return sa;
+}
+
+}
+
+std::vector<int32_t> SuffixArray::build(const uint8_t* data, size_t size) {
+    std::vector<int32_t> symbols(data, data + size);
+    return inducedSort(symbols, 255);
+}
+
+std::vector<int32_t> SuffixArray::inverse(const std::vector<int32_t>& sa) {
+    std::vector<int32_t> rank(sa.size());
+    for (size_t i = 0; i < sa.size(); i++) {
+        rank[sa[i]] = static_cast<int32_t>(i);
+    }
+    return rank;
+}
+
+std::vector<int32_t> SuffixArray::buildLcp(const uint8_t* data, const std::vector<int32_t>& sa,
+                                           const std::vector<int32_t>& rank) {
+    const size_t n = sa.size();
+    std::vector<int32_t> lcp(n, 0);
+    // Moving from suffix i to i + 1 loses at most one matched byte.
+    size_t matched = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (matched > 0) {
+            matched--;
+        }
+        if (rank[i] == 0) {
+            matched = 0;
+            continue;
+        }
+        size_t previous = static_cast<size_t>(sa[rank[i] - 1]);
+        while (i + matched < n && previous + matched < n && data[i + matched] == data[previous + matched]) {
+            matched++;
+        }
+        lcp[rank[i]] = static_cast<int32_t>(matched);
+    }
+    return lcp;
+}
@@ -0,0 +1,359 @@
+#include "thread_pool.h"
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+thread_local ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+std::mutex instanceMutex;
+std::unique_ptr<ThreadPool> sharedPool;
+size_t configuredThreads = 0;
+bool configuredPinning = false;
+
+// CPUs in the process affinity mask, in ascending order; empty when unknown.
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+size_t quotaToCpus(double quota, double period) {
+    if (quota <= 0 || period <= 0) {
+        return 0;
+    }
+    size_t cpus = static_cast<size_t>((quota + period - 1) / period);
+    return cpus > 0 ? cpus : 1;
+}
+
+// cgroup v2 "cpu.max" holds "<quota> <period>" or "max <period>".
+size_t readCpuMax(const std::string& path) {
+    std::ifstream file(path);
+    std::string quota;
+    double period = 0;
+    if (!(file >> quota >> period) || quota == "max") {
+        return 0;
+    }
+    try {
+        return quotaToCpus(std::stod(quota), period);
+    } catch (...) {
+        return 0;
+    }
+}
+
+// cgroup v1 splits the same limit over two files; a quota of -1 means none.
+size_t readCfsQuota(const std::string& directory) {
+    std::ifstream quotaFile(directory + "/cpu.cfs_quota_us");
+    std::ifstream periodFile(directory + "/cpu.cfs_period_us");
+    double quota = 0;
+    double period = 0;
+    if (!(quotaFile >> quota) || !(periodFile >> period)) {
+        return 0;
+    }
+    return quotaToCpus(quota, period);
+}
+
+// Tightest CPU quota on the way from our cgroup up to the root; 0 when the
+// process is not limited.
+size_t cgroupCpuLimit() {
+#if defined(__linux__)
+    std::ifstream cgroups("/proc/self/cgroup");
+    std::string line;
+    size_t limit = 0;
+    auto tighten = [&limit](size_t cpus) {
+        if (cpus > 0 && (limit == 0 || cpus < limit)) {
+            limit = cpus;
+        }
+    };
+
+    while (std::getline(cgroups, line)) {
+        size_t first = line.find(':');
+        size_t second = line.find(':', first + 1);
+        if (first == std::string::npos || second == std::string::npos) {
+            continue;
+        }
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        std::string path = line.substr(second + 1);
+
+        std::string root;
+        bool unified = controllers.empty();
+        if (unified) {
+            root = "/sys/fs/cgroup";
+        } else if (("," + controllers + ",").find(",cpu,") != std::string::npos) {
+            root = "/sys/fs/cgroup/" + controllers;
+        } else {
+            continue;
+        }
+
+        while (true) {
+            std::string directory = root + (path == "/" ? "" : path);
+            tighten(unified ? readCpuMax(directory + "/cpu.max") : readCfsQuota(directory));
+            if (path.empty() || path == "/") {
+                break;
+            }
+            size_t slash = path.rfind('/');
+            path = slash == 0 || slash == std::string::npos ? "/" : path.substr(0, slash);
+        }
+    }
+    return limit;
+#else
+    return 0;
+#endif
+}
+
+}
+
+ThreadPool::ThreadPool(size_t threadCount, bool pinWorkers) : queuedTasks_(0), stopping_(false) {
+    if (threadCount == 0) {
+        threadCount = defaultThreadCount();
+    }
+    if (pinWorkers) {
+        pinnedCpus_ = allowedCpus();
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (size_t i = 0; i < threadCount; i++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (!sharedPool) {
+        sharedPool = std::make_unique<ThreadPool>(configuredThreads, configuredPinning);
+    }
+    return *sharedPool;
+}
+
+bool ThreadPool::configure(size_t threadCount, bool pinWorkers) {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (sharedPool) {
+        size_t requested = threadCount == 0 ? defaultThreadCount() : threadCount;
+        return sharedPool->size() == requested && sharedPool->pinnedCpus_.empty() != pinWorkers;
+    }
+    configuredThreads = threadCount;
+    configuredPinning = pinWorkers;
+    return true;
+}
+
+size_t ThreadPool::defaultThreadCount() {
+    // hardware_concurrency() reports every host core, even inside a
+    // container limited to a fraction of them.
+    size_t count = std::thread::hardware_concurrency();
+
+    size_t allowed = allowedCpus().size();
+    if (allowed > 0 && (count == 0 || allowed < count)) {
+        count = allowed;
+    }
+
+    size_t quota = cgroupCpuLimit();
+    if (quota > 0 && (count == 0 || quota < count)) {
+        count = quota;
+    }
+
+    return count > 0 ? count : 1;
+}
+
+void ThreadPool::submit(Task task) {
+    // Count before publishing so the counter never dips below the number of
+    // tasks actually sitting in the queues.
+    queuedTasks_++;
+    if (currentPool == this) {
+        WorkQueue& own = *queues_[currentWorker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.tasks.push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(injectQueue_.mutex);
+        injectQueue_.tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wakeup_.notify_one();
+}
+
+bool ThreadPool::runPendingTask() {
+    Task task;
+    if (!takeTask(task)) {
+        return false;
+    }
+    runTask(task);
+    return true;
+}
+
+size_t ThreadPool::size() const {
+    return workers_.size();
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+    pinCurrentWorker(index);
+
+    while (true) {
+        Task task;
+        if (takeTask(task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeup_.wait(lock, [this] { return stopping_ || queuedTasks_.load() > 0; });
+        if (stopping_ && queuedTasks_.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::pinCurrentWorker(size_t index) {
+    if (pinnedCpus_.empty()) {
+        return;
+    }
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(pinnedCpus_[index % pinnedCpus_.size()], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)index;
+#endif
+}
+
+void ThreadPool::runTask(Task& task) {
+    try {
+        task();
+    } catch (...) {
+        // Raw submissions have nobody to report to; TaskGroup captures
+        // exceptions before they get here.
+    }
+}
+
+bool ThreadPool::takeTask(Task& task) {
+    if (queuedTasks_.load() == 0) {
+        return false;
+    }
+
+    size_t start = 0;
+    if (currentPool == this) {
+        if (popBack(*queues_[currentWorker], task)) {
+            return true;
+        }
+        start = currentWorker + 1;
+    }
+
+    if (popFront(injectQueue_, task)) {
+        return true;
+    }
+
+    for (size_t i = 0; i < queues_.size(); i++) {
+        if (popFront(*queues_[(start + i) % queues_.size()], task)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPool::popBack(WorkQueue& queue, Task& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queuedTasks_--;
+    return true;
+}
+
+bool ThreadPool::popFront(WorkQueue& queue, Task& task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    queuedTasks_--;
+    return true;
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool) : pool_(pool), pending_(0) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::run(ThreadPool::Task task) {
+    pending_++;
+    pool_.submit([this, task = std::move(task)]() {
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+
+        // Decrement under the lock so wait() cannot return and destroy the
+        // group while this task is still touching it.
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0) {
+            done_.notify_all();
+        }
+    });
+}
+
+void TaskGroup::wait() {
+    while (pending_.load() > 0) {
+        if (pool_.runPendingTask()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait_for(lock, std::chrono::milliseconds(1), [this] { return pending_.load() == 0; });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(error, error_);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,250 @@
+#include "transform_chain.h"
+#include "block_codec.h"
+#include "bwt.h"
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+struct StageName {
+    const char* name;
+    uint8_t stage;
+};
+
+const StageName STAGE_NAMES[] = {
+    {"rle", ALGORITHM_RLE},
+    {"huffman", ALGORITHM_HUFFMAN},
+    {"lzw", ALGORITHM_LZW},
+    {"lz77", ALGORITHM_LZ77},
+    {"lzh", ALGORITHM_LZH},
+    {"ans", ALGORITHM_ANS},
+    {"rans", ALGORITHM_RANS},
+    {"bwt", ALGORITHM_BWT},
+    {"cm", ALGORITHM_CM},
+    {"huffman1", ALGORITHM_HUFFMAN_O1},
+    {"ahuffman", ALGORITHM_HUFFMAN_ADAPTIVE},
+    {"rle-huffman", ALGORITHM_RLE_HUFFMAN},
+    {"delta4-rle-huffman", ALGORITHM_DELTA_RLE_HUFFMAN},
+    {"mtf", TransformChain::MTF_STAGE},
+    {"delta", TransformChain::DELTA_STAGE},
+    {"bwt-raw", TransformChain::BWT_RAW_STAGE},
+};
+
+// Selects ALGORITHM_AUTO; not a stage.
+const char* const AUTO_NAME = "auto";
+
+}
+
+bool TransformChain::parse(const std::string& spec, std::vector<uint8_t>& stages) {
+    stages.clear();
+    size_t start = 0;
+    while (true) {
+        size_t plus = spec.find('+', start);
+        uint8_t stage;
+        if (!stageId(spec.substr(start, plus == std::string::npos ? std::string::npos : plus - start), stage)) {
+            return false;
+        }
+        stages.push_back(stage);
+        if (plus == std::string::npos) {
+            break;
+        }
+        start = plus + 1;
+    }
+    return isValid(stages);
+}
+
+std::string TransformChain::format(const std::vector<uint8_t>& stages) {
+    std::string spec;
+    for (uint8_t stage : stages) {
+        const char* name = "?";
+        for (const StageName& entry : STAGE_NAMES) {
+            if (entry.stage == stage) {
+                name = entry.name;
+            }
+        }
+        if (!spec.empty()) {
+            spec += '+';
+        }
+        spec += name;
+    }
+    return spec;
+}
+
+bool TransformChain::isValid(const std::vector<uint8_t>& stages) {
+    if (stages.empty() || stages.size() > MAX_STAGES) {
+        return false;
+    }
+    for (uint8_t stage : stages) {
+        if (!isCodecStage(stage) && stage != MTF_STAGE && stage != DELTA_STAGE && stage != BWT_RAW_STAGE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TransformChain::stageId(const std::string& name, uint8_t& stage) {
+    for (const StageName& entry : STAGE_NAMES) {
+        if (name == entry.name) {
+            stage = entry.stage;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TransformChain::algorithmId(const std::string& name, CompressionAlgorithm& algorithm) {
+    uint8_t stage;
+    if (name == AUTO_NAME) {
+        algorithm = ALGORITHM_AUTO;
+    } else if (name.find('+') != std::string::npos) {
+        algorithm = ALGORITHM_CHAIN;
+    } else if (stageId(name, stage) && isCodecStage(stage)) {
+        algorithm = static_cast<CompressionAlgorithm>(stage);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> TransformChain::algorithmNames() {
+    std::vector<std::string> names;
+    for (const StageName& entry : STAGE_NAMES) {
+        if (isCodecStage(entry.stage)) {
+            names.push_back(entry.name);
+        }
+    }
+    names.push_back(AUTO_NAME);
+    return names;
+}
+
+bool TransformChain::encode(const std::vector<uint8_t>& stages, const std::vector<uint8_t>& input,
+                            std::vector<uint8_t>& output, const CodecParams& params) {
+    if (!isValid(stages)) {
+        return false;
+    }
+
+    std::vector<size_t> limits = stageLimits(stages, input.size());
+    output = input;
+    std::vector<uint8_t> next;
+    for (size_t i = 0; i < stages.size(); i++) {
+        uint8_t stage = stages[i];
+        if (stage == MTF_STAGE) {
+            moveToFront(output);
+            continue;
+        }
+        if (stage == DELTA_STAGE) {
+            delta(output);
+            continue;
+        }
+        bool ok = stage == BWT_RAW_STAGE
+            ? BWTCompressor::transformBlock(output, next)
+            : BlockCodec::encode(static_cast<CompressionAlgorithm>(stage), output, next, params);
+        if (!ok) {
+            return false;
+        }
+        output.swap(next);
+        if (i + 1 < stages.size() && output.size() > limits[i + 1]) {
+            output = input;
+            return true;
+        }
+    }
+    return true;
+}
+
+bool TransformChain::decode(const std::vector<uint8_t>& stages, const std::vector<uint8_t>& input,
+                            std::vector<uint8_t>& output, size_t maxSize) {
+    if (!isValid(stages)) {
+        return false;
+    }
+
+    std::vector<size_t> limits = stageLimits(stages, maxSize);
+    output = input;
+    std::vector<uint8_t> next;
+    for (size_t i = stages.size(); i-- > 0;) {
+        uint8_t stage = stages[i];
+        if (isSizePreserving(stage)) {
+            if (output.size() > limits[i]) {
+                return false;
+            }
+            if (stage == MTF_STAGE) {
+                inverseMoveToFront(output);
+            } else {
+                inverseDelta(output);
+            }
+            continue;
+        }
+        bool ok = stage == BWT_RAW_STAGE
+            ? BWTCompressor::inverseTransformBlock(output, next)
+            : BlockCodec::decode(static_cast<CompressionAlgorithm>(stage), output, next, limits[i]);
+        if (!ok || next.size() > limits[i]) {
+            return false;
+        }
+        output.swap(next);
+    }
+    return true;
+}
+
+std::vector<size_t> TransformChain::stageLimits(const std::vector<uint8_t>& stages, size_t maxSize) {
+    const size_t largest = std::numeric_limits<size_t>::max();
+    std::vector<size_t> limits(stages.size(), maxSize);
+    for (size_t i = 1; i < stages.size(); i++) {
+        if (isSizePreserving(stages[i - 1])) {
+            limits[i] = limits[i - 1];
+        } else {
+            limits[i] = limits[i - 1] > (largest - STAGE_SLACK) / 2 ? largest : limits[i - 1] * 2 + STAGE_SLACK;
+        }
+    }
+    return limits;
+}
+
+bool TransformChain::isSizePreserving(uint8_t stage) {
+    return stage == MTF_STAGE || stage == DELTA_STAGE;
+}
+
+bool TransformChain::isCodecStage(uint8_t stage) {
+    CompressionAlgorithm algorithm = static_cast<CompressionAlgorithm>(stage);
+    return algorithm != ALGORITHM_CHAIN && BlockCodec::isSupported(algorithm);
+}
+
+void TransformChain::moveToFront(std::vector<uint8_t>& data) {
+    uint8_t order[256];
+    std::iota(order, order + 256, 0);
+    for (uint8_t& c : data) {
+        unsigned rank = 0;
+        while (order[rank] != c) {
+            rank++;
+        }
+        std::memmove(order + 1, order, rank);
+        order[0] = c;
+        c = static_cast<uint8_t>(rank);
+    }
+}
+
+void TransformChain::inverseMoveToFront(std::vector<uint8_t>& data) {
+    uint8_t order[256];
+    std::iota(order, order + 256, 0);
+    for (uint8_t& rank : data) {
+        uint8_t c = order[rank];
+        std::memmove(order + 1, order, rank);
+        order[0] = c;
+        rank = c;
+    }
+}
+
+void TransformChain::delta(std::vector<uint8_t>& data) {
+    uint8_t previous = 0;
+    for (uint8_t& c : data) {
+        uint8_t current = c;
+        c = static_cast<uint8_t>(current - previous);
+        previous = current;
+    }
+}
+
+void TransformChain::inverseDelta(std::vector<uint8_t>& data) {
+    uint8_t previous = 0;
+    for (uint8_t& c : data) {
+        previous = static_cast<uint8_t>(previous + c);
+        c = previous;
+    }
+}
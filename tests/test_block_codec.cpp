@@ -0,0 +1,164 @@
+#include "block_codec.h"
+#include "transform_chain.h"
+#include "test_util.h"
+
+// In-memory round trips of every block codec, with and without history, of
+// transform chains, and the raw-size bound the container relies on.
+
+namespace {
+
+struct Sample {
+    const char* name;
+    std::vector<uint8_t> data;
+};
+
+std::vector<Sample> samples() {
+    return {
+        {"text", test::textData(150000)},
+        {"runs", test::runData(100000)},
+        {"counters", test::counterData(80000)},
+        {"random", test::randomData(20000)},
+        {"single byte", std::vector<uint8_t>(1, 'x')},
+    };
+}
+
+const CompressionAlgorithm CODECS[] = {
+    ALGORITHM_RLE, ALGORITHM_HUFFMAN, ALGORITHM_LZW, ALGORITHM_LZ77, ALGORITHM_LZH, ALGORITHM_ANS,
+    ALGORITHM_RANS, ALGORITHM_BWT, ALGORITHM_CM, ALGORITHM_HUFFMAN_O1, ALGORITHM_HUFFMAN_ADAPTIVE,
+    ALGORITHM_RLE_HUFFMAN, ALGORITHM_DELTA_RLE_HUFFMAN,
+};
+
+std::string label(CompressionAlgorithm algorithm, const CodecParams& params, const std::string& what) {
+    std::string name = algorithm == ALGORITHM_CHAIN ? TransformChain::format(params.chain)
+                                                    : std::to_string(static_cast<int>(algorithm));
+    return "algorithm " + name + " " + what;
+}
+
+void testRoundTrip(CompressionAlgorithm algorithm, const CodecParams& params, const Sample& sample) {
+    std::string context = label(algorithm, params, sample.name);
+    std::vector<uint8_t> encoded;
+    CHECK_CONTEXT(BlockCodec::encode(algorithm, sample.data, encoded, params), context);
+
+    // A chain leaves a block it cannot bound as it is, for the container to store.
+    if (algorithm == ALGORITHM_CHAIN && encoded == sample.data) {
+        return;
+    }
+
+    std::vector<uint8_t> decoded;
+    CHECK_CONTEXT(BlockCodec::decode(algorithm, encoded, decoded, sample.data.size(), params), context);
+    CHECK_CONTEXT(decoded == sample.data, context);
+
+    decoded.clear();
+    CHECK_CONTEXT(!BlockCodec::decode(algorithm, encoded, decoded, sample.data.size() - 1, params),
+                  context + " bounded");
+}
+
+void testHistory(CompressionAlgorithm algorithm, const CodecParams& params) {
+    std::vector<uint8_t> data = test::textData(120000, 7);
+    size_t historySize = 60000;
+    std::vector<uint8_t> encoded;
+    CHECK_CONTEXT(BlockCodec::encode(algorithm, data, encoded, params, historySize), label(algorithm, params, "history"));
+
+    std::vector<uint8_t> decoded(data.begin(), data.begin() + historySize);
+    CHECK_CONTEXT(BlockCodec::decode(algorithm, encoded, decoded, data.size() - historySize, params, historySize),
+                  label(algorithm, params, "history"));
+    CHECK_CONTEXT(decoded == data, label(algorithm, params, "history"));
+
+    // Priming must pay off on input that repeats what came before.
+    std::vector<uint8_t> repeated(data.begin(), data.begin() + historySize);
+    repeated.insert(repeated.end(), data.begin(), data.begin() + historySize);
+    std::vector<uint8_t> primed;
+    std::vector<uint8_t> unprimed;
+    std::vector<uint8_t> second(repeated.begin() + historySize, repeated.end());
+    CHECK(BlockCodec::encode(algorithm, repeated, primed, params, historySize));
+    CHECK(BlockCodec::encode(algorithm, second, unprimed, params));
+    CHECK_CONTEXT(primed.size() < unprimed.size() / 4, label(algorithm, params, "history ratio"));
+}
+
+// Garbage must fail cleanly or stay within the bound; it must never crash
+// or allocate what a forged size asks for.
+void testGarbage(CompressionAlgorithm algorithm, const CodecParams& params) {
+    for (uint32_t seed = 1; seed <= 8; ++seed) {
+        std::vector<uint8_t> garbage = test::randomData(64 + seed * 512, seed);
+        std::vector<uint8_t> decoded;
+        size_t maxSize = 1 << 16;
+        if (BlockCodec::decode(algorithm, garbage, decoded, maxSize, params)) {
+            CHECK_CONTEXT(decoded.size() <= maxSize, label(algorithm, params, "garbage"));
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::vector<Sample> inputs = samples();
+
+    for (CompressionAlgorithm algorithm : CODECS) {
+        CHECK(BlockCodec::isSupported(algorithm));
+        CodecParams params;
+        params.cmMemoryMb = 4;
+        for (const Sample& sample : inputs) {
+            testRoundTrip(algorithm, params, sample);
+        }
+        testGarbage(algorithm, params);
+    }
+    CHECK(!BlockCodec::isSupported(ALGORITHM_AUTO));
+
+    // Encoder settings that change the format or the parse.
+    for (CompressionAlgorithm algorithm : {ALGORITHM_LZ77, ALGORITHM_LZH}) {
+        for (uint32_t level : {1u, 5u, 9u}) {
+            for (LZ77MatchFinder finder : {LZ77MatchFinder::HASH_CHAIN, LZ77MatchFinder::BINARY_TREE,
+                                           LZ77MatchFinder::SUFFIX_ARRAY}) {
+                CodecParams params;
+                params.lz77.level = level;
+                params.lz77.matchFinder = finder;
+                params.lz77.windowSize = 1u << 16;
+                testRoundTrip(algorithm, params, inputs[0]);
+            }
+        }
+        CHECK(BlockCodec::supportsHistory(algorithm));
+        testHistory(algorithm, CodecParams());
+    }
+    for (EntropyCoder coder : {EntropyCoder::HUFFMAN, EntropyCoder::TANS, EntropyCoder::RANS}) {
+        CodecParams params;
+        params.entropy = coder;
+        testRoundTrip(ALGORITHM_BWT, params, inputs[0]);
+        testRoundTrip(ALGORITHM_BWT, params, inputs[1]);
+    }
+    for (uint32_t interval : {256u, 1u << 20}) {
+        CodecParams params;
+        params.huffmanRebuildInterval = interval;
+        testRoundTrip(ALGORITHM_HUFFMAN_ADAPTIVE, params, inputs[0]);
+    }
+
+    // History is only accepted where the format has a window.
+    std::vector<uint8_t> encoded;
+    CHECK(!BlockCodec::encode(ALGORITHM_HUFFMAN, inputs[0].data, encoded, CodecParams(), 100));
+
+    for (const char* spec : {"bwt-raw+mtf+rle+ans", "delta+rle+huffman", "lz77+rans", "mtf+huffman1",
+                             "rle+rle+rle+rle+rle+rle+rle+rle", "delta+cm"}) {
+        CodecParams params;
+        params.cmMemoryMb = 4;
+        CHECK_CONTEXT(TransformChain::parse(spec, params.chain), spec);
+        CHECK_CONTEXT(TransformChain::format(params.chain) == spec, spec);
+        for (const Sample& sample : inputs) {
+            testRoundTrip(ALGORITHM_CHAIN, params, sample);
+        }
+        testGarbage(ALGORITHM_CHAIN, params);
+    }
+
+    std::vector<uint8_t> stages;
+    CHECK(!TransformChain::parse("", stages));
+    CHECK(!TransformChain::parse("rle+nonsense", stages));
+    CHECK(!TransformChain::parse("rle+rle+rle+rle+rle+rle+rle+rle+rle", stages));
+    CHECK(!TransformChain::parse("auto+rle", stages));
+
+    CompressionAlgorithm algorithm;
+    CHECK(TransformChain::algorithmId("lzh", algorithm) && algorithm == ALGORITHM_LZH);
+    CHECK(TransformChain::algorithmId("auto", algorithm) && algorithm == ALGORITHM_AUTO);
+    CHECK(TransformChain::algorithmId("mtf+rle", algorithm) && algorithm == ALGORITHM_CHAIN);
+    CHECK(!TransformChain::algorithmId("mtf", algorithm));
+    CHECK(TransformChain::algorithmNames().size() == 14);
+
+    return test::report("test_block_codec");
+}
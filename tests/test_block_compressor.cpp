@@ -0,0 +1,397 @@
+#include "block_compressor.h"
+#include "compression_api.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+// The block container through the library API: round trips of every
+// algorithm in each container mode, rejection of corrupt frames, and
+// checkpoint/resume.
+
+namespace {
+
+const size_t BLOCK_SIZE = 1u << 16;
+
+// Offset of the first frame of a file without a chain.
+const size_t FIRST_FRAME = 12;
+
+const CompressionAlgorithm SINGLE_STREAM_CODECS[] = {
+    ALGORITHM_RLE, ALGORITHM_HUFFMAN, ALGORITHM_LZW, ALGORITHM_LZ77, ALGORITHM_LZH, ALGORITHM_ANS,
+    ALGORITHM_RANS, ALGORITHM_BWT, ALGORITHM_CM, ALGORITHM_HUFFMAN_O1, ALGORITHM_HUFFMAN_ADAPTIVE,
+};
+
+const CompressionAlgorithm BLOCK_ONLY_CODECS[] = {
+    ALGORITHM_RLE_HUFFMAN, ALGORITHM_DELTA_RLE_HUFFMAN,
+};
+
+std::string name(CompressionAlgorithm algorithm) {
+    return get_algorithm_name(algorithm);
+}
+
+CompressionOptions blockOptions(size_t blockSize = BLOCK_SIZE) {
+    CompressionOptions options;
+    init_compression_options(&options);
+    options.block_size = static_cast<uint32_t>(blockSize);
+    options.threads = 4;
+    options.cm_memory_mb = 4;
+    return options;
+}
+
+bool compress(CompressionAlgorithm algorithm, const std::string& input, const std::string& output,
+              const CompressionOptions* options, CompressionMetrics* metrics = nullptr) {
+    CompressionMetrics local;
+    return compress_file_ex(algorithm, input.c_str(), output.c_str(), options, metrics ? metrics : &local) == 1;
+}
+
+bool decompress(CompressionAlgorithm algorithm, const std::string& input, const std::string& output,
+                const CompressionOptions* options = nullptr, CompressionMetrics* metrics = nullptr) {
+    CompressionMetrics local;
+    return decompress_file_ex(algorithm, input.c_str(), output.c_str(), options, metrics ? metrics : &local) == 1;
+}
+
+void checkRoundTrip(CompressionAlgorithm algorithm, const test::TempDir& dir, const std::string& input,
+                    const CompressionOptions* options, const std::string& context) {
+    std::string compressed = dir.file("roundtrip.cmp");
+    std::string restored = dir.file("roundtrip.out");
+    CHECK_CONTEXT(compress(algorithm, input, compressed, options), context);
+    CHECK_CONTEXT(decompress(algorithm, compressed, restored), context);
+    CHECK_CONTEXT(test::readFile(restored) == test::readFile(input), context);
+
+    bool framed = options && (options->block_size > 0 || options->chain);
+    CHECK_CONTEXT(BlockCompressor::isBlockFile(compressed) == framed, context + " framing");
+}
+
+uint32_t readU32(const std::vector<uint8_t>& data, size_t offset) {
+    return static_cast<uint32_t>(data[offset]) | static_cast<uint32_t>(data[offset + 1]) << 8 |
+           static_cast<uint32_t>(data[offset + 2]) << 16 | static_cast<uint32_t>(data[offset + 3]) << 24;
+}
+
+void writeU32(std::vector<uint8_t>& data, size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        data[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+void testBlockModes(const test::TempDir& dir, const std::string& text, const std::string& random) {
+    CompressionOptions options = blockOptions();
+    for (CompressionAlgorithm algorithm : SINGLE_STREAM_CODECS) {
+        checkRoundTrip(algorithm, dir, text, nullptr, name(algorithm) + " single-stream");
+        checkRoundTrip(algorithm, dir, text, &options, name(algorithm) + " block");
+        checkRoundTrip(algorithm, dir, random, &options, name(algorithm) + " block random");
+    }
+    for (CompressionAlgorithm algorithm : BLOCK_ONLY_CODECS) {
+        checkRoundTrip(algorithm, dir, text, &options, name(algorithm) + " block");
+        checkRoundTrip(algorithm, dir, random, &options, name(algorithm) + " block random");
+    }
+
+    // Block-only algorithms frame their output even when asked not to.
+    CompressionOptions unframed = blockOptions(0);
+    unframed.chain = "delta+rle+huffman";
+    checkRoundTrip(ALGORITHM_CHAIN, dir, text, &unframed, "chain without block size");
+
+    std::string empty = dir.file("empty.bin");
+    test::writeFile(empty, {});
+    checkRoundTrip(ALGORITHM_LZH, dir, empty, &options, "empty block");
+}
+
+void testChains(const test::TempDir& dir, const std::string& text, const std::string& random) {
+    for (const char* chain : {"bwt-raw+mtf+rle+ans", "lz77+rans", "mtf+huffman1", "delta+cm"}) {
+        CompressionOptions options = blockOptions();
+        options.chain = chain;
+        checkRoundTrip(ALGORITHM_CHAIN, dir, text, &options, chain);
+        checkRoundTrip(ALGORITHM_CHAIN, dir, random, &options, std::string(chain) + " random");
+
+        CompressionAlgorithm algorithm;
+        uint32_t blockSize;
+        CHECK(BlockCompressor::readHeader(dir.file("roundtrip.cmp"), algorithm, blockSize));
+        CHECK(algorithm == ALGORITHM_CHAIN && blockSize == BLOCK_SIZE);
+    }
+
+    CompressionOptions invalid = blockOptions();
+    invalid.chain = "rle+nonsense";
+    CHECK(!compress(ALGORITHM_CHAIN, text, dir.file("invalid.cmp"), &invalid));
+}
+
+void testLinkedBlocks(const test::TempDir& dir) {
+    // Every block repeats the one before it, which only linked blocks can see.
+    std::vector<uint8_t> data = test::textData(BLOCK_SIZE, 11);
+    std::vector<uint8_t> repeated;
+    for (int i = 0; i < 6; i++) {
+        repeated.insert(repeated.end(), data.begin(), data.end());
+    }
+    std::string input = dir.file("repeated.bin");
+    test::writeFile(input, repeated);
+
+    for (CompressionAlgorithm algorithm : {ALGORITHM_LZ77, ALGORITHM_LZH}) {
+        CompressionOptions independent = blockOptions();
+        CompressionOptions linked = blockOptions();
+        linked.lz77_link_blocks = 1;
+
+        CompressionMetrics independentMetrics;
+        CompressionMetrics linkedMetrics;
+        CHECK(compress(algorithm, input, dir.file("independent.cmp"), &independent, &independentMetrics));
+        CHECK(compress(algorithm, input, dir.file("linked.cmp"), &linked, &linkedMetrics));
+        CHECK_CONTEXT(linkedMetrics.compressed_size_bytes * 3 < independentMetrics.compressed_size_bytes,
+                      name(algorithm));
+
+        checkRoundTrip(algorithm, dir, input, &linked, name(algorithm) + " linked");
+    }
+}
+
+void testAutoSelection(const test::TempDir& dir, const std::string& text) {
+    CompressionOptions options = blockOptions();
+    checkRoundTrip(ALGORITHM_AUTO, dir, text, &options, "auto");
+
+    std::string compressed = dir.file("roundtrip.cmp");
+    CompressionAlgorithm algorithm;
+    uint32_t blockSize;
+    CHECK(BlockCompressor::readHeader(compressed, algorithm, blockSize));
+    CHECK(algorithm != ALGORITHM_AUTO);
+    CHECK(BlockCompressor::isAutoSelected(compressed));
+
+    // The recorded algorithm decodes the file; any other does not.
+    std::string restored = dir.file("auto.out");
+    CHECK(decompress(algorithm, compressed, restored));
+    CompressionAlgorithm other = algorithm == ALGORITHM_RLE ? ALGORITHM_HUFFMAN : ALGORITHM_RLE;
+    CompressionMetrics metrics;
+    CHECK(!decompress(other, compressed, restored, nullptr, &metrics));
+    CHECK(std::strcmp(metrics.error_message, "File was compressed with a different algorithm") == 0);
+
+    CHECK(!BlockCompressor::isAutoSelected(text));
+}
+
+// Writes compressed with one change and checks that it no longer decodes.
+void expectRejected(const test::TempDir& dir, const std::vector<uint8_t>& compressed, const std::string& context) {
+    std::string corrupt = dir.file("corrupt.cmp");
+    test::writeFile(corrupt, compressed);
+
+    auto start = std::chrono::steady_clock::now();
+    CHECK_CONTEXT(!decompress(ALGORITHM_AUTO, corrupt, dir.file("corrupt.out")), context);
+    // Forged sizes must fail before anything of that size is allocated.
+    CHECK_CONTEXT(std::chrono::steady_clock::now() - start < std::chrono::seconds(5), context + " time");
+}
+
+void testCorruptFrames(const test::TempDir& dir, const std::string& runs) {
+    for (CompressionAlgorithm algorithm : {ALGORITHM_RLE, ALGORITHM_HUFFMAN, ALGORITHM_LZW, ALGORITHM_LZ77,
+                                           ALGORITHM_LZH, ALGORITHM_ANS, ALGORITHM_RANS, ALGORITHM_BWT,
+                                           ALGORITHM_CM, ALGORITHM_HUFFMAN_O1, ALGORITHM_HUFFMAN_ADAPTIVE,
+                                           ALGORITHM_RLE_HUFFMAN, ALGORITHM_DELTA_RLE_HUFFMAN}) {
+        CompressionOptions options = blockOptions();
+        std::string compressedFile = dir.file("valid.cmp");
+        CHECK(compress(algorithm, runs, compressedFile, &options));
+        const std::vector<uint8_t> valid = test::readFile(compressedFile);
+        std::string context = name(algorithm);
+
+        uint32_t rawSize = readU32(valid, FIRST_FRAME);
+        uint32_t payloadSize = readU32(valid, FIRST_FRAME + 4);
+        CHECK_CONTEXT(rawSize == BLOCK_SIZE, context);
+        CHECK_CONTEXT((payloadSize & 0x80000000u) == 0, context + " compressed");
+        if (rawSize != BLOCK_SIZE || (payloadSize & 0x80000000u) != 0) {
+            continue;
+        }
+
+        std::vector<uint8_t> corrupt = valid;
+        writeU32(corrupt, FIRST_FRAME, 0xFFFFFFF0u);
+        expectRejected(dir, corrupt, context + " oversized raw size");
+
+        corrupt = valid;
+        writeU32(corrupt, FIRST_FRAME, rawSize + 1);
+        expectRejected(dir, corrupt, context + " raw size above block size");
+
+        corrupt = valid;
+        writeU32(corrupt, FIRST_FRAME, rawSize - 1);
+        expectRejected(dir, corrupt, context + " raw size below payload");
+
+        corrupt = valid;
+        writeU32(corrupt, FIRST_FRAME + 4, 0x7FFFFFF0u);
+        expectRejected(dir, corrupt, context + " oversized payload size");
+
+        corrupt = valid;
+        corrupt[FIRST_FRAME + 12 + payloadSize / 2] ^= 0x40;
+        expectRejected(dir, corrupt, context + " payload bit flip");
+
+        corrupt = valid;
+        corrupt[FIRST_FRAME + 8] ^= 0x01;
+        expectRejected(dir, corrupt, context + " crc");
+
+        corrupt = valid;
+        corrupt.resize(valid.size() - 16);
+        expectRejected(dir, corrupt, context + " truncated");
+
+        // The block's output must be exactly raw size even when the payload
+        // is stored.
+        corrupt = valid;
+        writeU32(corrupt, FIRST_FRAME + 4, payloadSize | 0x80000000u);
+        expectRejected(dir, corrupt, context + " payload marked stored");
+    }
+
+    CompressionOptions options = blockOptions();
+    std::string compressedFile = dir.file("valid.cmp");
+    CHECK(compress(ALGORITHM_LZ77, runs, compressedFile, &options));
+    std::vector<uint8_t> corrupt = test::readFile(compressedFile);
+    corrupt[4] = 99;
+    expectRejected(dir, corrupt, "unknown version");
+    corrupt = test::readFile(compressedFile);
+    corrupt[5] = 200;
+    expectRejected(dir, corrupt, "unknown algorithm");
+    corrupt = test::readFile(compressedFile);
+    writeU32(corrupt, 8, 0);
+    expectRejected(dir, corrupt, "zero block size");
+}
+
+void testThrottlingNeedsBlocks(const test::TempDir& dir, const std::string& text) {
+    CompressionOptions options = blockOptions(0);
+    options.max_read_mbps = 10;
+    CompressionMetrics metrics;
+    CHECK(!compress(ALGORITHM_LZ77, text, dir.file("throttled.cmp"), &options, &metrics));
+    CHECK(std::strcmp(metrics.error_message, "Throttling requires block mode") == 0);
+
+    options = blockOptions();
+    options.max_read_mbps = 1000;
+    options.max_cpu_percent = 400;
+    checkRoundTrip(ALGORITHM_LZ77, dir, text, &options, "throttled block mode");
+}
+
+struct ResumeProgress {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> first{UINT64_MAX};
+};
+
+void recordProgress(const CompressionProgress* progress, void* userData) {
+    ResumeProgress* state = static_cast<ResumeProgress*>(userData);
+    uint64_t unset = UINT64_MAX;
+    state->first.compare_exchange_strong(unset, progress->bytes_processed);
+    state->bytes = progress->bytes_processed;
+}
+
+void testResume(const test::TempDir& dir) {
+    const size_t blockSize = 1u << 14;
+    const size_t inputSize = 2u << 20;
+    std::string input = dir.file("resume.bin");
+    test::writeFile(input, test::textData(inputSize, 5));
+    std::string output = dir.file("resume.cmp");
+    std::string checkpoint = dir.file("resume.checkpoint");
+
+    std::string reference = dir.file("reference.cmp");
+    CompressionOptions plain = blockOptions(blockSize);
+    plain.lz77_level = 5;
+    CHECK(compress(ALGORITHM_LZH, input, reference, &plain));
+
+    // Throttled to about two seconds, then cancelled part of the way in.
+    ResumeProgress progress;
+    CompressionOptions options = plain;
+    options.max_read_mbps = 1;
+    options.checkpoint_path = checkpoint.c_str();
+    options.checkpoint_interval_blocks = 1;
+    options.progress_callback = recordProgress;
+    options.progress_user_data = &progress;
+    options.progress_interval_ms = 10;
+
+    CompressionJob job = {ALGORITHM_LZH, OPERATION_COMPRESS, input.c_str(), output.c_str()};
+    CompressionJobHandle handle = submit_compression_job(&job, &options, nullptr, nullptr);
+    CHECK(handle != nullptr);
+    if (!handle) {
+        return;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (progress.bytes < inputSize / 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(cancel_compression_job(handle) == 1);
+    CompressionMetrics metrics;
+    CHECK(wait_compression_job(handle, &metrics) == JOB_CANCELLED);
+    release_compression_job(handle);
+
+    CHECK(std::filesystem::exists(checkpoint));
+    CHECK(std::filesystem::exists(output));
+    CHECK(std::filesystem::file_size(output) < std::filesystem::file_size(reference));
+
+    // Resuming continues from the checkpoint and yields the same file as an
+    // uninterrupted run.
+    ResumeProgress resumed;
+    options.max_read_mbps = 0;
+    options.resume = 1;
+    options.progress_user_data = &resumed;
+    CHECK(compress(ALGORITHM_LZH, input, output, &options));
+    CHECK(test::readFile(output) == test::readFile(reference));
+    CHECK(!std::filesystem::exists(checkpoint));
+    CHECK(resumed.first >= inputSize / 8);
+    CHECK(resumed.first < inputSize);
+
+    CHECK(decompress(ALGORITHM_LZH, output, dir.file("resume.out")));
+    CHECK(test::readFile(dir.file("resume.out")) == test::readFile(input));
+}
+
+void testResumeWithOtherParameters(const test::TempDir& dir) {
+    const size_t blockSize = 1u << 14;
+    std::string input = dir.file("restart.bin");
+    test::writeFile(input, test::textData(1u << 20, 9));
+    std::string output = dir.file("restart.cmp");
+    std::string checkpoint = dir.file("restart.checkpoint");
+
+    ResumeProgress progress;
+    CompressionOptions options = blockOptions(blockSize);
+    options.lz77_level = 1;
+    options.max_read_mbps = 1;
+    options.checkpoint_path = checkpoint.c_str();
+    options.checkpoint_interval_blocks = 1;
+    options.progress_callback = recordProgress;
+    options.progress_user_data = &progress;
+    options.progress_interval_ms = 10;
+
+    CompressionJob job = {ALGORITHM_LZ77, OPERATION_COMPRESS, input.c_str(), output.c_str()};
+    CompressionJobHandle handle = submit_compression_job(&job, &options, nullptr, nullptr);
+    CHECK(handle != nullptr);
+    if (!handle) {
+        return;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (progress.bytes < (1u << 18) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    cancel_compression_job(handle);
+    wait_compression_job(handle, nullptr);
+    release_compression_job(handle);
+    CHECK(std::filesystem::exists(checkpoint));
+
+    // A different level must not extend blocks written at the old one.
+    ResumeProgress restarted;
+    options.lz77_level = 9;
+    options.max_read_mbps = 0;
+    options.resume = 1;
+    options.progress_user_data = &restarted;
+    CHECK(compress(ALGORITHM_LZ77, input, output, &options));
+    CHECK(restarted.first < (1u << 18));
+
+    std::string reference = dir.file("restart-reference.cmp");
+    CompressionOptions plain = blockOptions(blockSize);
+    plain.lz77_level = 9;
+    CHECK(compress(ALGORITHM_LZ77, input, reference, &plain));
+    CHECK(test::readFile(output) == test::readFile(reference));
+}
+
+} // namespace
+
+int main() {
+    test::TempDir dir("test_block_compressor");
+    std::string text = dir.file("text.bin");
+    test::writeFile(text, test::textData(5 * BLOCK_SIZE + 1234));
+    std::string random = dir.file("random.bin");
+    test::writeFile(random, test::randomData(2 * BLOCK_SIZE + 17));
+    std::string runs = dir.file("runs.bin");
+    test::writeFile(runs, test::runData(3 * BLOCK_SIZE));
+
+    testBlockModes(dir, text, random);
+    testChains(dir, text, random);
+    testLinkedBlocks(dir);
+    testAutoSelection(dir, text);
+    testCorruptFrames(dir, runs);
+    testThrottlingNeedsBlocks(dir, text);
+    testResume(dir);
+    testResumeWithOtherParameters(dir);
+
+    return test::report("test_block_compressor");
+}
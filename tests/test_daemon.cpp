@@ -0,0 +1,143 @@
+#include "daemon.h"
+#include "compression_api.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <thread>
+
+// The daemon over its socket: requests with options, progress relaying,
+// malformed requests, and shutdown on SIGTERM.
+
+namespace {
+
+std::atomic<int> progressReports(0);
+
+void countProgress(const CompressionProgress*, void*) {
+    progressReports++;
+}
+
+DaemonRequest request(const std::string& mode, const std::string& algorithm, size_t blockSize,
+                      const std::string& input, const std::string& output) {
+    DaemonRequest daemonRequest;
+    daemonRequest.mode = mode;
+    daemonRequest.algorithm = algorithm;
+    daemonRequest.blockSize = blockSize;
+    daemonRequest.inputFile = input;
+    daemonRequest.outputFile = output;
+    return daemonRequest;
+}
+
+bool startsWith(const std::string& text, const std::string& prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+void testRequests(const test::TempDir& dir, const std::string& socket) {
+    std::string input = dir.file("input.bin");
+    test::writeFile(input, test::textData(1u << 20));
+    std::string compressed = dir.file("daemon.cmp");
+    std::string restored = dir.file("daemon.out");
+    std::string reply;
+
+    // Options reach the job: the output matches a local run with the same ones.
+    DaemonRequest compress = request("compress", "lzh", 1u << 16, input, compressed);
+    compress.options = {{"level", "9"}, {"match-finder", "bt"}, {"threads", "2"}, {"progress", "1"}};
+    CHECK(CompressionDaemon::submit(socket, compress, reply, countProgress));
+    CHECK_CONTEXT(startsWith(reply, "OK\t"), reply);
+    CHECK(progressReports > 0);
+
+    std::string local = dir.file("local.cmp");
+    CompressionOptions options;
+    init_compression_options(&options);
+    options.block_size = 1u << 16;
+    options.lz77_level = 9;
+    options.lz77_match_finder = MATCH_FINDER_BINARY_TREE;
+    CompressionMetrics metrics;
+    CHECK(compress_file_ex(ALGORITHM_LZH, input.c_str(), local.c_str(), &options, &metrics) == 1);
+    CHECK(test::readFile(compressed) == test::readFile(local));
+
+    CHECK(CompressionDaemon::submit(socket, request("decompress", "lzh", 0, compressed, restored), reply));
+    CHECK_CONTEXT(startsWith(reply, "OK\t"), reply);
+    CHECK(test::readFile(restored) == test::readFile(input));
+
+    DaemonRequest chain = request("compress", "bwt-raw+mtf+rle+ans", 1u << 16, input, compressed);
+    CHECK(CompressionDaemon::submit(socket, chain, reply));
+    CHECK_CONTEXT(startsWith(reply, "OK\t"), reply);
+    CHECK(CompressionDaemon::submit(socket, request("decompress", "auto", 0, compressed, restored), reply));
+    CHECK_CONTEXT(startsWith(reply, "OK\t"), reply);
+    CHECK(test::readFile(restored) == test::readFile(input));
+
+    DaemonRequest unknown = compress;
+    unknown.options = {{"bogus", "1"}};
+    CHECK(CompressionDaemon::submit(socket, unknown, reply));
+    CHECK_CONTEXT(reply == "ERR\tUnsupported option 'bogus'", reply);
+
+    DaemonRequest invalid = compress;
+    invalid.options = {{"level", "fast"}};
+    CHECK(CompressionDaemon::submit(socket, invalid, reply));
+    CHECK_CONTEXT(reply == "ERR\tInvalid value for 'level'", reply);
+
+    CHECK(CompressionDaemon::submit(socket, request("compress", "nonsense", 0, input, compressed), reply));
+    CHECK_CONTEXT(startsWith(reply, "ERR\t"), reply);
+
+    CHECK(CompressionDaemon::submit(socket, request("compress", "lzh", 0, dir.file("missing.bin"), compressed),
+                                    reply));
+    CHECK_CONTEXT(startsWith(reply, "ERR\t"), reply);
+
+    DaemonRequest tab = request("compress", "lzh", 0, input + "\tx", compressed);
+    CHECK(!CompressionDaemon::submit(socket, tab, reply));
+}
+
+// Several clients at once share the daemon's pool.
+void testConcurrentClients(const test::TempDir& dir, const std::string& socket) {
+    std::string input = dir.file("shared.bin");
+    test::writeFile(input, test::textData(1u << 19, 4));
+    std::vector<std::thread> clients;
+    std::atomic<int> succeeded(0);
+    for (int i = 0; i < 8; i++) {
+        clients.emplace_back([&, i] {
+            std::string output = dir.file("client" + std::to_string(i) + ".cmp");
+            std::string reply;
+            if (CompressionDaemon::submit(socket, request("compress", "lz77", 1u << 16, input, output), reply) &&
+                startsWith(reply, "OK\t")) {
+                succeeded++;
+            }
+        });
+    }
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    CHECK(succeeded == 8);
+}
+
+} // namespace
+
+int main() {
+    test::TempDir dir("test_daemon");
+    std::string socket = dir.file("daemon.sock");
+
+    std::atomic<bool> served(false);
+    std::thread daemon([&] { served = CompressionDaemon::serve(socket); });
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!std::filesystem::exists(socket) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(std::filesystem::exists(socket));
+
+    testRequests(dir, socket);
+    testConcurrentClients(dir, socket);
+
+    // A second daemon cannot take over the socket of a running one.
+    CHECK(!CompressionDaemon::serve(socket));
+
+    std::raise(SIGTERM);
+    daemon.join();
+    CHECK(served);
+    CHECK(!std::filesystem::exists(socket));
+
+    std::string reply;
+    CHECK(!CompressionDaemon::submit(socket, request("compress", "lzh", 0, socket, socket), reply));
+
+    return test::report("test_daemon");
+}
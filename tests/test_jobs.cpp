@@ -0,0 +1,292 @@
+#include "admission_controller.h"
+#include "compression_api.h"
+#include "thread_pool.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+// The shared thread pool, admission control, and the asynchronous job API
+// with its cancellation.
+
+namespace {
+
+void testThreadPool() {
+    CHECK(ThreadPool::defaultThreadCount() >= 1);
+
+    ThreadPool& pool = ThreadPool::instance();
+    CHECK(pool.size() >= 1);
+    CHECK(get_thread_pool_size() == pool.size());
+    CHECK(set_thread_pool_size(static_cast<uint32_t>(pool.size())) == 1);
+    CHECK(set_thread_pool_size(static_cast<uint32_t>(pool.size()) + 1) == 0);
+
+    std::atomic<uint64_t> sum(0);
+    TaskGroup group;
+    for (uint64_t i = 1; i <= 1000; i++) {
+        group.run([&sum, i] { sum += i; });
+    }
+    group.wait();
+    CHECK(sum == 500500);
+
+    // Tasks that fork and wait themselves must not exhaust the pool.
+    std::atomic<size_t> leaves(0);
+    TaskGroup outer;
+    for (int i = 0; i < 32; i++) {
+        outer.run([&leaves] {
+            TaskGroup inner;
+            for (int j = 0; j < 32; j++) {
+                inner.run([&leaves] { leaves++; });
+            }
+            inner.wait();
+        });
+    }
+    outer.wait();
+    CHECK(leaves == 32 * 32);
+
+    TaskGroup failing;
+    failing.run([] { throw std::runtime_error("task failed"); });
+    failing.run([] {});
+    bool rethrown = false;
+    try {
+        failing.wait();
+    } catch (const std::runtime_error&) {
+        rethrown = true;
+    }
+    CHECK(rethrown);
+
+    ThreadPool local(2);
+    CHECK(local.size() == 2);
+    std::atomic<int> ran(0);
+    TaskGroup localGroup(local);
+    for (int i = 0; i < 100; i++) {
+        localGroup.run([&ran] { ran++; });
+    }
+    localGroup.wait();
+    CHECK(ran == 100);
+}
+
+void testAdmissionController() {
+    AdmissionController admission;
+    AdmissionController::Limits limits;
+    limits.maxJobs = 1;
+    limits.maxThreads = 4;
+    admission.configure(limits);
+
+    AdmissionController::Request wide;
+    wide.threads = 16;
+    AdmissionController::Ticket first = admission.acquire(wide);
+    CHECK(first.threads() == 4);
+
+    // Queued behind the running job; a withdrawn request never runs.
+    std::atomic<bool> withdrawnRan(false);
+    uint64_t withdrawn = admission.enqueue(AdmissionController::Request(),
+                                           [&](AdmissionController::Ticket) { withdrawnRan = true; });
+    std::unique_ptr<AdmissionController::Ticket> next;
+    admission.enqueue(AdmissionController::Request(), [&](AdmissionController::Ticket ticket) {
+        next = std::make_unique<AdmissionController::Ticket>(std::move(ticket));
+    });
+    CHECK(admission.cancel(withdrawn));
+    CHECK(!admission.cancel(withdrawn));
+    CHECK(next == nullptr);
+
+    first = AdmissionController::Ticket();
+    CHECK(next != nullptr);
+    CHECK(!withdrawnRan);
+
+    // Under priority order the higher priority waiter goes first.
+    limits.priorityOrder = true;
+    admission.configure(limits);
+    std::vector<int> order;
+    std::unique_ptr<AdmissionController::Ticket> current;
+    for (int priority : {1, 5, 3}) {
+        AdmissionController::Request request;
+        request.priority = priority;
+        admission.enqueue(request, [&order, &current, priority](AdmissionController::Ticket ticket) {
+            order.push_back(priority);
+            current = std::make_unique<AdmissionController::Ticket>(std::move(ticket));
+        });
+    }
+    CHECK(order.empty());
+    next.reset();
+    // Releasing each ticket admits the next waiter, which takes its place.
+    while (current) {
+        std::unique_ptr<AdmissionController::Ticket> finished = std::move(current);
+        finished.reset();
+    }
+    CHECK((order == std::vector<int>{5, 3, 1}));
+
+    // A job over the memory limit on its own still runs once nothing else does.
+    limits = AdmissionController::Limits();
+    limits.maxMemory = 1000;
+    admission.configure(limits);
+    AdmissionController::Request large;
+    large.memory = 5000;
+    AdmissionController::Ticket alone = admission.acquire(large);
+    CHECK(alone.threads() == 1);
+}
+
+struct JobRecord {
+    std::atomic<int> calls{0};
+    std::atomic<int> status{-1};
+};
+
+void recordJob(CompressionJobHandle, CompressionJobStatus status, const CompressionMetrics*, void* userData) {
+    JobRecord* record = static_cast<JobRecord*>(userData);
+    record->status = status;
+    record->calls++;
+}
+
+// The callback runs after waiters are woken, so it may lag behind them.
+bool callbackRan(const JobRecord& record) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (record.calls == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return record.calls == 1;
+}
+
+CompressionOptions jobOptions() {
+    CompressionOptions options;
+    init_compression_options(&options);
+    options.block_size = 1u << 14;
+    options.threads = 2;
+    return options;
+}
+
+void testAsyncJobs(const test::TempDir& dir, const std::string& input) {
+    std::string compressed = dir.file("job.cmp");
+    std::string restored = dir.file("job.out");
+    CompressionOptions options = jobOptions();
+
+    JobRecord record;
+    CompressionJob job = {ALGORITHM_LZH, OPERATION_COMPRESS, input.c_str(), compressed.c_str()};
+    CompressionJobHandle handle = submit_compression_job(&job, &options, recordJob, &record);
+    CHECK(handle != nullptr);
+    CompressionMetrics metrics;
+    CHECK(wait_compression_job(handle, &metrics) == JOB_SUCCEEDED);
+    CHECK(metrics.success == 1);
+    CHECK(poll_compression_job(handle, nullptr) == JOB_SUCCEEDED);
+    CHECK(cancel_compression_job(handle) == 0);
+    release_compression_job(handle);
+    CHECK(callbackRan(record));
+    CHECK(record.status == JOB_SUCCEEDED);
+
+    CompressionJob reverse = {ALGORITHM_LZH, OPERATION_DECOMPRESS, compressed.c_str(), restored.c_str()};
+    handle = submit_compression_job(&reverse, nullptr, nullptr, nullptr);
+    CHECK(wait_compression_job(handle, nullptr) == JOB_SUCCEEDED);
+    release_compression_job(handle);
+    CHECK(test::readFile(restored) == test::readFile(input));
+
+    std::string missing = dir.file("missing.bin");
+    CompressionJob failing = {ALGORITHM_LZH, OPERATION_COMPRESS, missing.c_str(), compressed.c_str()};
+    handle = submit_compression_job(&failing, &options, nullptr, nullptr);
+    CHECK(wait_compression_job(handle, &metrics) == JOB_FAILED);
+    CHECK(metrics.success == 0);
+    release_compression_job(handle);
+
+    CompressionJob invalid = {ALGORITHM_LZH, OPERATION_COMPRESS, nullptr, compressed.c_str()};
+    CHECK(submit_compression_job(&invalid, &options, nullptr, nullptr) == nullptr);
+}
+
+void testCancellation(const test::TempDir& dir, const std::string& input) {
+    AdmissionLimits limits = {};
+    limits.max_concurrent_jobs = 1;
+    CHECK(configure_admission_control(&limits) == 1);
+
+    // Throttled so that it is still running when cancelled.
+    CompressionOptions slow = jobOptions();
+    slow.max_read_mbps = 0.5;
+    std::string runningOutput = dir.file("running.cmp");
+    JobRecord runningRecord;
+    CompressionJob runningJob = {ALGORITHM_LZ77, OPERATION_COMPRESS, input.c_str(), runningOutput.c_str()};
+    CompressionJobHandle running = submit_compression_job(&runningJob, &slow, recordJob, &runningRecord);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (poll_compression_job(running, nullptr) != JOB_RUNNING && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(poll_compression_job(running, nullptr) == JOB_RUNNING);
+
+    // Held back by the one-job limit, then withdrawn.
+    std::string queuedOutput = dir.file("queued.cmp");
+    JobRecord queuedRecord;
+    CompressionJob queuedJob = {ALGORITHM_LZ77, OPERATION_COMPRESS, input.c_str(), queuedOutput.c_str()};
+    CompressionJobHandle queued = submit_compression_job(&queuedJob, nullptr, recordJob, &queuedRecord);
+    CHECK(poll_compression_job(queued, nullptr) == JOB_QUEUED);
+    CHECK(cancel_compression_job(queued) == 1);
+    CompressionMetrics metrics;
+    CHECK(wait_compression_job(queued, &metrics) == JOB_CANCELLED);
+    CHECK(std::strcmp(metrics.error_message, "Operation cancelled") == 0);
+    CHECK(queuedRecord.calls == 1);
+    CHECK(queuedRecord.status == JOB_CANCELLED);
+    CHECK(!std::filesystem::exists(queuedOutput));
+    release_compression_job(queued);
+
+    auto cancelledAt = std::chrono::steady_clock::now();
+    CHECK(cancel_compression_job(running) == 1);
+    CHECK(wait_compression_job(running, nullptr) == JOB_CANCELLED);
+    CHECK(std::chrono::steady_clock::now() - cancelledAt < std::chrono::seconds(2));
+    CHECK(callbackRan(runningRecord));
+    CHECK(runningRecord.status == JOB_CANCELLED);
+    CHECK(!std::filesystem::exists(runningOutput));
+    release_compression_job(running);
+
+    // Neither cancelled job still holds the queue.
+    std::string laterOutput = dir.file("later.cmp");
+    CompressionJob laterJob = {ALGORITHM_LZ77, OPERATION_COMPRESS, input.c_str(), laterOutput.c_str()};
+    CompressionOptions options = jobOptions();
+    CompressionJobHandle later = submit_compression_job(&laterJob, &options, nullptr, nullptr);
+    CHECK(wait_compression_job(later, nullptr) == JOB_SUCCEEDED);
+    release_compression_job(later);
+
+    CHECK(configure_admission_control(nullptr) == 1);
+    limits.policy = static_cast<AdmissionPolicy>(7);
+    CHECK(configure_admission_control(&limits) == 0);
+}
+
+void testBatch(const test::TempDir& dir, const std::string& input) {
+    std::vector<std::string> outputs;
+    for (int i = 0; i < 4; i++) {
+        outputs.push_back(dir.file("batch" + std::to_string(i) + ".cmp"));
+    }
+    std::string missing = dir.file("missing.bin");
+    CompressionJob jobs[] = {
+        {ALGORITHM_LZ77, OPERATION_COMPRESS, input.c_str(), outputs[0].c_str()},
+        {ALGORITHM_BWT, OPERATION_COMPRESS, input.c_str(), outputs[1].c_str()},
+        {ALGORITHM_LZ77, OPERATION_COMPRESS, missing.c_str(), outputs[2].c_str()},
+        {ALGORITHM_HUFFMAN, OPERATION_COMPRESS, input.c_str(), outputs[3].c_str()},
+    };
+    CompressionMetrics results[4];
+    CompressionOptions options = jobOptions();
+    CHECK(compress_files_batch(jobs, 4, &options, results) == 0);
+    CHECK(results[0].success == 1 && results[1].success == 1 && results[3].success == 1);
+    CHECK(results[2].success == 0);
+
+    for (int i : {0, 1, 3}) {
+        std::string restored = dir.file("batch.out");
+        CompressionMetrics metrics;
+        CHECK(decompress_file_ex(jobs[i].algorithm, outputs[i].c_str(), restored.c_str(), nullptr, &metrics) == 1);
+        CHECK(test::readFile(restored) == test::readFile(input));
+    }
+
+    CHECK(compress_files_batch(nullptr, 0, nullptr, nullptr) == 1);
+}
+
+} // namespace
+
+int main() {
+    test::TempDir dir("test_jobs");
+    std::string input = dir.file("input.bin");
+    test::writeFile(input, test::textData(1u << 20));
+
+    testThreadPool();
+    testAdmissionController();
+    testAsyncJobs(dir, input);
+    testCancellation(dir, input);
+    testBatch(dir, input);
+
+    return test::report("test_jobs");
+}
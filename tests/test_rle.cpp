@@ -0,0 +1,108 @@
+#include "rle.h"
+#include "huffman.h"
+#include "lzw.h"
+#include "test_util.h"
+
+#include <functional>
+
+// The original single-stream codecs: file round trips over the fixtures in
+// tests/ and generated data, and their block entry points.
+
+namespace {
+
+using FileCodec = std::function<bool(const std::string&, const std::string&)>;
+using BlockEncoder = std::function<bool(const std::vector<uint8_t>&, std::vector<uint8_t>&)>;
+using BlockDecoder = std::function<bool(const std::vector<uint8_t>&, std::vector<uint8_t>&, size_t)>;
+
+struct LegacyCodec {
+    const char* name;
+    FileCodec compress;
+    FileCodec decompress;
+    std::function<bool(const std::string&)> isValidFile;
+    BlockEncoder compressBlock;
+    BlockDecoder decompressBlock;
+};
+
+std::vector<LegacyCodec> legacyCodecs() {
+    return {
+        {"rle", RLECompressor::compress, RLECompressor::decompress, RLECompressor::isValidRLEFile,
+         RLECompressor::compressBlock, RLECompressor::decompressBlock},
+        {"huffman", HuffmanCompressor::compress, HuffmanCompressor::decompress, HuffmanCompressor::isValidHuffmanFile,
+         HuffmanCompressor::compressBlock, HuffmanCompressor::decompressBlock},
+        {"lzw", LZWCompressor::compress, LZWCompressor::decompress, LZWCompressor::isValidLZWFile,
+         LZWCompressor::compressBlock, LZWCompressor::decompressBlock},
+    };
+}
+
+void testFileRoundTrip(const LegacyCodec& codec, const test::TempDir& dir, const std::string& inputFile) {
+    std::string context = std::string(codec.name) + " " + inputFile;
+    std::string compressed = dir.file(std::string(codec.name) + ".cmp");
+    std::string restored = dir.file(std::string(codec.name) + ".out");
+
+    CHECK_CONTEXT(codec.compress(inputFile, compressed), context);
+    CHECK_CONTEXT(codec.isValidFile(compressed), context);
+    CHECK_CONTEXT(codec.decompress(compressed, restored), context);
+    CHECK_CONTEXT(test::readFile(restored) == test::readFile(inputFile), context);
+}
+
+void testBlockRoundTrip(const LegacyCodec& codec, const std::vector<uint8_t>& data, const std::string& label) {
+    std::string context = std::string(codec.name) + " " + label;
+    std::vector<uint8_t> encoded;
+    CHECK_CONTEXT(codec.compressBlock(data, encoded), context);
+
+    std::vector<uint8_t> decoded;
+    CHECK_CONTEXT(codec.decompressBlock(encoded, decoded, data.size()), context);
+    CHECK_CONTEXT(decoded == data, context);
+
+    // A frame claiming fewer bytes than the block holds must not decode.
+    if (!data.empty()) {
+        decoded.clear();
+        CHECK_CONTEXT(!codec.decompressBlock(encoded, decoded, data.size() - 1), context + " bounded");
+    }
+}
+
+void testTruncatedBlock(const LegacyCodec& codec) {
+    std::vector<uint8_t> data = test::textData(20000);
+    std::vector<uint8_t> encoded;
+    CHECK_CONTEXT(codec.compressBlock(data, encoded), codec.name);
+
+    encoded.resize(encoded.size() / 2);
+    std::vector<uint8_t> decoded;
+    bool decodedAll = codec.decompressBlock(encoded, decoded, data.size()) && decoded == data;
+    CHECK_CONTEXT(!decodedAll, std::string(codec.name) + " truncated");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string fixtures = argc > 1 ? argv[1] : "tests";
+    test::TempDir dir("test_rle");
+
+    std::vector<std::string> inputs;
+    for (const char* name : {"sample.txt", "simple.txt", "long_run.txt", "single_char.txt", "sample_lzw_v2.txt"}) {
+        inputs.push_back(fixtures + "/" + name);
+    }
+    inputs.push_back(dir.file("text.bin"));
+    test::writeFile(inputs.back(), test::textData(300000));
+    inputs.push_back(dir.file("runs.bin"));
+    test::writeFile(inputs.back(), test::runData(200000));
+    inputs.push_back(dir.file("random.bin"));
+    test::writeFile(inputs.back(), test::randomData(50000));
+
+    for (const LegacyCodec& codec : legacyCodecs()) {
+        for (const std::string& input : inputs) {
+            testFileRoundTrip(codec, dir, input);
+        }
+
+        testBlockRoundTrip(codec, test::textData(100000), "text");
+        testBlockRoundTrip(codec, test::runData(100000), "runs");
+        testBlockRoundTrip(codec, test::randomData(10000), "random");
+        testBlockRoundTrip(codec, std::vector<uint8_t>(1, 'x'), "single byte");
+        testTruncatedBlock(codec);
+
+        std::string missing = dir.file("missing.txt");
+        CHECK_CONTEXT(!codec.compress(missing, dir.file("missing.cmp")), codec.name);
+    }
+
+    return test::report("test_rle");
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// Shared by the test programs. A failed CHECK reports the expression and
+// carries on, so one run lists every failure; main returns report().
+namespace test {
+
+inline int& failureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void fail(const char* expression, const char* file, int line, const std::string& context) {
+    ++failureCount();
+    std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed";
+    if (!context.empty()) {
+        std::cerr << " [" << context << "]";
+    }
+    std::cerr << std::endl;
+}
+
+inline int report(const std::string& name) {
+    if (failureCount() > 0) {
+        std::cerr << name << ": " << failureCount() << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << name << ": all checks passed" << std::endl;
+    return 0;
+}
+
+// A scratch directory removed with everything in it when the test ends.
+class TempDir {
+public:
+    explicit TempDir(const std::string& name) {
+        std::random_device seed;
+        path_ = std::filesystem::temp_directory_path() / (name + "-" + std::to_string(seed()));
+        std::filesystem::create_directories(path_);
+    }
+
+    ~TempDir() {
+        std::error_code ignored;
+        std::filesystem::remove_all(path_, ignored);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    std::string file(const std::string& name) const {
+        return (path_ / name).string();
+    }
+
+private:
+    std::filesystem::path path_;
+};
+
+inline std::vector<uint8_t> readFile(const std::string& filename) {
+    std::ifstream input(filename, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+inline bool writeFile(const std::string& filename, const std::vector<uint8_t>& data) {
+    std::ofstream output(filename, std::ios::binary);
+    output.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(output);
+}
+
+// Word salad with repeated phrases: compressible by every codec.
+inline std::vector<uint8_t> textData(size_t size, uint32_t seed = 1) {
+    static const char* const WORDS[] = {
+        "block", "stream", "window", "match", "literal", "huffman", "entropy", "context",
+        "the", "of", "and", "compression", "ratio", "buffer", "thread", "pool"
+    };
+    std::mt19937 random(seed);
+    std::vector<uint8_t> data;
+    data.reserve(size + 16);
+    while (data.size() < size) {
+        const char* word = WORDS[random() % (sizeof(WORDS) / sizeof(WORDS[0]))];
+        data.insert(data.end(), word, word + std::char_traits<char>::length(word));
+        data.push_back(random() % 11 == 0 ? '\n' : ' ');
+    }
+    data.resize(size);
+    return data;
+}
+
+// Incompressible bytes, which the block container stores.
+inline std::vector<uint8_t> randomData(size_t size, uint32_t seed = 2) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> data(size);
+    for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(random());
+    }
+    return data;
+}
+
+// Long runs of a few values, the case RLE is built for.
+inline std::vector<uint8_t> runData(size_t size, uint32_t seed = 3) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> data;
+    data.reserve(size);
+    while (data.size() < size) {
+        data.insert(data.end(), 1 + random() % 600, static_cast<uint8_t>('a' + random() % 4));
+    }
+    data.resize(size);
+    return data;
+}
+
+// Slowly increasing little-endian 32-bit counters, the case for delta stages.
+inline std::vector<uint8_t> counterData(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        uint32_t value = static_cast<uint32_t>(i / 4) * 3;
+        data[i] = static_cast<uint8_t>(value >> (8 * (i % 4)));
+    }
+    return data;
+}
+
+} // namespace test
+
+#define CHECK_CONTEXT(expression, context) \
+    do { \
+        if (!(expression)) { \
+            test::fail(#expression, __FILE__, __LINE__, (context)); \
+        } \
+    } while (false)
+
+#define CHECK(expression) CHECK_CONTEXT(expression, std::string())